@@ -22,6 +22,7 @@ PUBLIC_HEADERS += \
     qcontactcollection.h \
     qcontactcollectionchangeset.h \
     qcontactcollectionid.h \
+    qcontactcompiledfilter.h \
     qcontactdetail.h \
     qcontactfetchhint.h \
     qcontactfilter.h \
@@ -44,6 +45,7 @@ PRIVATE_HEADERS += \
     qcontactchangeset_p.h \
     qcontactcollection_p.h \
     qcontactcollectionchangeset_p.h \
+    qcontactcompiledfilter_p.h \
     qcontactdetail_p.h \
     qcontactfetchhint_p.h \
     qcontactfilter_p.h \
@@ -64,6 +66,7 @@ SOURCES += \
     qcontactcollection.cpp \
     qcontactcollectionchangeset.cpp \
     qcontactcollectionid.cpp \
+    qcontactcompiledfilter.cpp \
     qcontactdetail.cpp \
     qcontactfetchhint.cpp \
     qcontactfilter.cpp \
@@ -77,6 +77,7 @@ void QContactIdFilter::setIds(const QList<QContactId>& ids)
 {
     Q_D(QContactIdFilter);
     d->m_ids = ids;
+    d->idsChanged();
 }
 
 /*!
@@ -86,8 +87,10 @@ void QContactIdFilter::setIds(const QList<QContactId>& ids)
 void QContactIdFilter::add(const QContactId& id)
 {
     Q_D(QContactIdFilter);
-    if (!d->m_ids.contains(id))
+    if (!d->m_ids.contains(id)) {
         d->m_ids.append(id);
+        d->idsChanged();
+    }
 }
 
 /*!
@@ -98,7 +101,8 @@ void QContactIdFilter::add(const QContactId& id)
 void QContactIdFilter::remove(const QContactId& id)
 {
     Q_D(QContactIdFilter);
-    d->m_ids.removeAll(id);
+    if (d->m_ids.removeAll(id))
+        d->idsChanged();
 }
 
 /*!
@@ -110,6 +114,7 @@ void QContactIdFilter::clear()
 {
     Q_D(QContactIdFilter);
     d->m_ids.clear();
+    d->idsChanged();
 }
 
 /*!
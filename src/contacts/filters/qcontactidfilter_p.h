@@ -51,6 +51,9 @@
 // We mean it.
 //
 
+#include <QtCore/qatomic.h>
+#include <QtCore/qset.h>
+
 #include <QtContacts/qcontactidfilter.h>
 #include <QtContacts/private/qcontactfilter_p.h>
 
@@ -60,14 +63,43 @@ class QContactIdFilterPrivate : public QContactFilterPrivate
 {
 public:
     QContactIdFilterPrivate()
-        : QContactFilterPrivate()
+        : QContactFilterPrivate(),
+        m_idSet(0)
     {
     }
 
     QContactIdFilterPrivate(const QContactIdFilterPrivate& other)
         : QContactFilterPrivate(other),
-        m_ids(other.m_ids)
+        m_ids(other.m_ids),
+        m_idSet(0)
+    {
+    }
+
+    ~QContactIdFilterPrivate()
+    {
+        delete m_idSet.loadAcquire();
+    }
+
+    // returns true if the id is one of m_ids; the ids are hashed on first use, so that testing
+    // the same filter against many contacts costs O(1) per contact.
+    bool containsId(const QContactId &id) const
+    {
+        QSet<QContactId> *idSet = m_idSet.loadAcquire();
+        if (!idSet) {
+            idSet = new QSet<QContactId>(m_ids.toSet());
+            if (!m_idSet.testAndSetOrdered(0, idSet)) {
+                // another thread built it first.
+                delete idSet;
+                idSet = m_idSet.loadAcquire();
+            }
+        }
+        return idSet->contains(id);
+    }
+
+    // must be called whenever m_ids is modified.
+    void idsChanged()
     {
+        delete m_idSet.fetchAndStoreOrdered(0);
     }
 
     bool compare(const QContactFilterPrivate* other) const
@@ -90,6 +122,7 @@ public:
     {
         if (formatVersion == 1) {
             stream >> m_ids;
+            idsChanged();
         }
         return stream;
     }
@@ -107,6 +140,7 @@ public:
     Q_IMPLEMENT_CONTACTFILTER_VIRTUALCTORS(QContactIdFilter, QContactFilter::IdFilter)
 
     QList<QContactId> m_ids;
+    mutable QAtomicPointer<QSet<QContactId> > m_idSet;
 };
 
 QT_END_NAMESPACE_CONTACTS
@@ -167,6 +167,7 @@ void QContact::clearDetails()
     contactType.setType(QContactType::TypeContact);
     contactType.d->m_access = QContactDetail::Irremovable;
     d->m_details.insert(0, contactType);
+    d->detailsChanged();
 }
 
 /*! Replace the contents of this QContact with \a other
@@ -312,15 +313,8 @@ QContactDetail QContact::detail(QContactDetail::DetailType type) const
     if (type == QContactDetail::TypeUndefined)
         return d.constData()->m_details.first();
 
-    // build the sub-list of matching details.
-    for (int i = 0; i < d.constData()->m_details.size(); i++) {
-        const QContactDetail& existing = d.constData()->m_details.at(i);
-        if (existing.d->m_type == type) {
-            return existing;
-        }
-    }
-
-    return QContactDetail();
+    const QContactDetail *existing = d.constData()->firstDetailOfType(type);
+    return existing ? *existing : QContactDetail();
 }
 
 /*!
@@ -346,12 +340,10 @@ QList<QContactDetail> QContact::details(QContactDetail::DetailType type) const
     if (type == QContactDetail::TypeUndefined) {
         sublist = d.constData()->m_details;
     } else {
-        for (int i = 0; i < d->m_details.size(); i++) {
-            const QContactDetail& existing = d.constData()->m_details.at(i);
-            if (existing.d->m_type == type) {
-                sublist.append(existing);
-            }
-        }
+        const QContactDetailTypeView existing = d.constData()->detailsOfType(type);
+        sublist.reserve(existing.count());
+        for (int i = 0; i < existing.count(); i++)
+            sublist.append(existing.at(i));
     }
 
     return sublist;
@@ -388,6 +380,7 @@ bool QContact::appendDetail(const QContactDetail &detail)
         return true;
     }
     d->m_details.append(detail);
+    d->detailsChanged();
     return true;
 }
 
@@ -449,6 +442,7 @@ bool QContact::saveDetail(QContactDetail* detail)
     }
     // this is a new detail!  add it to the contact.
     d->m_details.append(*detail);
+    d->detailsChanged();
     return true;
 }
 
@@ -509,6 +503,7 @@ bool QContact::removeDetail(QContactDetail* detail)
 
     // then remove the detail.
     d->m_details.removeAt(removeIndex);
+    d->detailsChanged();
     return true;
 }
 
@@ -578,6 +573,7 @@ QDataStream& operator>>(QDataStream& in, QContact& contact)
         QList<QContactDetail> details;
         QMap<QString, int> preferences;
         in >> id >> contact.d->m_details >> contact.d->m_preferences;
+        contact.d->detailsChanged();
         contact.setId(id);
     } else {
         in.setStatus(QDataStream::ReadCorruptData);
@@ -808,6 +804,7 @@ void QContactData::removeOnly(QContactDetail::DetailType type)
         else
             ++dit;
     }
+    detailsChanged();
 }
 
 void QContactData::removeOnly(const QSet<QContactDetail::DetailType>& types)
@@ -820,6 +817,79 @@ void QContactData::removeOnly(const QSet<QContactDetail::DetailType>& types)
         else
             ++dit;
     }
+    detailsChanged();
+}
+
+QContactDetailTypeIndex::QContactDetailTypeIndex(const QList<QContactDetail> &details)
+{
+    // count the details of each type, then turn the counts into offsets.
+    for (int t = 0; t <= TypeCount; t++)
+        m_offsets[t] = 0;
+    for (int i = 0; i < details.size(); i++) {
+        const QContactDetail::DetailType type = details.at(i).type();
+        if (isIndexed(type))
+            m_offsets[type + 1]++;
+    }
+    for (int t = 0; t < TypeCount; t++)
+        m_offsets[t + 1] += m_offsets[t];
+
+    m_positions.resize(m_offsets[TypeCount]);
+    int next[TypeCount];
+    for (int t = 0; t < TypeCount; t++)
+        next[t] = m_offsets[t];
+    for (int i = 0; i < details.size(); i++) {
+        const QContactDetail::DetailType type = details.at(i).type();
+        if (isIndexed(type))
+            m_positions[next[type]++] = i;
+    }
+}
+
+const QContactDetailTypeIndex *QContactData::typeIndex() const
+{
+    QContactDetailTypeIndex *index = m_typeIndex.loadAcquire();
+    if (!index) {
+        index = new QContactDetailTypeIndex(m_details);
+        if (!m_typeIndex.testAndSetOrdered(0, index)) {
+            // another thread built it first.
+            delete index;
+            index = m_typeIndex.loadAcquire();
+        }
+    }
+    return index;
+}
+
+QContactDetailTypeView QContactData::detailsOfType(QContactDetail::DetailType type) const
+{
+    QContactDetailTypeView view;
+    view.m_details = &m_details;
+    if (QContactDetailTypeIndex::isIndexed(type)) {
+        const QContactDetailTypeIndex *index = typeIndex();
+        view.m_positions = index->m_positions.constData() + index->m_offsets[type];
+        view.m_count = index->m_offsets[type + 1] - index->m_offsets[type];
+    } else {
+        for (int i = 0; i < m_details.size(); i++) {
+            if (m_details.at(i).type() == type)
+                view.m_otherPositions.append(i);
+        }
+        view.m_positions = view.m_otherPositions.constData();
+        view.m_count = view.m_otherPositions.size();
+    }
+    return view;
+}
+
+const QContactDetail *QContactData::firstDetailOfType(QContactDetail::DetailType type) const
+{
+    if (QContactDetailTypeIndex::isIndexed(type)) {
+        const QContactDetailTypeIndex *index = typeIndex();
+        const int offset = index->m_offsets[type];
+        return offset < index->m_offsets[type + 1] ? &m_details.at(index->m_positions.at(offset)) : 0;
+    }
+
+    for (int i = 0; i < m_details.size(); i++) {
+        if (m_details.at(i).type() == type)
+            return &m_details.at(i);
+    }
+    return 0;
 }
 
 QT_END_NAMESPACE_CONTACTS
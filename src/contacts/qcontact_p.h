@@ -51,9 +51,11 @@
 // We mean it.
 //
 
+#include <QtCore/qatomic.h>
 #include <QtCore/qlist.h>
 #include <QtCore/qmap.h>
 #include <QtCore/qshareddata.h>
+#include <QtCore/qvector.h>
 
 #include <QtContacts/qcontact.h>
 #include <QtContacts/qcontactdetail.h>
@@ -63,11 +65,46 @@
 
 QT_BEGIN_NAMESPACE_CONTACTS
 
+/* Positions of the details of each built-in detail type in a list of details,
+   grouped by type and in list order within each type. */
+class QContactDetailTypeIndex
+{
+public:
+    enum { TypeCount = QContactDetail::TypeVersion + 1 };
+
+    explicit QContactDetailTypeIndex(const QList<QContactDetail> &details);
+
+    static inline bool isIndexed(QContactDetail::DetailType type) { return type >= 0 && type < TypeCount; }
+
+    QVector<int> m_positions;
+    int m_offsets[TypeCount + 1]; // the positions of type t are m_positions[m_offsets[t]] .. m_positions[m_offsets[t + 1] - 1]
+};
+
+/* A view of the details of one type in a contact, which does not copy them into a list.
+   The view is only valid as long as the contact it was obtained from is not modified. */
+class QContactDetailTypeView
+{
+public:
+    inline int count() const { return m_count; }
+    inline bool isEmpty() const { return m_count == 0; }
+    inline const QContactDetail &at(int i) const { return m_details->at(m_positions[i]); }
+    inline const QContactDetail &first() const { return at(0); }
+
+private:
+    friend class QContactData;
+
+    const QList<QContactDetail> *m_details;
+    const int *m_positions;
+    int m_count;
+    QVector<int> m_otherPositions; // used for types which the index does not cover
+};
+
 class QContactData : public QSharedData
 {
 public:
     QContactData()
-        : QSharedData()
+        : QSharedData(),
+        m_typeIndex(0)
     {
     }
 
@@ -77,11 +114,12 @@ public:
         m_collectionId(other.m_collectionId),
         m_details(other.m_details),
         m_relationshipsCache(other.m_relationshipsCache),
-        m_preferences(other.m_preferences)
+        m_preferences(other.m_preferences),
+        m_typeIndex(0)
     {
     }
 
-    ~QContactData() {}
+    ~QContactData() { delete m_typeIndex.loadAcquire(); }
 
     QContactId m_id;
     QContactCollectionId m_collectionId;
@@ -93,8 +131,22 @@ public:
     void removeOnly(QContactDetail::DetailType type);
     void removeOnly(const QSet<QContactDetail::DetailType>& types);
 
+    // Per-type lookups, served from an index which is rebuilt lazily after m_details changes
+    QContactDetailTypeView detailsOfType(QContactDetail::DetailType type) const;
+    const QContactDetail *firstDetailOfType(QContactDetail::DetailType type) const;
+
+    // Must be called whenever details are added to or removed from m_details, or reordered
+    inline void detailsChanged() { delete m_typeIndex.fetchAndStoreOrdered(0); }
+
     // Trampoline
     static QSharedDataPointer<QContactData>& contactData(QContact& contact) {return contact.d;}
+    static const QContactData *get(const QContact& contact) {return contact.d.constData();}
+
+private:
+    const QContactDetailTypeIndex *typeIndex() const;
+
+    // Built on first use; the atomic pointer lets concurrent readers of a shared contact race safely
+    mutable QAtomicPointer<QContactDetailTypeIndex> m_typeIndex;
 };
 
 QT_END_NAMESPACE_CONTACTS
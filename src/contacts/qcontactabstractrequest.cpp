@@ -152,6 +152,11 @@ QT_BEGIN_NAMESPACE_CONTACTS
   \value RelationshipRemoveRequest A request to remove any relationships which match the request criteria
   \value RelationshipSaveRequest A request to save a list of relationships
   \value ContactFetchByIdRequest A request to fetch a list of contacts given a list of ids
+  \value CollectionFetchRequest A request to fetch collections
+  \value CollectionRemoveRequest A request to remove collections
+  \value CollectionSaveRequest A request to save collections
+  \value ContactChangesFetchRequest A request to fetch the contacts added, changed and removed since a revision
+  \value ContactCountRequest A request to count the contacts which match a filter
  */
 
 /*!
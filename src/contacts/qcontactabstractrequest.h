@@ -85,7 +85,9 @@ public:
         ContactFetchByIdRequest,
         CollectionFetchRequest,
         CollectionRemoveRequest,
-        CollectionSaveRequest
+        CollectionSaveRequest,
+        ContactChangesFetchRequest,
+        ContactCountRequest
     };
 
     RequestType type() const;
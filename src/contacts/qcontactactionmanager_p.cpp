@@ -41,7 +41,9 @@
 
 #include "qcontactaction.h"
 #include "qcontactactionfactory.h"
+#include "qcontactcompiledfilter_p.h"
 #include "qcontactmanager_p.h"
+#include "qcontactunionfilter.h"
 
 QT_BEGIN_NAMESPACE_CONTACTS
 
@@ -52,6 +54,10 @@ Q_GLOBAL_STATIC(QContactActionManager, contactActionManagerInstance)
   \class QContactActionManager
   This class uses a plugin to delegate discovery of actions (to avoid a dependency on SFW for QtContacts)
   It is an implementation detail of QContactAction.
+
+  The filters of the actions with each name are validated and compiled once, and kept until
+  the plugin reports that actions have been added or removed.  Lookups in that cache only
+  share a read lock; the filters of a missing name are built without holding the lock.
  */
 
 QContactActionManager* QContactActionManager::instance()
@@ -61,7 +67,9 @@ QContactActionManager* QContactActionManager::instance()
 
 QContactActionManager::QContactActionManager()
     : QObject(),
-    m_plugin(0)
+    m_plugin(0),
+    m_notifier(0),
+    m_generation(0)
 {
 }
 
@@ -70,6 +78,13 @@ void QContactActionManager::init()
     // We ask the qcontactmanager engine loading code, since it has to enumerate things anyway
     QContactManagerData::loadFactoriesMetadata();
     m_plugin = QContactManagerData::m_actionManagers.value(0);
+
+    QObject *notifier = m_plugin ? m_plugin->changeNotifier() : 0;
+    if (notifier && notifier != m_notifier) {
+        // invalidate directly, from whichever thread the plugin changes in
+        connect(notifier, SIGNAL(descriptorsChanged()), this, SLOT(invalidateFilters()), Qt::DirectConnection);
+        m_notifier = notifier;
+    }
 }
 
 QContactActionManager::~QContactActionManager()
@@ -125,6 +140,86 @@ QContactAction* QContactActionManager::action(const QContactActionDescriptor& de
     return 0;
 }
 
+/*!
+  Returns the valid filters of the actions named \a actionName; filters which refer to
+  actions themselves are left out.
+ */
+QList<QContactFilter> QContactActionManager::actionFilters(const QString& actionName)
+{
+    return cachedFilters(actionName).filters;
+}
+
+/*!
+  Returns the compiled union of the filters of the actions named \a actionName, in the
+  order of their descriptors, up to the first filter which refers to actions itself.
+  The returned node may be tested from several threads at once.
+ */
+QSharedPointer<const QContactCompiledFilterNode> QContactActionManager::compiledActionFilter(const QString& actionName)
+{
+    return cachedFilters(actionName).compiled;
+}
+
+/*!
+  Returns the number of times the cached action filters have been discarded.
+ */
+int QContactActionManager::generation() const
+{
+    return m_generation.load();
+}
+
+/*!
+  Discards the cached action filters; called when the plugin's actions change.
+ */
+void QContactActionManager::invalidateFilters()
+{
+    QWriteLocker locker(&m_cacheLock);
+    m_cache.clear();
+    m_generation.ref();
+}
+
+QContactActionManager::ActionFilters QContactActionManager::cachedFilters(const QString& actionName)
+{
+    {
+        QReadLocker locker(&m_cacheLock);
+        ActionFilterCache::const_iterator it = m_cache.constFind(actionName);
+        if (it != m_cache.constEnd())
+            return it.value();
+    }
+
+    // The filters are built without holding the lock, and only cached if the actions have not
+    // changed meanwhile.
+    const int generation = m_generation.load();
+
+    // Action filters are not allowed to return action filters, at all; the compiled union
+    // does not consider any action after an invalid one.
+    ActionFilters entry;
+    QList<QContactFilter> compiledFilters;
+    bool valid = true;
+    const QList<QContactActionDescriptor> descriptors = actionDescriptors(actionName);
+    foreach (const QContactActionDescriptor &descriptor, descriptors) {
+        const QContactFilter filter = descriptor.contactFilter();
+        if (!validateActionFilter(filter)) {
+            valid = false;
+            continue;
+        }
+        entry.filters.append(filter);
+        if (valid)
+            compiledFilters.append(filter);
+    }
+
+    QContactUnionFilter compiledUnion;
+    compiledUnion.setFilters(compiledFilters);
+    entry.compiled = QSharedPointer<const QContactCompiledFilterNode>(QContactCompiledFilterPrivate::compile(compiledUnion));
+
+    QWriteLocker locker(&m_cacheLock);
+    ActionFilterCache::const_iterator it = m_cache.constFind(actionName);
+    if (it != m_cache.constEnd())
+        return it.value(); // built by another thread meanwhile
+    if (m_generation.load() == generation)
+        m_cache.insert(actionName, entry);
+    return entry;
+}
+
 QT_END_NAMESPACE_CONTACTS
 
 #include "moc_qcontactactionmanager_p.cpp"
@@ -51,23 +51,32 @@
 // We mean it.
 //
 
+#include <QtCore/qatomic.h>
 #include <QtCore/qhash.h>
 #include <QtCore/qlist.h>
 #include <QtCore/qmutex.h>
+#include <QtCore/qreadwritelock.h>
+#include <QtCore/qsharedpointer.h>
 
 #include <QtContacts/qcontact.h>
 #include <QtContacts/qcontactactiondescriptor.h>
+#include <QtContacts/qcontactfilter.h>
 
 QT_BEGIN_NAMESPACE_CONTACTS
 
 class QContactAction;
 class QContactActionFactory;
+class QContactCompiledFilterNode;
 
 // For now this is a very direct interface, not really designed for extensibility
 class QContactActionManagerPlugin {
 public:
     virtual QHash<QContactActionDescriptor, QContactActionFactory*> actionFactoryHash() = 0; // descriptor to action factory ptr.
     virtual QMultiHash<QString, QContactActionDescriptor> descriptorHash() = 0;  // action name to descriptor
+
+    // A plugin whose actions can change at run time returns an object with a descriptorsChanged()
+    // signal, emitted whenever actions are added or removed, so that cached action filters are discarded.
+    virtual QObject *changeNotifier() { return 0; }
 };
 
 class QContactActionManager : public QObject
@@ -84,10 +93,30 @@ public:
     QList<QContactActionDescriptor> actionDescriptors(const QString& actionName = QString());
     QContactAction* action(const QContactActionDescriptor& descriptor);
 
+    QList<QContactFilter> actionFilters(const QString& actionName);
+    QSharedPointer<const QContactCompiledFilterNode> compiledActionFilter(const QString& actionName);
+    int generation() const;
+
+private slots:
+    void invalidateFilters();
+
 private:
+    struct ActionFilters {
+        QList<QContactFilter> filters; // the valid filters of the actions
+        QSharedPointer<const QContactCompiledFilterNode> compiled; // the union of the filters before the first invalid one
+    };
+    typedef QHash<QString, ActionFilters> ActionFilterCache;
+
     void init();
+    ActionFilters cachedFilters(const QString& actionName);
+
     QMutex m_instanceMutex;
     QContactActionManagerPlugin* m_plugin;
+    QObject* m_notifier;
+
+    QReadWriteLock m_cacheLock; // guards m_cache; readers only hold it for a lookup
+    QAtomicInt m_generation;    // changed only while m_cacheLock is held for writing
+    ActionFilterCache m_cache;
 };
 
 QT_END_NAMESPACE_CONTACTS
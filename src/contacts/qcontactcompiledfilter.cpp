@@ -0,0 +1,995 @@
+/****************************************************************************
+**
+** Copyright (C) 2017 The Qt Company Ltd.
+** Contact: https://www.qt.io/licensing/
+**
+** This file is part of the QtContacts module of the Qt Toolkit.
+**
+** $QT_BEGIN_LICENSE:LGPL$
+** Commercial License Usage
+** Licensees holding valid commercial Qt licenses may use this file in
+** accordance with the commercial license agreement provided with the
+** Software or, alternatively, in accordance with the terms contained in
+** a written agreement between you and The Qt Company. For licensing terms
+** and conditions see https://www.qt.io/terms-conditions. For further
+** information use the contact form at https://www.qt.io/contact-us.
+**
+** GNU Lesser General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU Lesser
+** General Public License version 3 as published by the Free Software
+** Foundation and appearing in the file LICENSE.LGPL3 included in the
+** packaging of this file. Please review the following information to
+** ensure the GNU Lesser General Public License version 3 requirements
+** will be met: https://www.gnu.org/licenses/lgpl-3.0.html.
+**
+** GNU General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU
+** General Public License version 2.0 or (at your option) the GNU General
+** Public license version 3 or any later version approved by the KDE Free
+** Qt Foundation. The licenses are as published by the Free Software
+** Foundation and appearing in the file LICENSE.GPL2 and LICENSE.GPL3
+** included in the packaging of this file. Please review the following
+** information to ensure the GNU General Public License requirements will
+** be met: https://www.gnu.org/licenses/gpl-2.0.html and
+** https://www.gnu.org/licenses/gpl-3.0.html.
+**
+** $QT_END_LICENSE$
+**
+****************************************************************************/
+
+#include "qcontactcompiledfilter.h"
+#include "qcontactcompiledfilter_p.h"
+
+#include <algorithm>
+
+#include <QtCore/qatomic.h>
+#include <QtCore/qmutex.h>
+#include <QtCore/qscopedpointer.h>
+#include <QtCore/qset.h>
+#include <QtCore/qvector.h>
+
+#include "qcontact.h"
+#include "qcontact_p.h"
+#include "qcontactactiondescriptor.h"
+#include "qcontactactionmanager_p.h"
+#include "qcontactdetail_p.h"
+#include "qcontactidfilter_p.h"
+#include "qcontactdetails.h"
+#include "qcontactfilters.h"
+#include "qcontactmanagerengine.h"
+
+QT_BEGIN_NAMESPACE_CONTACTS
+
+/*!
+  \class QContactCompiledFilter
+  \brief The QContactCompiledFilter class is a QContactFilter prepared for repeated evaluation.
+
+  \inmodule QtContacts
+
+  \ingroup contacts-backends
+
+  Testing a QContactFilter against a contact involves inspecting the filter's type and
+  parameters, and preparing the values to compare against (for example, stripping the
+  non-digit characters from a phone number), every time a contact is tested.
+
+  A QContactCompiledFilter performs that work once, when it is constructed: id and collection
+  lists are turned into hash sets, match values are normalized, nested intersection and union
+  filters are flattened, and terms which can never (or will always) match are folded away.
+  Engines which test the same filter against many contacts, such as engines which filter
+  contacts in memory, should compile the filter once per query and call matches() for each
+  contact.
+
+  The result of matches() is identical to that of QContactManagerEngine::testFilter(),
+  which is itself implemented in terms of this class.  The filters of any actions referred to by
+  a QContactActionFilter are resolved when the filter is compiled; they are compiled once and
+  cached until actions are added or removed.
+
+  The terms of intersection and union filters are tested cheapest first.  As a compiled
+  filter is used, it also learns which terms most often decide the result, and moves them
+  forward; the result of matches() never depends on the order in which terms are tested.
+
+  A compiled filter may be used from several threads at once.
+ */
+
+/* Returns the digits in the given string; other characters are ignored */
+static QString phoneNumberDigits(const QString &value)
+{
+    QString digits;
+    digits.reserve(value.size());
+    for (int i = 0; i < value.size(); i++) {
+        const QChar current = value.at(i);
+        // note: we ignore characters like '+', 'p', 'w', '*' and '#' which may be important.
+        if (current.isDigit())
+            digits.append(current);
+    }
+    return digits;
+}
+
+/* Returns the given (lower case) string with letters replaced by their ITU-T keypad digits */
+static QString keypadCollated(const QString &value)
+{
+    QString collated;
+    collated.reserve(value.size());
+    for (int i = 0; i < value.size(); i++) {
+        const QChar current = value.at(i);
+        if (current == QLatin1Char('a') || current == QLatin1Char('b') || current == QLatin1Char('c'))
+            collated.append(QLatin1Char('2'));
+        else if (current == QLatin1Char('d') || current == QLatin1Char('e') || current == QLatin1Char('f'))
+            collated.append(QLatin1Char('3'));
+        else if (current == QLatin1Char('g') || current == QLatin1Char('h') || current == QLatin1Char('i'))
+            collated.append(QLatin1Char('4'));
+        else if (current == QLatin1Char('j') || current == QLatin1Char('k') || current == QLatin1Char('l'))
+            collated.append(QLatin1Char('5'));
+        else if (current == QLatin1Char('m') || current == QLatin1Char('n') || current == QLatin1Char('o'))
+            collated.append(QLatin1Char('6'));
+        else if (current == QLatin1Char('p') || current == QLatin1Char('q') || current == QLatin1Char('r') || current == QLatin1Char('s'))
+            collated.append(QLatin1Char('7'));
+        else if (current == QLatin1Char('t') || current == QLatin1Char('u') || current == QLatin1Char('v'))
+            collated.append(QLatin1Char('8'));
+        else if (current == QLatin1Char('w') || current == QLatin1Char('x') || current == QLatin1Char('y') || current == QLatin1Char('z'))
+            collated.append(QLatin1Char('9'));
+        else
+            collated.append(current);
+    }
+    return collated;
+}
+
+/* Returns true if value satisfies the match type (the lowest three match flag bits) for needle.
+ * Combinations of match types are not a criterion, and always pass. */
+static inline bool matchesMatchType(int matchType, const QString &value, const QString &needle)
+{
+    switch (matchType) {
+    case QContactFilter::MatchExactly:
+        return value == needle;
+    case QContactFilter::MatchContains:
+        return value.contains(needle);
+    case QContactFilter::MatchStartsWith:
+        return value.startsWith(needle);
+    case QContactFilter::MatchEndsWith:
+        return value.endsWith(needle);
+    default:
+        return true;
+    }
+}
+
+/* Compares value with a needle already case folded as required, like compareStrings() does */
+static inline int compareWithPrepared(const QString &value, const QString &preparedNeedle, Qt::CaseSensitivity cs)
+{
+    return (cs == Qt::CaseSensitive ? value : value.toCaseFolded()).localeAwareCompare(preparedNeedle);
+}
+
+static inline QString prepareForComparison(const QString &needle, Qt::CaseSensitivity cs)
+{
+    return cs == Qt::CaseSensitive ? needle : needle.toCaseFolded();
+}
+
+namespace {
+
+class ConstantNode : public QContactCompiledFilterNode
+{
+public:
+    explicit ConstantNode(bool value) : QContactCompiledFilterNode(Constant), m_value(value) { m_cost = 0; }
+    bool matches(const QContact &) const { return m_value; }
+
+    const bool m_value;
+};
+
+/* Matches contacts whose id is in the id filter; the hash of the ids is kept by the filter,
+ * so that compiling the same filter again does not rebuild it */
+class IdNode : public QContactCompiledFilterNode
+{
+public:
+    explicit IdNode(const QContactIdFilter &filter)
+        : m_filter(filter)
+        , m_d(static_cast<const QContactIdFilterPrivate *>(QContactFilterPrivate::extract_d(m_filter).constData())) {}
+    bool matches(const QContact &contact) const { return m_d->containsId(contact.id()); }
+
+private:
+    const QContactIdFilter m_filter;
+    const QContactIdFilterPrivate *const m_d;
+};
+
+class CollectionNode : public QContactCompiledFilterNode
+{
+public:
+    explicit CollectionNode(const QSet<QContactCollectionId> &ids) : m_ids(ids) {}
+    bool matches(const QContact &contact) const { return m_ids.contains(contact.collectionId()); }
+
+private:
+    const QSet<QContactCollectionId> m_ids;
+};
+
+/* Matches contacts with at least one detail of the given type */
+class DetailPresenceNode : public QContactCompiledFilterNode
+{
+public:
+    explicit DetailPresenceNode(QContactDetail::DetailType type) : m_type(type) {}
+    bool matches(const QContact &contact) const { return QContactData::get(contact)->firstDetailOfType(m_type) != 0; }
+
+private:
+    const QContactDetail::DetailType m_type;
+};
+
+/* Matches contacts with a detail of the given type which has a value for the given field */
+class FieldPresenceNode : public QContactCompiledFilterNode
+{
+public:
+    FieldPresenceNode(QContactDetail::DetailType type, int field, bool requireNonNull)
+        : m_type(type), m_field(field), m_requireNonNull(requireNonNull) {}
+
+    bool matches(const QContact &contact) const
+    {
+        const QContactDetailTypeView details = QContactData::get(contact)->detailsOfType(m_type);
+        for (int j = 0; j < details.count(); j++) {
+            const QContactDetail &detail = details.at(j);
+            if (detail.hasValue(m_field) && (!m_requireNonNull || !detail.value(m_field).isNull()))
+                return true;
+        }
+        return false;
+    }
+
+private:
+    const QContactDetail::DetailType m_type;
+    const int m_field;
+    const bool m_requireNonNull;
+};
+
+class PhoneNumberNode : public QContactCompiledFilterNode
+{
+public:
+    PhoneNumberNode(QContactDetail::DetailType type, int field, int matchType, const QString &input)
+        : m_type(type), m_field(field), m_matchType(matchType)
+        , m_digits(phoneNumberDigits(input)), m_rightDigits(m_digits.right(7)) {}
+
+    bool matches(const QContact &contact) const
+    {
+        const QContactDetailTypeView details = QContactData::get(contact)->detailsOfType(m_type);
+        for (int j = 0; j < details.count(); j++) {
+            const QString digits = phoneNumberDigits(QContactDetailPrivate::detailPrivate(details.at(j))->stringValue(m_field));
+
+            // if the matchflags input don't require a particular criteria to pass, we assume that it has passed.
+            if (matchesMatchType(m_matchType, digits, m_digits))
+                return true;
+
+            // fallback case: default MatchPhoneNumber compares the rightmost 7 digits, ignoring other matchflags.
+            if (digits.right(7) == m_rightDigits)
+                return true;
+        }
+        return false;
+    }
+
+private:
+    const QContactDetail::DetailType m_type;
+    const int m_field;
+    const int m_matchType;
+    const QString m_digits;
+    const QString m_rightDigits;
+};
+
+class KeypadCollationNode : public QContactCompiledFilterNode
+{
+public:
+    KeypadCollationNode(QContactDetail::DetailType type, int field, int matchType, const QString &input)
+        : m_type(type), m_field(field), m_matchType(matchType), m_input(input) {}
+
+    bool matches(const QContact &contact) const
+    {
+        const QContactDetailTypeView details = QContactData::get(contact)->detailsOfType(m_type);
+        for (int j = 0; j < details.count(); j++) {
+            // we use ITU-T keypad collation by default.
+            const QString collated = keypadCollated(QContactDetailPrivate::detailPrivate(details.at(j))->stringValue(m_field).toLower());
+            if (matchesMatchType(m_matchType, collated, m_input))
+                return true;
+        }
+        return false;
+    }
+
+private:
+    const QContactDetail::DetailType m_type;
+    const int m_field;
+    const int m_matchType;
+    const QString m_input;
+};
+
+class StringMatchNode : public QContactCompiledFilterNode
+{
+public:
+    StringMatchNode(QContactDetail::DetailType type, int field, int matchType, const QString &needle, Qt::CaseSensitivity cs)
+        : m_type(type), m_field(field), m_matchType(matchType), m_cs(cs)
+        , m_needle(needle), m_preparedNeedle(prepareForComparison(needle, cs)) {}
+
+    bool matches(const QContact &contact) const
+    {
+        const QContactDetailTypeView details = QContactData::get(contact)->detailsOfType(m_type);
+        for (int j = 0; j < details.count(); j++) {
+            const QString var = QContactDetailPrivate::detailPrivate(details.at(j))->stringValue(m_field);
+            if (m_matchType == QContactFilter::MatchStartsWith && var.startsWith(m_needle, m_cs))
+                return true;
+            if (m_matchType == QContactFilter::MatchEndsWith && var.endsWith(m_needle, m_cs))
+                return true;
+            if (m_matchType == QContactFilter::MatchContains && var.contains(m_needle, m_cs))
+                return true;
+            if (compareWithPrepared(var, m_preparedNeedle, m_cs) == 0)
+                return true;
+        }
+        return false;
+    }
+
+private:
+    const QContactDetail::DetailType m_type;
+    const int m_field;
+    const int m_matchType;
+    const Qt::CaseSensitivity m_cs;
+    const QString m_needle;
+    const QString m_preparedNeedle;
+};
+
+class ValueMatchNode : public QContactCompiledFilterNode
+{
+public:
+    ValueMatchNode(QContactDetail::DetailType type, int field, const QVariant &value, Qt::CaseSensitivity cs)
+        : m_type(type), m_field(field), m_value(value), m_cs(cs) {}
+
+    bool matches(const QContact &contact) const
+    {
+        const QContactDetailTypeView details = QContactData::get(contact)->detailsOfType(m_type);
+        for (int j = 0; j < details.count(); j++) {
+            const QVariant var = details.at(j).value(m_field);
+            if (!var.isNull() && QContactManagerEngine::compareVariant(var, m_value, m_cs) == 0)
+                return true;
+        }
+        return false;
+    }
+
+private:
+    const QContactDetail::DetailType m_type;
+    const int m_field;
+    const QVariant m_value;
+    const Qt::CaseSensitivity m_cs;
+};
+
+class StringRangeNode : public QContactCompiledFilterNode
+{
+public:
+    StringRangeNode(const QContactDetailRangeFilter &filter, Qt::CaseSensitivity cs)
+        : m_type(filter.detailType()), m_field(filter.detailField()), m_cs(cs)
+        , m_minValue(prepareForComparison(filter.minValue().toString(), cs))
+        , m_maxValue(prepareForComparison(filter.maxValue().toString(), cs))
+        , m_testMin(!filter.minValue().toString().isEmpty())
+        , m_testMax(!filter.maxValue().toString().isEmpty())
+        , m_minComp(filter.rangeFlags() & QContactDetailRangeFilter::ExcludeLower ? 1 : 0)
+        , m_maxComp(filter.rangeFlags() & QContactDetailRangeFilter::IncludeUpper ? 1 : 0) {}
+
+    bool matches(const QContact &contact) const
+    {
+        const QContactDetailTypeView details = QContactData::get(contact)->detailsOfType(m_type);
+        for (int j = 0; j < details.count(); j++) {
+            // The detail has to have a field of this type in order to be compared.
+            const QContactDetail &detail = details.at(j);
+            if (!detail.hasValue(m_field))
+                continue;
+            const QString var = QContactDetailPrivate::detailPrivate(detail)->stringValue(m_field);
+            if (m_testMin && compareWithPrepared(var, m_minValue, m_cs) < m_minComp)
+                continue;
+            if (m_testMax && compareWithPrepared(var, m_maxValue, m_cs) >= m_maxComp)
+                continue;
+            return true;
+        }
+        return false;
+    }
+
+private:
+    const QContactDetail::DetailType m_type;
+    const int m_field;
+    const Qt::CaseSensitivity m_cs;
+    const QString m_minValue;
+    const QString m_maxValue;
+    const bool m_testMin;
+    const bool m_testMax;
+    const int m_minComp;
+    const int m_maxComp;
+};
+
+class ValueRangeNode : public QContactCompiledFilterNode
+{
+public:
+    ValueRangeNode(const QContactDetailRangeFilter &filter, Qt::CaseSensitivity cs)
+        : m_type(filter.detailType()), m_field(filter.detailField()), m_cs(cs)
+        , m_minValue(filter.minValue()), m_maxValue(filter.maxValue())
+        , m_testMin(m_minValue.isValid()), m_testMax(m_maxValue.isValid())
+        , m_minComp(filter.rangeFlags() & QContactDetailRangeFilter::ExcludeLower ? 1 : 0)
+        , m_maxComp(filter.rangeFlags() & QContactDetailRangeFilter::IncludeUpper ? 1 : 0) {}
+
+    bool matches(const QContact &contact) const
+    {
+        const QContactDetailTypeView details = QContactData::get(contact)->detailsOfType(m_type);
+        for (int j = 0; j < details.count(); j++) {
+            // The detail has to have a field of this type in order to be compared.
+            const QVariant var = details.at(j).value(m_field);
+            if (!var.isValid())
+                continue;
+            if (m_testMin && QContactManagerEngine::compareVariant(var, m_minValue, m_cs) < m_minComp)
+                continue;
+            if (m_testMax && QContactManagerEngine::compareVariant(var, m_maxValue, m_cs) >= m_maxComp)
+                continue;
+            return true;
+        }
+        return false;
+    }
+
+private:
+    const QContactDetail::DetailType m_type;
+    const int m_field;
+    const Qt::CaseSensitivity m_cs;
+    const QVariant m_minValue;
+    const QVariant m_maxValue;
+    const bool m_testMin;
+    const bool m_testMax;
+    const int m_minComp;
+    const int m_maxComp;
+};
+
+/* Matches any contact that plays the specified role in a relationship
+ * of the specified type with the specified other participant. */
+class RelationshipNode : public QContactCompiledFilterNode
+{
+public:
+    explicit RelationshipNode(const QContactRelationshipFilter &filter)
+        : m_relationshipType(filter.relationshipType()), m_relatedId(filter.relatedContactId())
+        , m_relatedRole(filter.relatedContactRole()) {}
+
+    bool matches(const QContact &contact) const
+    {
+        const QContactId contactId = contact.id();
+        if (m_relatedId == contactId)
+            return false;
+
+        foreach (const QContactRelationship &rel, contact.relationships()) {
+            if (!m_relationshipType.isEmpty() && rel.relationshipType() != m_relationshipType)
+                continue;
+
+            if (m_relatedRole == QContactRelationship::Second) {
+                // the contact must be the first in the relationship.
+                if (rel.first() == contactId && (m_relatedId.isNull() || m_relatedId == rel.second()))
+                    return true;
+            } else if (m_relatedRole == QContactRelationship::First) {
+                // the contact must be the second in the relationship.
+                if (rel.second() == contactId && (m_relatedId.isNull() || m_relatedId == rel.first()))
+                    return true;
+            } else if (m_relatedId.isNull() || m_relatedId == rel.first() || m_relatedId == rel.second()) {
+                return true;
+            }
+        }
+        return false;
+    }
+
+private:
+    const QString m_relationshipType;
+    const QContactId m_relatedId;
+    const QContactRelationship::Role m_relatedRole;
+};
+
+class ChangeLogNode : public QContactCompiledFilterNode
+{
+public:
+    explicit ChangeLogNode(const QContactChangeLogFilter &filter)
+        : m_eventType(filter.eventType()), m_since(filter.since()) {}
+
+    bool matches(const QContact &contact) const
+    {
+        // See if timestamps are even supported
+        const QContactTimestamp ts = contact.detail(QContactTimestamp::Type);
+        if (ts.isEmpty())
+            return false;
+        if (m_eventType == QContactChangeLogFilter::EventAdded)
+            return m_since <= ts.created();
+        return m_since <= ts.lastModified();
+    }
+
+private:
+    const QContactChangeLogFilter::EventType m_eventType;
+    const QDateTime m_since;
+};
+
+/* The terms of a non-empty intersection or union.
+ *
+ * The terms are tested cheapest first, by their estimated costs.  While the filter is in
+ * use, a sample of its tests also counts how often each term is tested and how often it
+ * decides the result (by failing an intersection, or passing a union), and every
+ * ReorderInterval samples the terms are reordered by their cost per decision, so that the
+ * terms which end a test early for little work come first.  A published order is never
+ * modified, so concurrent tests use either the previous order or the new one.  Once
+ * MaximumOrders have been published the order is final, and nothing more is counted. */
+class CompoundNode : public QContactCompiledFilterNode
+{
+public:
+    CompoundNode(NodeType nodeType, bool decisive)
+        : QContactCompiledFilterNode(nodeType), m_decisive(decisive), m_adapting(1), m_calls(0) {}
+    ~CompoundNode()
+    {
+        qDeleteAll(m_terms);
+        qDeleteAll(m_orders);
+    }
+
+    /* Orders the terms by their estimated costs; called once every term has been added */
+    void prepare()
+    {
+        std::stable_sort(m_terms.begin(), m_terms.end(), cheaper);
+
+        m_cost = 0;
+        QVector<int> *order = new QVector<int>(m_terms.count());
+        for (int j = 0; j < m_terms.count(); j++) {
+            m_cost += m_terms.at(j)->m_cost;
+            (*order)[j] = j;
+        }
+        m_statistics.reset(new TermStatistics[m_terms.count()]);
+        m_orders.append(order);
+        m_order.storeRelease(order);
+    }
+
+    bool matches(const QContact &contact) const
+    {
+        const QVector<int> &order = *m_order.loadAcquire();
+        if (m_adapting.load()) {
+            // the calls are counted without a read-modify-write; a count lost to a race
+            // only delays the next sample
+            const int calls = m_calls.load() + 1;
+            m_calls.store(calls);
+            if (calls % SampleInterval == 0)
+                return sampledMatches(contact, order, calls / SampleInterval);
+        }
+
+        for (int j = 0; j < order.count(); j++) {
+            if (m_terms.at(order.at(j))->matches(contact) == m_decisive)
+                return m_decisive;
+        }
+        return !m_decisive;
+    }
+
+    QVector<QContactCompiledFilterNode *> m_terms;
+
+private:
+    enum {
+        SampleInterval = 8,     // the statistics are collected from one call in this many
+        ReorderInterval = 32,   // samples
+        MaximumOrders = 32      // stop adapting, rather than keep retired orders without bound
+    };
+
+    struct TermStatistics
+    {
+        QAtomicInt tests;
+        QAtomicInt decisions;
+    };
+
+    static bool cheaper(const QContactCompiledFilterNode *a, const QContactCompiledFilterNode *b)
+    {
+        return a->m_cost < b->m_cost;
+    }
+
+    /* Tests the terms like matches(), recording which of them were tested and which decided */
+    bool sampledMatches(const QContact &contact, const QVector<int> &order, int samples) const
+    {
+        bool result = !m_decisive;
+        for (int j = 0; j < order.count(); j++) {
+            const int term = order.at(j);
+            m_statistics[term].tests.fetchAndAddRelaxed(1);
+            if (m_terms.at(term)->matches(contact) == m_decisive) {
+                m_statistics[term].decisions.fetchAndAddRelaxed(1);
+                result = m_decisive;
+                break;
+            }
+        }
+
+        if (samples % ReorderInterval == 0)
+            reorder();
+        return result;
+    }
+
+    void reorder() const
+    {
+        if (!m_reorderMutex.tryLock())
+            return; // another thread is already reordering
+        if (!m_adapting.load()) {
+            m_reorderMutex.unlock();
+            return;
+        }
+
+        // the expected cost of reaching a decision through each term; unseen terms count as even odds
+        QVector<QPair<double, int> > ranks;
+        ranks.reserve(m_terms.count());
+        for (int j = 0; j < m_terms.count(); j++) {
+            const int tests = m_statistics[j].tests.load();
+            const int decisions = m_statistics[j].decisions.load();
+            const double decisiveness = (decisions + 1.0) / (tests + 2.0);
+            ranks.append(qMakePair(m_terms.at(j)->m_cost / decisiveness, j));
+
+            // halve the counts, so that the order follows changes in the contacts being tested
+            m_statistics[j].tests.store(tests / 2);
+            m_statistics[j].decisions.store(decisions / 2);
+        }
+        std::stable_sort(ranks.begin(), ranks.end());
+
+        QVector<int> *order = new QVector<int>;
+        order->reserve(ranks.count());
+        for (int j = 0; j < ranks.count(); j++)
+            order->append(ranks.at(j).second);
+
+        if (*order != *m_order.loadAcquire()) {
+            m_orders.append(order);
+            m_order.storeRelease(order);
+            if (m_orders.count() >= MaximumOrders)
+                m_adapting.store(0); // the order is frozen, so no more statistics are collected
+        } else {
+            delete order;
+        }
+        m_reorderMutex.unlock();
+    }
+
+    const bool m_decisive; // the result of a term which decides the result of the compound
+    mutable QScopedArrayPointer<TermStatistics> m_statistics;
+    mutable QAtomicInt m_adapting;  // zero once the order is frozen
+    mutable QAtomicInt m_calls;     // approximately, the calls made while adapting
+    mutable QAtomicPointer<const QVector<int> > m_order; // the current order of the terms
+    mutable QList<const QVector<int> *> m_orders;         // every order published, in use or retired
+    mutable QMutex m_reorderMutex;
+};
+
+/* Tests a node owned elsewhere, such as the cached filter of an action */
+class SharedNode : public QContactCompiledFilterNode
+{
+public:
+    explicit SharedNode(const QSharedPointer<const QContactCompiledFilterNode> &node)
+        : m_node(node) { m_cost = node->m_cost; }
+    bool matches(const QContact &contact) const { return m_node->matches(contact); }
+
+    const QSharedPointer<const QContactCompiledFilterNode> m_node;
+};
+
+class IntersectionNode : public CompoundNode
+{
+public:
+    IntersectionNode() : CompoundNode(Intersection, false) {}
+};
+
+class UnionNode : public CompoundNode
+{
+public:
+    UnionNode() : CompoundNode(Union, true) {}
+};
+
+} // namespace
+
+/* Returns the value of the given node if it is a constant, or -1 otherwise */
+static int constantValue(const QContactCompiledFilterNode *node)
+{
+    if (node->m_nodeType != QContactCompiledFilterNode::Constant)
+        return -1;
+    return static_cast<const ConstantNode *>(node)->m_value ? 1 : 0;
+}
+
+/* Compiles the given filters into the terms of an intersection (if isIntersection) or union.
+ * Terms which cannot affect the result are dropped, and nested compounds of the same kind are
+ * flattened.  Returns the compiled compound, or a constant if the result is already known. */
+static QContactCompiledFilterNode *compileCompound(const QList<QContactFilter> &filters, bool isIntersection)
+{
+    // empty intersections and unions never match.
+    if (filters.isEmpty())
+        return new ConstantNode(false);
+
+    CompoundNode *compound = isIntersection ? static_cast<CompoundNode *>(new IntersectionNode)
+                                            : static_cast<CompoundNode *>(new UnionNode);
+    // an intersection is decided by a term which never matches, a union by one which always does.
+    const int decisive = isIntersection ? 0 : 1;
+
+    for (int j = 0; j < filters.count(); j++) {
+        QContactCompiledFilterNode *term = QContactCompiledFilterPrivate::compile(filters.at(j));
+        const int value = constantValue(term);
+        if (value == decisive) {
+            delete compound;
+            return term;
+        }
+        if (value != -1) {
+            delete term;
+            continue;
+        }
+
+        if (term->m_nodeType == compound->m_nodeType) {
+            CompoundNode *nested = static_cast<CompoundNode *>(term);
+            compound->m_terms += nested->m_terms;
+            nested->m_terms.clear();
+            delete nested;
+        } else {
+            compound->m_terms.append(term);
+        }
+    }
+
+    // every term was neutral.
+    if (compound->m_terms.isEmpty()) {
+        delete compound;
+        return new ConstantNode(!decisive);
+    }
+    if (compound->m_terms.count() == 1) {
+        QContactCompiledFilterNode *term = compound->m_terms.takeFirst();
+        delete compound;
+        return term;
+    }
+    compound->prepare();
+    return compound;
+}
+
+/* Compiles a field presence test; fields above FieldMaximumUserVisible are never reported as present */
+static QContactCompiledFilterNode *compileFieldPresence(QContactDetail::DetailType type, int field, bool requireNonNull)
+{
+    if (field > QContactDetail::FieldMaximumUserVisible)
+        return new ConstantNode(false);
+    return new FieldPresenceNode(type, field, requireNonNull);
+}
+
+/* Compiles a detail filter into a presence test or a value test chosen by its match flags */
+static QContactCompiledFilterNode *compileDetailFilter(const QContactDetailFilter &cdf)
+{
+    if (cdf.detailType() == QContactDetail::TypeUndefined)
+        return new ConstantNode(false);
+
+    /* See if we need to check the values */
+    if (cdf.detailField() == -1)
+        return new DetailPresenceNode(cdf.detailType());  /* just testing for the presence of a detail of the specified type */
+
+    /* Check that the field is present and has a non-empty value */
+    if (!cdf.value().isValid())
+        return compileFieldPresence(cdf.detailType(), cdf.detailField(), true);
+
+    const QContactFilter::MatchFlags flags = cdf.matchFlags();
+    const Qt::CaseSensitivity cs = (flags & QContactFilter::MatchCaseSensitive) ? Qt::CaseSensitive : Qt::CaseInsensitive;
+    const int matchType = flags & 7;
+
+    if (flags & QContactFilter::MatchPhoneNumber)
+        return new PhoneNumberNode(cdf.detailType(), cdf.detailField(), matchType, cdf.value().toString());
+    if (flags & QContactFilter::MatchKeypadCollation)
+        return new KeypadCollationNode(cdf.detailType(), cdf.detailField(), matchType, cdf.value().toString());
+    if (flags & (QContactFilter::MatchEndsWith | QContactFilter::MatchStartsWith | QContactFilter::MatchContains | QContactFilter::MatchFixedString))
+        return new StringMatchNode(cdf.detailType(), cdf.detailField(), matchType, cdf.value().toString(), cs);
+    return new ValueMatchNode(cdf.detailType(), cdf.detailField(), cdf.value(), cs);
+}
+
+/* Compiles a detail range filter; only MatchFixedString and MatchCaseSensitive are supported */
+static QContactCompiledFilterNode *compileDetailRangeFilter(const QContactDetailRangeFilter &cdf)
+{
+    if (cdf.detailType() == QContactDetail::TypeUndefined)
+        return new ConstantNode(false); /* we do not know which field to check */
+
+    /* Check for a detail presence test */
+    if (cdf.detailField() == -1)
+        return new DetailPresenceNode(cdf.detailType());
+
+    /* See if this is a field presence test */
+    if (!cdf.minValue().isValid() && !cdf.maxValue().isValid())
+        return compileFieldPresence(cdf.detailType(), cdf.detailField(), false);
+
+    const Qt::CaseSensitivity cs = (cdf.matchFlags() & QContactFilter::MatchCaseSensitive) ? Qt::CaseSensitive : Qt::CaseInsensitive;
+    if (cdf.matchFlags() & QContactFilter::MatchFixedString)
+        return new StringRangeNode(cdf, cs);
+    return new ValueRangeNode(cdf, cs);
+}
+
+/* Compiles an action filter into the union of the filters of the matching actions; the union
+ * is compiled once by the action manager, and shared by every filter referring to the actions */
+static QContactCompiledFilterNode *compileActionFilter(const QContactActionFilter &af)
+{
+    const QSharedPointer<const QContactCompiledFilterNode> actions = QContactActionManager::instance()->compiledActionFilter(af.actionName());
+    const int value = constantValue(actions.data());
+    if (value != -1)
+        return new ConstantNode(value == 1);
+    return new SharedNode(actions);
+}
+
+/* Compiles the given filter into the node which tests it, without estimating its cost */
+static QContactCompiledFilterNode *compileFilter(const QContactFilter &filter)
+{
+    switch (filter.type()) {
+    case QContactFilter::InvalidFilter:
+        return new ConstantNode(false);
+
+    case QContactFilter::DefaultFilter:
+        return new ConstantNode(true);
+
+    case QContactFilter::IdFilter:
+        return new IdNode(QContactIdFilter(filter));
+
+    case QContactFilter::ContactDetailFilter:
+        return compileDetailFilter(QContactDetailFilter(filter));
+
+    case QContactFilter::ContactDetailRangeFilter:
+        return compileDetailRangeFilter(QContactDetailRangeFilter(filter));
+
+    case QContactFilter::RelationshipFilter:
+        return new RelationshipNode(QContactRelationshipFilter(filter));
+
+    case QContactFilter::ChangeLogFilter:
+        {
+            const QContactChangeLogFilter ccf(filter);
+            // You can't emulate a removed..
+            if (ccf.eventType() == QContactChangeLogFilter::EventRemoved)
+                return new ConstantNode(false);
+            return new ChangeLogNode(ccf);
+        }
+
+    case QContactFilter::ActionFilter:
+        return compileActionFilter(QContactActionFilter(filter));
+
+    case QContactFilter::IntersectionFilter:
+        return compileCompound(QContactIntersectionFilter(filter).filters(), true);
+
+    case QContactFilter::UnionFilter:
+        return compileCompound(QContactUnionFilter(filter).filters(), false);
+
+    case QContactFilter::CollectionFilter:
+        return new CollectionNode(QContactCollectionFilter(filter).collectionIds());
+    }
+    return new ConstantNode(false);
+}
+
+/*!
+  \internal
+  Compiles \a filter into a tree of nodes which evaluate it.  The caller takes ownership.
+ */
+QContactCompiledFilterNode *QContactCompiledFilterPrivate::compile(const QContactFilter &filter)
+{
+    QContactCompiledFilterNode *node = compileFilter(filter);
+    if (node->m_cost < 0)
+        node->m_cost = estimatedCost(filter);
+    return node;
+}
+
+/*!
+  \internal
+  Returns the estimated cost of testing a contact against \a filter, relative to that of
+  looking up a hashed id.  Intersections and unions cost the sum of their terms.
+ */
+int QContactCompiledFilterPrivate::estimatedCost(const QContactFilter &filter)
+{
+    switch (filter.type()) {
+    case QContactFilter::InvalidFilter:
+    case QContactFilter::DefaultFilter:
+        return 0;
+
+    case QContactFilter::IdFilter:
+    case QContactFilter::CollectionFilter:
+        return 1;
+
+    case QContactFilter::ContactDetailFilter:
+        {
+            const QContactDetailFilter cdf(filter);
+            if (cdf.detailField() == -1)
+                return 2;
+            if (!cdf.value().isValid())
+                return 3;
+            if (cdf.matchFlags() & (QContactFilter::MatchPhoneNumber | QContactFilter::MatchKeypadCollation))
+                return 20; // normalizes every value tested
+            if (cdf.matchFlags() & (QContactFilter::MatchEndsWith | QContactFilter::MatchStartsWith | QContactFilter::MatchContains | QContactFilter::MatchFixedString))
+                return 10; // case folds and compares with the locale
+            return 5;
+        }
+
+    case QContactFilter::ContactDetailRangeFilter:
+        {
+            const QContactDetailRangeFilter cdf(filter);
+            if (cdf.detailField() == -1)
+                return 2;
+            if (!cdf.minValue().isValid() && !cdf.maxValue().isValid())
+                return 3;
+            if (cdf.matchFlags() & QContactFilter::MatchFixedString)
+                return 12;
+            return 6;
+        }
+
+    case QContactFilter::ChangeLogFilter:
+        return 4;
+
+    case QContactFilter::RelationshipFilter:
+        return 8;
+
+    case QContactFilter::ActionFilter:
+        return 30; // resolved to the filters of the matching actions, which are not known here
+
+    case QContactFilter::IntersectionFilter:
+    case QContactFilter::UnionFilter:
+        {
+            const QList<QContactFilter> terms = filter.type() == QContactFilter::IntersectionFilter
+                    ? QContactIntersectionFilter(filter).filters() : QContactUnionFilter(filter).filters();
+            int cost = 0;
+            foreach (const QContactFilter &term, terms)
+                cost += estimatedCost(term);
+            return cost;
+        }
+    }
+    return 0;
+}
+
+/*!
+  Given a QContactFilter \a filter retrieved from a QContactAction,
+  check that it is valid and cannot cause infinite recursion.
+
+  In particular, a filter from a QContactAction cannot contain
+  any instances of a QContactActionFilter.
+
+  Returns true if \a filter seems ok, or false otherwise.
+ */
+bool validateActionFilter(const QContactFilter &filter)
+{
+    QList<QContactFilter> toVerify;
+    toVerify << filter;
+
+    while (toVerify.count() > 0) {
+        QContactFilter f = toVerify.takeFirst();
+        if (f.type() == QContactFilter::ActionFilter)
+            return false;
+        if (f.type() == QContactFilter::IntersectionFilter)
+            toVerify.append(QContactIntersectionFilter(f).filters());
+        if (f.type() == QContactFilter::UnionFilter)
+            toVerify.append(QContactUnionFilter(f).filters());
+    }
+
+    return true;
+}
+
+/*!
+  Constructs a compiled filter which matches every contact, like a default constructed QContactFilter.
+ */
+QContactCompiledFilter::QContactCompiledFilter()
+    : d(new QContactCompiledFilterPrivate)
+{
+    d->m_root = QSharedPointer<const QContactCompiledFilterNode>(new ConstantNode(true));
+}
+
+/*!
+  Compiles the given \a filter.
+ */
+QContactCompiledFilter::QContactCompiledFilter(const QContactFilter &filter)
+    : d(new QContactCompiledFilterPrivate)
+{
+    d->m_filter = filter;
+    d->m_root = QSharedPointer<const QContactCompiledFilterNode>(QContactCompiledFilterPrivate::compile(filter));
+}
+
+/*!
+  Frees the memory used by this compiled filter.
+ */
+QContactCompiledFilter::~QContactCompiledFilter()
+{
+}
+
+/*!
+  Constructs a copy of the \a other compiled filter.
+ */
+QContactCompiledFilter::QContactCompiledFilter(const QContactCompiledFilter &other)
+    : d(other.d)
+{
+}
+
+/*!
+  Assigns this compiled filter to be \a other.
+ */
+QContactCompiledFilter &QContactCompiledFilter::operator=(const QContactCompiledFilter &other)
+{
+    d = other.d;
+    return *this;
+}
+
+/*!
+  Returns the filter which was compiled.
+ */
+QContactFilter QContactCompiledFilter::filter() const
+{
+    return d->m_filter;
+}
+
+/*!
+  Returns true if \a contact matches the compiled filter.
+ */
+bool QContactCompiledFilter::matches(const QContact &contact) const
+{
+    return d->m_root->matches(contact);
+}
+
+QT_END_NAMESPACE_CONTACTS
@@ -0,0 +1,107 @@
+/****************************************************************************
+**
+** Copyright (C) 2017 The Qt Company Ltd.
+** Contact: https://www.qt.io/licensing/
+**
+** This file is part of the QtContacts module of the Qt Toolkit.
+**
+** $QT_BEGIN_LICENSE:LGPL$
+** Commercial License Usage
+** Licensees holding valid commercial Qt licenses may use this file in
+** accordance with the commercial license agreement provided with the
+** Software or, alternatively, in accordance with the terms contained in
+** a written agreement between you and The Qt Company. For licensing terms
+** and conditions see https://www.qt.io/terms-conditions. For further
+** information use the contact form at https://www.qt.io/contact-us.
+**
+** GNU Lesser General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU Lesser
+** General Public License version 3 as published by the Free Software
+** Foundation and appearing in the file LICENSE.LGPL3 included in the
+** packaging of this file. Please review the following information to
+** ensure the GNU Lesser General Public License version 3 requirements
+** will be met: https://www.gnu.org/licenses/lgpl-3.0.html.
+**
+** GNU General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU
+** General Public License version 2.0 or (at your option) the GNU General
+** Public license version 3 or any later version approved by the KDE Free
+** Qt Foundation. The licenses are as published by the Free Software
+** Foundation and appearing in the file LICENSE.GPL2 and LICENSE.GPL3
+** included in the packaging of this file. Please review the following
+** information to ensure the GNU General Public License requirements will
+** be met: https://www.gnu.org/licenses/gpl-2.0.html and
+** https://www.gnu.org/licenses/gpl-3.0.html.
+**
+** $QT_END_LICENSE$
+**
+****************************************************************************/
+
+#ifndef QCONTACTCOMPILEDFILTER_P_H
+#define QCONTACTCOMPILEDFILTER_P_H
+
+//
+//  W A R N I N G
+//  -------------
+//
+// This file is not part of the Qt API.  It exists purely as an
+// implementation detail.  This header file may change from version to
+// version without notice, or even be removed.
+//
+// We mean it.
+//
+
+#include <QtCore/qshareddata.h>
+#include <QtCore/qsharedpointer.h>
+
+#include <QtContacts/qcontactcompiledfilter.h>
+#include <QtContacts/qcontactfilter.h>
+
+QT_BEGIN_NAMESPACE_CONTACTS
+
+class QContact;
+
+class QContactCompiledFilterNode
+{
+public:
+    enum NodeType {
+        Leaf,
+        Constant,
+        Intersection,
+        Union
+    };
+
+    explicit QContactCompiledFilterNode(NodeType nodeType = Leaf) : m_nodeType(nodeType), m_cost(-1) {}
+    virtual ~QContactCompiledFilterNode() {}
+
+    virtual bool matches(const QContact &contact) const = 0;
+
+    const NodeType m_nodeType;
+    int m_cost; // the estimated relative cost of a test, set when compiled
+};
+
+class QContactCompiledFilterPrivate : public QSharedData
+{
+public:
+    QContactCompiledFilterPrivate()
+        : QSharedData()
+    {
+    }
+
+    ~QContactCompiledFilterPrivate()
+    {
+    }
+
+    static QContactCompiledFilterNode *compile(const QContactFilter &filter);
+    static int estimatedCost(const QContactFilter &filter);
+
+    QContactFilter m_filter;
+    QSharedPointer<const QContactCompiledFilterNode> m_root; // immutable once compiled, so shared between copies
+};
+
+/* Returns false if the filter provided by an action could cause infinite recursion */
+bool validateActionFilter(const QContactFilter &filter);
+
+QT_END_NAMESPACE_CONTACTS
+
+#endif // QCONTACTCOMPILEDFILTER_P_H
@@ -51,8 +51,11 @@
 // We mean it.
 //
 
+#include <algorithm>
+
 #include <QMap>
 #include <QList>
+#include <QVector>
 #include <QString>
 #include <QVariant>
 #include <QDateTime>
@@ -64,6 +67,74 @@
 
 QT_BEGIN_NAMESPACE_CONTACTS
 
+/*
+    Storage for the field values which are not kept in typed members: (field, value) pairs
+    kept sorted by field in a single flat array.  Built-in details rarely have any such
+    values, so the store costs no more than a pointer until a value is added.
+*/
+class QContactDetailFieldStore
+{
+public:
+    struct Entry {
+        int field;
+        QVariant value;
+    };
+    typedef const Entry *const_iterator;
+
+    bool isEmpty() const { return m_entries.isEmpty(); }
+    int size() const { return m_entries.size(); }
+
+    const_iterator constBegin() const { return m_entries.constData(); }
+    const_iterator constEnd() const { return m_entries.constData() + m_entries.size(); }
+
+    const_iterator constFind(int field) const
+    {
+        const int i = lowerBound(field);
+        return (i < m_entries.size() && m_entries.at(i).field == field) ? constBegin() + i : constEnd();
+    }
+
+    bool contains(int field) const { return constFind(field) != constEnd(); }
+
+    QVariant value(int field) const
+    {
+        const_iterator it = constFind(field);
+        return it != constEnd() ? it->value : QVariant();
+    }
+
+    void insert(int field, const QVariant &value)
+    {
+        const int i = lowerBound(field);
+        if (i < m_entries.size() && m_entries.at(i).field == field) {
+            m_entries[i].value = value;
+        } else {
+            Entry entry;
+            entry.field = field;
+            entry.value = value;
+            m_entries.insert(i, entry);
+        }
+    }
+
+    bool remove(int field)
+    {
+        const int i = lowerBound(field);
+        if (i == m_entries.size() || m_entries.at(i).field != field)
+            return false;
+        m_entries.remove(i);
+        return true;
+    }
+
+private:
+    static bool fieldLessThan(const Entry &entry, int field) { return entry.field < field; }
+
+    // returns the index of the first entry whose field is not less than the given field
+    int lowerBound(int field) const
+    {
+        return std::lower_bound(constBegin(), constEnd(), field, fieldLessThan) - constBegin();
+    }
+
+    QVector<Entry> m_entries;
+};
+
 class QContactDetailPrivate : public QSharedData
 {
 public:
@@ -80,7 +151,7 @@ public:
     int m_hasValueBitfield; // subclass types must set the hasValue bit for any field value which isn't stored in m_extraData.
 
     // extra field data
-    QMap<int, QVariant> m_extraData;
+    QContactDetailFieldStore m_extraData;
 
     QContactDetailPrivate()
         : m_type(QContactDetail::TypeUndefined)
@@ -252,10 +323,10 @@ public:
         if (hasValueBitfieldBitSet(FieldProvenanceBit)) {
             retn.insert(QContactDetail::FieldProvenance, QVariant::fromValue<QString>(m_provenance));
         }
-        QMap<int, QVariant>::const_iterator it = m_extraData.constBegin(), end = m_extraData.constEnd();
+        QContactDetailFieldStore::const_iterator it = m_extraData.constBegin(), end = m_extraData.constEnd();
         for ( ; it != end; ++it) {
-            if (it.key() <= QContactDetail::FieldMaximumUserVisible) {
-                retn.insert(it.key(), it.value());
+            if (it->field <= QContactDetail::FieldMaximumUserVisible) {
+                retn.insert(it->field, it->value);
             }
         }
         return retn;
@@ -269,6 +340,21 @@ public:
         }
     }
 
+    // typed accessors, used by filtering and sorting; these read the stored value without building a values() map
+    virtual QString stringValue(int field) const {
+        if (field == QContactDetail::FieldProvenance)
+            return m_provenance;
+        return value(field).toString();
+    }
+
+    virtual int intValue(int field) const {
+        return value(field).toInt();
+    }
+
+    virtual QDateTime dateTimeValue(int field) const {
+        return value(field).toDateTime();
+    }
+
     static QContactDetailPrivate *construct(QContactDetail::DetailType detailType);
 };
 
@@ -527,6 +613,44 @@ public:
         }
         return QContactDetailPrivate::value(field);
     }
+
+    QString stringValue(int field) const
+    {
+        if (field < Subclass::FieldCount) {
+            if (!hasValueBitfieldBitSet(field + BaseFieldOffset))
+                return QString();
+            if (s_members[field].type == String)
+                return memberValue<QString>(field);
+            return toVariant(subclass(), s_members[field]).toString();
+        }
+        return QContactDetailPrivate::stringValue(field);
+    }
+
+    int intValue(int field) const
+    {
+        if (field < Subclass::FieldCount) {
+            if (!hasValueBitfieldBitSet(field + BaseFieldOffset))
+                return 0;
+            if (s_members[field].type == Int)
+                return memberValue<int>(field);
+            return toVariant(subclass(), s_members[field]).toInt();
+        }
+        return QContactDetailPrivate::intValue(field);
+    }
+
+    QDateTime dateTimeValue(int field) const
+    {
+        if (field < Subclass::FieldCount) {
+            if (!hasValueBitfieldBitSet(field + BaseFieldOffset))
+                return QDateTime();
+            if (s_members[field].type == DateTime)
+                return memberValue<QDateTime>(field);
+            if (s_members[field].type == Date)
+                return QDateTime(memberValue<QDate>(field));
+            return toVariant(subclass(), s_members[field]).toDateTime();
+        }
+        return QContactDetailPrivate::dateTimeValue(field);
+    }
 };
 
 QT_END_NAMESPACE_CONTACTS
@@ -45,11 +45,48 @@
 #ifndef QT_NO_DEBUG_STREAM
 #include <QtCore/qdebug.h>
 #endif
+#include <QtCore/qatomic.h>
+#include <QtCore/qset.h>
+#include <QtCore/qmutex.h>
 
 #include "qcontactmanager_p.h"
 
 QT_BEGIN_NAMESPACE_CONTACTS
 
+/*
+    The process-wide pool of manager URIs referred to by ids.  Each distinct URI is stored once,
+    and ids hold implicitly shared copies of it, so ids of the same manager share the same string
+    data and can be compared by that alone.  The ids keep their URI alive on their own, so an id
+    may safely outlive the pool.
+*/
+class QContactManagerUriPool
+{
+public:
+    QContactManagerUriPool() : m_last(nullptr) {}
+
+    QString intern(const QString &managerUri)
+    {
+        // nearly every id in a process refers to the same manager as the id built before it
+        const QString *last = m_last.loadAcquire();
+        if (last && *last == managerUri)
+            return *last;
+
+        QMutexLocker locker(&m_mutex);
+        QSet<QString>::const_iterator it = m_uris.constFind(managerUri);
+        if (it == m_uris.constEnd())
+            it = m_uris.insert(managerUri);
+        m_last.storeRelease(&*it);
+        return *it;
+    }
+
+private:
+    QMutex m_mutex;
+    QSet<QString> m_uris;
+    QAtomicPointer<const QString> m_last;
+};
+
+Q_GLOBAL_STATIC(QContactManagerUriPool, managerUriPool)
+
 /*!
     \class QContactId
     \brief The QContactId class provides information that uniquely identifies
@@ -150,6 +187,18 @@ QT_BEGIN_NAMESPACE_CONTACTS
     \sa managerUri()
 */
 
+/*!
+    \internal
+
+    Returns the pooled copy of \a managerUri, adding it to the pool if necessary.
+*/
+QString QContactId::internManagerUri(const QString &managerUri)
+{
+    // ids built while the pool is being destroyed still work, but no longer share their URI
+    QContactManagerUriPool *pool = managerUriPool();
+    return pool ? pool->intern(managerUri) : managerUri;
+}
+
 /*!
     Serializes the contact ID to a string. The format of the string will be:
     "qtcontacts:managerName:params:locaId", where localId is encoded binary data
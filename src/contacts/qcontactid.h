@@ -53,13 +53,13 @@ class Q_CONTACTS_EXPORT QContactId
 public:
     inline QContactId() {}
     inline QContactId(const QString &_managerUri, const QByteArray &_localId)
-        : m_managerUri(_localId.isEmpty() ? QString() : _managerUri),
+        : m_managerUri(_localId.isEmpty() || _managerUri.isEmpty() ? QString() : internManagerUri(_managerUri)),
           m_localId(m_managerUri.isEmpty() ? QByteArray() : _localId)
     {}
     // compiler-generated dtor and copy/move ctors/assignment operators are fine!
 
     inline bool operator==(const QContactId &other) const
-    { return localId() == other.localId() && managerUri() == other.managerUri(); }
+    { return m_localId == other.m_localId && compareManagerUri(other) == 0; }
     inline bool operator!=(const QContactId &other) const
     { return !operator==(other); }
 
@@ -75,12 +75,23 @@ public:
     static QContactId fromByteArray(const QByteArray &idData);
 
 private:
+    static QString internManagerUri(const QString &managerUri);
+
+    // ids of the same manager share the data of their interned manager URI
+    inline int compareManagerUri(const QContactId &other) const
+    { return m_managerUri.constData() == other.m_managerUri.constData() ? 0 : QString::compare(m_managerUri, other.m_managerUri); }
+
     QString m_managerUri;
     QByteArray m_localId;
+
+    friend bool operator<(const QContactId &id1, const QContactId &id2);
 };
 
 inline bool operator<(const QContactId &id1, const QContactId &id2)
-{ return id1.managerUri() != id2.managerUri() ? id1.managerUri() < id2.managerUri() : id1.localId() < id2.localId(); }
+{
+    const int managerComparison = id1.compareManagerUri(id2);
+    return managerComparison != 0 ? managerComparison < 0 : id1.m_localId < id2.m_localId;
+}
 
 inline uint qHash(const QContactId &id)
 { return qHash(id.localId()); }
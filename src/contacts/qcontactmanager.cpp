@@ -402,6 +402,19 @@ QList<QContactId> QContactManager::contactIds(const QContactFilter &filter, cons
     return d->m_engine->contactIds(filter, sortOrders, &h.error);
 }
 
+/*!
+  Returns the number of contacts which match the given \a filter; this is the number of ids
+  contactIds() would return for it.  The backend may count them from its indexes, without
+  retrieving the contacts or their ids.
+
+  \sa QContactCountRequest
+ */
+int QContactManager::contactCount(const QContactFilter &filter) const
+{
+    QContactManagerSyncOpErrorHolder h(this);
+    return d->m_engine->contactCount(filter, &h.error);
+}
+
 /*!
   Returns the list of contacts stored in the manager sorted according to the given list of \a sortOrders.
 
@@ -665,6 +678,48 @@ QContactId QContactManager::selfContactId() const
     return d->m_engine->selfContactId(&h.error);
 }
 
+/*!
+  Returns the current revision of the contacts stored in the manager.
+
+  The revision increases every time contacts are added, changed or removed, and never
+  decreases; a client which records it may later ask for the changes made since then
+  with changesSince().  If the backend does not keep revisions, zero is returned and
+  the error will be set to \c QContactManager::NotSupportedError.
+
+  \sa changesSince()
+ */
+quint64 QContactManager::revision() const
+{
+    QContactManagerSyncOpErrorHolder h(this);
+    return d->m_engine->revision(&h.error);
+}
+
+/*!
+  Returns the contacts added, changed and removed since the given \a revision, as
+  previously returned by revision().  The types of the details changed in each changed
+  contact are reported as they are by the contactsChanged() signal; a contact added (or
+  removed) since the revision is reported as added (or removed) only.
+
+  If \a currentRevision is not null, it is set to the revision which the returned changes
+  bring the client up to, which may be passed to a later call.
+
+  If the backend no longer remembers the changes made since \a revision, an empty change
+  set is returned and the error will be set to \c QContactManager::LimitReachedError; the
+  client must then fetch the contacts again.  If the backend does not keep revisions, the
+  error will be set to \c QContactManager::NotSupportedError.
+
+  \sa revision(), QContactChangesFetchRequest
+ */
+QContactChangeSet QContactManager::changesSince(quint64 revision, quint64 *currentRevision) const
+{
+    QContactManagerSyncOpErrorHolder h(this);
+    quint64 current = 0;
+    const QContactChangeSet changes = d->m_engine->changesSince(revision, &current, &h.error);
+    if (currentRevision)
+        *currentRevision = current;
+    return changes;
+}
+
 /*!
   Returns a list of relationships in which the contact identified by \a participantId participates in the given \a role.
   If \a participantId is default-constructed, \a role is ignored and all relationships are returned.
@@ -45,6 +45,7 @@
 #include <QtCore/qstringlist.h>
 
 #include <QtContacts/qcontact.h>
+#include <QtContacts/qcontactchangeset.h>
 #include <QtContacts/qcontactcollection.h>
 #include <QtContacts/qcontactid.h>
 #include <QtContacts/qcontactfetchhint.h>
@@ -122,6 +123,7 @@ public:
     /* Contacts - Accessors and Mutators */
     QList<QContactId> contactIds(const QList<QContactSortOrder>& sortOrders = QList<QContactSortOrder>()) const;
     QList<QContactId> contactIds(const QContactFilter& filter, const QList<QContactSortOrder>& sortOrders = QList<QContactSortOrder>()) const;
+    int contactCount(const QContactFilter& filter = QContactFilter()) const;
 
     QList<QContact> contacts(const QList<QContactSortOrder>& sortOrders = QList<QContactSortOrder>(), const QContactFetchHint& fetchHint = QContactFetchHint()) const;
     QList<QContact> contacts(const QContactFilter& filter, const QList<QContactSortOrder>& sortOrders = QList<QContactSortOrder>(), const QContactFetchHint& fetchHint = QContactFetchHint()) const;
@@ -140,6 +142,10 @@ public:
     bool setSelfContactId(const QContactId& contactId);
     QContactId selfContactId() const;
 
+    /* Revisions, for synchronization */
+    quint64 revision() const;
+    QContactChangeSet changesSince(quint64 revision, quint64 *currentRevision = nullptr) const;
+
     /* Relationships */
     QList<QContactRelationship> relationships(const QContactId& participantId, QContactRelationship::Role role = QContactRelationship::Either) const;
     QList<QContactRelationship> relationships(const QString& relationshipType = QString(), const QContactId& participantId = QContactId(), QContactRelationship::Role role = QContactRelationship::Either) const;
@@ -39,13 +39,18 @@
 
 #include "qcontactmanagerengine.h"
 
+#include <QtCore/qcollator.h>
 #include <QtCore/qmutex.h>
 #include <QtCore/qpointer.h>
 #include <QtCore/qset.h>
+#include <QtCore/qthreadstorage.h>
+#include <QtCore/qvector.h>
 
 #include "qcontact_p.h"
+#include "qcontactcompiledfilter_p.h"
 #include "qcontactdetail_p.h"
 #include "qcontactdetails.h"
+#include "qcontactfilter_p.h"
 #include "qcontactfilters.h"
 #include "qcontactabstractrequest_p.h"
 #include "qcontactaction.h"
@@ -56,8 +61,6 @@
 
 QT_BEGIN_NAMESPACE_CONTACTS
 
-static bool validateActionFilter(const QContactFilter& filter);
-
 /*!
   \class QContactManagerEngine
   \brief The QContactManagerEngine class provides the interface for
@@ -253,6 +256,18 @@ QList<QContactId> QContactManagerEngine::contactIds(const QContactFilter& filter
     return QList<QContactId>();
 }
 
+/*!
+  Returns the number of contacts which match the given \a filter, which must be the number of ids
+  contactIds() would return for it.  Any error which occurs will be saved in \a error.
+
+  The default implementation counts the ids returned by contactIds(); engines which can count
+  the matching contacts without listing them should reimplement this function.
+ */
+int QContactManagerEngine::contactCount(const QContactFilter &filter, QContactManager::Error *error) const
+{
+    return contactIds(filter, QList<QContactSortOrder>(), error).count();
+}
+
 /*!
   Returns the list of contacts which match the given \a filter stored in the manager sorted according to the given list of \a sortOrders.
 
@@ -334,6 +349,39 @@ QContactId QContactManagerEngine::selfContactId(QContactManager::Error* error) c
     return QContactId();
 }
 
+/*!
+  Returns the current revision of the contacts stored in the engine, which must increase
+  every time contacts are added, changed or removed.
+
+  Any errors encountered should be stored to \a error.  The default implementation
+  sets \a error to \c QContactManager::NotSupportedError and returns zero.
+
+  \sa QContactManager::revision()
+ */
+quint64 QContactManagerEngine::revision(QContactManager::Error *error) const
+{
+    *error = QContactManager::NotSupportedError;
+    return 0;
+}
+
+/*!
+  Returns the contacts added, changed and removed since the given \a revision, and sets
+  \a currentRevision to the revision which those changes bring the caller up to.
+
+  If the engine no longer knows the changes made since \a revision, \a error should be
+  set to \c QContactManager::LimitReachedError.  The default implementation sets \a error
+  to \c QContactManager::NotSupportedError and returns an empty change set.
+
+  \sa QContactManager::changesSince()
+ */
+QContactChangeSet QContactManagerEngine::changesSince(quint64 revision, quint64 *currentRevision, QContactManager::Error *error) const
+{
+    Q_UNUSED(revision);
+    *currentRevision = 0;
+    *error = QContactManager::NotSupportedError;
+    return QContactChangeSet();
+}
+
 /*!
   Returns a list of relationships of the given \a relationshipType in which the contact identified by \a participantId participates in the given \a role.
   If \a participantId is default-constructed, \a role is ignored and all relationships of the given \a relationshipType are returned.
@@ -521,6 +569,22 @@ bool QContactManagerEngine::removeCollection(const QContactCollectionId& collect
     return false;
 }
 
+/* Returns the given terms of an intersection or union, cheapest first */
+static QList<QContactFilter> orderedByCost(const QList<QContactFilter> &filters)
+{
+    QVector<QPair<int, int> > costs; // estimated cost and position of each term
+    costs.reserve(filters.count());
+    for (int i = 0; i < filters.count(); i++)
+        costs.append(qMakePair(QContactCompiledFilterPrivate::estimatedCost(filters.at(i)), i));
+    std::sort(costs.begin(), costs.end());
+
+    QList<QContactFilter> ordered;
+    ordered.reserve(filters.count());
+    for (int i = 0; i < costs.count(); i++)
+        ordered.append(filters.at(costs.at(i).second));
+    return ordered;
+}
+
 /*!
   Given an input \a filter, returns the canonical version of the filter.
 
@@ -540,6 +604,10 @@ bool QContactManagerEngine::removeCollection(const QContactCollectionId& collect
    \li An intersection or union filter with a single entry will be replaced by that entry
    \li A QContactDetailFilter or QContactDetailRangeFilter with no detail type will be replaced with a QContactInvalidFilter
    \li A QContactDetailRangeFilter with no range specified will be converted to a QContactDetailFilter
+   \li The terms of intersection and union filters will be ordered so that the cheapest
+     tests (such as id, collection and presence tests) come before the most expensive ones
+     (such as phone number, keypad and locale aware comparisons); terms of equal cost keep
+     their order
   \endlist
 */
 QContactFilter QContactManagerEngine::canonicalizedFilter(const QContactFilter &filter)
@@ -548,19 +616,10 @@ QContactFilter QContactManagerEngine::canonicalizedFilter(const QContactFilter &
         case QContactFilter::ActionFilter:
         {
             // Find any matching actions, and do a union filter on their filter objects
+            // (action filters are not allowed to return action filters, at all, so those which
+            // do are left out)
             QContactActionFilter af(filter);
-            QList<QContactActionDescriptor> descriptors = QContactActionManager::instance()->actionDescriptors(af.actionName());
-
-            QList<QContactFilter> filters;
-            for (int j = 0; j < descriptors.count(); j++) {
-                // Action filters are not allowed to return action filters, at all
-                // it's too annoying to check for recursion
-                QContactFilter d = descriptors.at(j).contactFilter();
-                if (!validateActionFilter(d))
-                    continue;
-
-                filters.append(d);
-            }
+            QList<QContactFilter> filters = QContactActionManager::instance()->actionFilters(af.actionName());
 
             if (filters.count() == 0)
                 return QContactInvalidFilter();
@@ -597,7 +656,7 @@ QContactFilter QContactManagerEngine::canonicalizedFilter(const QContactFilter &
             if (filters.count() == 1)
                 return filters.first();
 
-            f.setFilters(filters);
+            f.setFilters(orderedByCost(filters));
             return f;
         }
         // unreachable
@@ -626,7 +685,7 @@ QContactFilter QContactManagerEngine::canonicalizedFilter(const QContactFilter &
             if (filters.count() == 1)
                 return filters.first();
 
-            f.setFilters(filters);
+            f.setFilters(orderedByCost(filters));
             return f;
         }
         // unreachable
@@ -1239,436 +1298,46 @@ int QContactManagerEngine::compareVariant(const QVariant& first, const QVariant&
     }
 }
 
-/*!
-  Returns true if the supplied contact \a contact matches the supplied filter \a filter.
-
-  This function will test each condition in the filter, possibly recursing.
+/*
+ * The filter last compiled by testFilter() on each thread.  Callers which test one filter against
+ * many contacts through testFilter() then compile it only once.  The cached compiled filter holds
+ * a copy of the filter, so a filter sharing its data has not been changed since; it is compiled
+ * again if the actions, which action filters are resolved to, have changed.
  */
-bool QContactManagerEngine::testFilter(const QContactFilter &filter, const QContact &contact)
+struct QContactTestFilterCache
 {
-    switch(filter.type()) {
-        case QContactFilter::InvalidFilter:
-            return false;
-
-        case QContactFilter::DefaultFilter:
-            return true;
-
-        case QContactFilter::IdFilter:
-            {
-                const QContactIdFilter idf(filter);
-                if (idf.ids().contains(contact.id()))
-                    return true;
-            }
-            // Fall through to end
-            break;
-
-        case QContactFilter::ContactDetailFilter:
-            {
-                const QContactDetailFilter cdf(filter);
-                if (cdf.detailType() == QContactDetail::TypeUndefined)
-                    return false;
-
-                /* See if this contact has one of these details in it */
-                const QList<QContactDetail>& details = contact.details(cdf.detailType());
-
-                if (details.count() == 0)
-                    return false; /* can't match */
-
-                /* See if we need to check the values */
-                if (cdf.detailField() == -1)
-                    return true;  /* just testing for the presence of a detail of the specified type */
-
-                /* Now figure out what tests we are doing */
-                const bool valueTest = cdf.value().isValid();
-                const bool presenceTest = !valueTest;
-
-                /* See if we need to test any values at all */
-                if (presenceTest) {
-                    for(int j=0; j < details.count(); j++) {
-                        const QContactDetail& detail = details.at(j);
-
-                        /* Check that the field is present and has a non-empty value */
-                        if (detail.values().contains(cdf.detailField()) && !detail.value(cdf.detailField()).isNull())
-                            return true;
-                    }
-                    return false;
-                }
-
-                /* Case sensitivity, for those parts that use it */
-                Qt::CaseSensitivity cs = (cdf.matchFlags() & QContactFilter::MatchCaseSensitive) ? Qt::CaseSensitive : Qt::CaseInsensitive;
-
-                /* See what flags are requested, since we're looking at a value */
-                if (cdf.matchFlags() & QContactFilter::MatchPhoneNumber) {
-                    /* Doing phone number filtering.  We hand roll an implementation here, backends will obviously want to override this. */
-                    QString input = cdf.value().toString();
-
-                    /* preprocess the input - ignore any non-digits (doesn't perform ITU-T collation */
-                    QString preprocessedInput;
-                    for (int i = 0; i < input.size(); i++) {
-                        QChar current = input.at(i).toLower();
-                        // XXX NOTE: we ignore characters like '+', 'p', 'w', '*' and '#' which may be important.
-                        if (current.isDigit()) {
-                            preprocessedInput.append(current);
-                        }
-                    }
-
-                    /* Look at every detail in the set of details and compare */
-                    for (int j = 0; j < details.count(); j++) {
-                        const QContactDetail& detail = details.at(j);
-                        const QString& valueString = detail.value(cdf.detailField()).toString();
-                        QString preprocessedValueString;
-                        for (int i = 0; i < valueString.size(); i++) {
-                            QChar current = valueString.at(i).toLower();
-                            // note: we ignore characters like '+', 'p', 'w', '*' and '#' which may be important.
-                            if (current.isDigit()) {
-                                preprocessedValueString.append(current);
-                            }
-                        }
-
-                        // if the matchflags input don't require a particular criteria to pass, we assume that it has passed.
-                        // the "default" match strategy is an "endsWith" strategy.
-                        bool me = (cdf.matchFlags() & 7) == QContactFilter::MatchExactly;
-                        bool mc = (cdf.matchFlags() & 7) == QContactFilter::MatchContains;
-                        bool msw = (cdf.matchFlags() & 7) == QContactFilter::MatchStartsWith;
-                        bool mew = (cdf.matchFlags() & 7) == QContactFilter::MatchEndsWith;
-
-                        bool mer = (me ? preprocessedValueString == preprocessedInput : true);
-                        bool mcr = (mc ? preprocessedValueString.contains(preprocessedInput) : true);
-                        bool mswr = (msw ? preprocessedValueString.startsWith(preprocessedInput) : true);
-                        bool mewr = (mew ? preprocessedValueString.endsWith(preprocessedInput) : true);
-                        if (mewr && mswr && mcr && mer) {
-                            return true; // this detail meets all of the criteria which were required, and hence must match.
-                        }
-
-                        // fallback case: default MatchPhoneNumber compares the rightmost 7 digits, ignoring other matchflags.
-                        if (preprocessedValueString.right(7) == preprocessedInput.right(7)) {
-                            return true;
-                        }
-                    }
-                } else if (cdf.matchFlags() & QContactFilter::MatchKeypadCollation) {
-                    // XXX TODO: not sure about the filtering semantics for MatchKeypadCollation.
-                    QString input = cdf.value().toString();
-
-                    /* Look at every detail in the set of details and compare */
-                    for (int j = 0; j < details.count(); j++) {
-                        const QContactDetail& detail = details.at(j);
-                        const QString& valueString = detail.value(cdf.detailField()).toString().toLower();
-
-                        // preprocess the valueString
-                        QString preprocessedValue;
-                        for (int i = 0; i < valueString.size(); i++) {
-                            // we use ITU-T keypad collation by default.
-                            QChar currentValueChar = valueString.at(i);
-                            if (currentValueChar == QLatin1Char('a') || currentValueChar == QLatin1Char('b') || currentValueChar == QLatin1Char('c'))
-                                preprocessedValue.append(QLatin1Char('2'));
-                            else if (currentValueChar == QLatin1Char('d') || currentValueChar == QLatin1Char('e') || currentValueChar == QLatin1Char('f'))
-                                preprocessedValue.append(QLatin1Char('3'));
-                            else if (currentValueChar == QLatin1Char('g') || currentValueChar == QLatin1Char('h') || currentValueChar == QLatin1Char('i'))
-                                preprocessedValue.append(QLatin1Char('4'));
-                            else if (currentValueChar == QLatin1Char('j') || currentValueChar == QLatin1Char('k') || currentValueChar == QLatin1Char('l'))
-                                preprocessedValue.append(QLatin1Char('5'));
-                            else if (currentValueChar == QLatin1Char('m') || currentValueChar == QLatin1Char('n') || currentValueChar == QLatin1Char('o'))
-                                preprocessedValue.append(QLatin1Char('6'));
-                            else if (currentValueChar == QLatin1Char('p') || currentValueChar == QLatin1Char('q') || currentValueChar == QLatin1Char('r') || currentValueChar == QLatin1Char('s'))
-                                preprocessedValue.append(QLatin1Char('7'));
-                            else if (currentValueChar == QLatin1Char('t') || currentValueChar == QLatin1Char('u') || currentValueChar == QLatin1Char('v'))
-                                preprocessedValue.append(QLatin1Char('8'));
-                            else if (currentValueChar == QLatin1Char('w') || currentValueChar == QLatin1Char('x') || currentValueChar == QLatin1Char('y') || currentValueChar == QLatin1Char('z'))
-                                preprocessedValue.append(QLatin1Char('9'));
-                            else
-                                preprocessedValue.append(currentValueChar);
-                        }
-
-                        bool me = (cdf.matchFlags() & 7) == QContactFilter::MatchExactly;
-                        bool mc = (cdf.matchFlags() & 7) == QContactFilter::MatchContains;
-                        bool msw = (cdf.matchFlags() & 7) == QContactFilter::MatchStartsWith;
-                        bool mew = (cdf.matchFlags() & 7) == QContactFilter::MatchEndsWith;
-
-                        bool mer = (me ? preprocessedValue == input : true);
-                        bool mcr = (mc ? preprocessedValue.contains(input) : true);
-                        bool mswr = (msw ? preprocessedValue.startsWith(input) : true);
-                        bool mewr = (mew ? preprocessedValue.endsWith(input) : true);
-                        if (mewr && mswr && mcr && mer) {
-                            return true; // this detail meets all of the criteria which were required, and hence must match.
-                        }
-                    }
-                } else if (cdf.matchFlags() & (QContactFilter::MatchEndsWith | QContactFilter::MatchStartsWith | QContactFilter::MatchContains | QContactFilter::MatchFixedString)) {
-                    /* We're strictly doing string comparisons here */
-                    bool matchStarts = (cdf.matchFlags() & 7) == QContactFilter::MatchStartsWith;
-                    bool matchEnds = (cdf.matchFlags() & 7) == QContactFilter::MatchEndsWith;
-                    bool matchContains = (cdf.matchFlags() & 7) == QContactFilter::MatchContains;
-
-                    /* Value equality test */
-                    for(int j=0; j < details.count(); j++) {
-                        const QContactDetail& detail = details.at(j);
-                        const QString& var = detail.value(cdf.detailField()).toString();
-                        const QString& needle = cdf.value().toString();
-                        if (matchStarts && var.startsWith(needle, cs))
-                            return true;
-                        if (matchEnds && var.endsWith(needle, cs))
-                            return true;
-                        if (matchContains && var.contains(needle, cs))
-                            return true;
-                        if (compareStrings(var, needle, cs) == 0)
-                            return true;
-                    }
-                    return false;
-                } else {
-                    /* Nope, testing the values as a variant */
-                    /* Value equality test */
-                    for(int j = 0; j < details.count(); j++) {
-                        const QContactDetail& detail = details.at(j);
-                        const QVariant& var = detail.value(cdf.detailField());
-                        if (!var.isNull() && compareVariant(var, cdf.value(), cs) == 0)
-                            return true;
-                    }
-                }
-            }
-            break;
+    QContactTestFilterCache() : m_generation(-1) {}
 
-        case QContactFilter::ContactDetailRangeFilter:
-            {
-                /* The only supported flags are: MatchExactly, MatchFixedString, MatchCaseSensitive */
-
-                const QContactDetailRangeFilter cdf(filter);
-                if (cdf.detailType() == QContactDetail::TypeUndefined)
-                    return false; /* we do not know which field to check */
-
-                /* See if this contact has one of these details in it */
-                const QList<QContactDetail>& details = contact.details(cdf.detailType());
-
-                if (details.count() == 0)
-                    return false; /* can't match */
-
-                /* Check for a detail presence test */
-                if (cdf.detailField() == -1)
-                    return true;
-
-                /* See if this is a field presence test */
-                if (!cdf.minValue().isValid() && !cdf.maxValue().isValid()) {
-                    for(int j=0; j < details.count(); j++) {
-                        const QContactDetail& detail = details.at(j);
-                        if (detail.values().contains(cdf.detailField()))
-                            return true;
-                    }
-                    return false;
-                }
-
-                /* open or closed interval testing support */
-                const int minComp = cdf.rangeFlags() & QContactDetailRangeFilter::ExcludeLower ? 1 : 0;
-                const int maxComp = cdf.rangeFlags() & QContactDetailRangeFilter::IncludeUpper ? 1 : 0;
-
-                /* Case sensitivity, for those parts that use it */
-                Qt::CaseSensitivity cs = (cdf.matchFlags() & QContactFilter::MatchCaseSensitive) ? Qt::CaseSensitive : Qt::CaseInsensitive;
-
-                /* See what flags are requested, since we're looking at a value */
-                if (cdf.matchFlags() & QContactFilter::MatchFixedString) {
-                    /* We're strictly doing string comparisons here */
-                    QString minVal = cdf.minValue().toString();
-                    QString maxVal = cdf.maxValue().toString();
-
-                    const bool testMin = !minVal.isEmpty();
-                    const bool testMax = !maxVal.isEmpty();
-
-                    for(int j=0; j < details.count(); j++) {
-                        const QContactDetail& detail = details.at(j);
-
-                        // The detail has to have a field of this type in order to be compared.
-                        if (!detail.value(cdf.detailField()).isValid())
-                            continue;
-                        const QString& var = detail.value(cdf.detailField()).toString();
-                        if (testMin && compareStrings(var, minVal, cs) < minComp)
-                            continue;
-                        if (testMax && compareStrings(var, maxVal, cs) >= maxComp)
-                            continue;
-                        return true;
-                    }
-                    // Fall through to end
-                } else {
-                    const bool testMin = cdf.minValue().isValid();
-                    const bool testMax = cdf.maxValue().isValid();
-
-                    /* Nope, testing the values as a variant */
-                    for(int j=0; j < details.count(); j++) {
-                        const QContactDetail& detail = details.at(j);
-                        const QVariant& var = detail.value(cdf.detailField());
-
-                        // The detail has to have a field of this type in order to be compared.
-                        if (!var.isValid())
-                            continue;
-
-                        if (testMin && compareVariant(var, cdf.minValue(), cs) < minComp)
-                            continue;
-                        if (testMax && compareVariant(var, cdf.maxValue(), cs) >= maxComp)
-                            continue;
-                        return true;
-                    }
-                    // Fall through to end
-                }
-            }
-            break;
-
-        case QContactFilter::RelationshipFilter:
-            {
-                // matches any contact that plays the specified role in a relationship
-                // of the specified type with the specified other participant.
-                const QContactRelationshipFilter rf(filter);
-
-                // first, retrieve contact IDs
-                QContactId relatedId = rf.relatedContactId();
-
-                QContactId contactId = contact.id();
-                if (relatedId == contactId) {
-                    return false;
-                }
-
-                // get the relationships in which this contact is involved.
-                QList<QContactRelationship> allRelationships;
-                allRelationships = contact.relationships();
-
-                // now check to see if we have a match.
-                foreach (const QContactRelationship& rel, allRelationships) {
-                    // perform the matching.
-                    if (rf.relatedContactRole() == QContactRelationship::Second) { // this is the role of the related contact; ie, to match, contact must be the first in the relationship.
-                        if ((rf.relationshipType().isEmpty() || rel.relationshipType() == rf.relationshipType())
-                                && (rel.first() == contactId) && (relatedId.isNull() || relatedId == rel.second())) {
-                            return true;
-                        }
-                    } else if (rf.relatedContactRole() == QContactRelationship::First) { // this is the role of the related contact; ie, to match, contact must be the second in the relationship.
-                        if ((rf.relationshipType().isEmpty() || rel.relationshipType() == rf.relationshipType())
-                                && (rel.second() == contactId) && (relatedId.isNull() || relatedId == rel.first())) {
-                            return true;
-                        }
-                    } else { // QContactRelationship::Either
-                        if ((rf.relationshipType().isEmpty() || rel.relationshipType() == rf.relationshipType())
-                                && (relatedId.isNull() || (relatedId == rel.first() || relatedId == rel.second()))) {
-                            return true;
-                        }
-                    }
-                }
-
-                // if not found by now, it doesn't match the filter.
-                return false;
-            }
-            //break; // unreachable.
-
-        case QContactFilter::ChangeLogFilter:
-            {
-                QContactChangeLogFilter ccf(filter);
-
-                // See what we can do...
-                QContactTimestamp ts = contact.detail(QContactTimestamp::Type);
-
-                // See if timestamps are even supported
-                if (ts.isEmpty())
-                    break;
-
-                if (ccf.eventType() == QContactChangeLogFilter::EventAdded)
-                    return ccf.since() <= ts.created();
-                if (ccf.eventType() == QContactChangeLogFilter::EventChanged)
-                    return ccf.since() <= ts.lastModified();
-
-                // You can't emulate a removed..
-                // Fall through to end
-            }
-            break;
-
-        case QContactFilter::ActionFilter:
-            {
-                // Find any matching actions, and do a union filter on their filter objects
-                QContactActionFilter af(filter);
-                QList<QContactActionDescriptor> descriptors = QContactActionManager::instance()->actionDescriptors(af.actionName());
-
-                // There's a small wrinkle if there's a value specified in the action filter
-                // we have to adjust any contained QContactDetailFilters to have that value
-                // or test if a QContactDetailRangeFilter contains this value already
-                for (int j = 0; j < descriptors.count(); j++) {
-                    // Action filters are not allowed to return action filters, at all
-                    // it's too annoying to check for recursion
-                    QContactFilter d = descriptors.at(j).contactFilter();
-                    if (!validateActionFilter(d))
-                        return false;
-
-                    // Check for values etc...
-                    if (testFilter(d, contact))
-                        return true;
-                }
-                // Fall through to end
-            }
-            break;
-
-        case QContactFilter::IntersectionFilter:
-            {
-                /* XXX In theory we could reorder the terms to put the native tests first */
-                const QContactIntersectionFilter bf(filter);
-                const QList<QContactFilter>& terms = bf.filters();
-                if (terms.count() > 0) {
-                    for(int j = 0; j < terms.count(); j++) {
-                        if (!testFilter(terms.at(j), contact)) {
-                            return false;
-                        }
-                    }
-                    return true;
-                }
-                // Fall through to end
-            }
-            break;
-
-        case QContactFilter::UnionFilter:
-            {
-                /* XXX In theory we could reorder the terms to put the native tests first */
-                const QContactUnionFilter bf(filter);
-                const QList<QContactFilter>& terms = bf.filters();
-                if (terms.count() > 0) {
-                    for(int j = 0; j < terms.count(); j++) {
-                        if (testFilter(terms.at(j), contact)) {
-                            return true;
-                        }
-                    }
-                    return false;
-                }
-                // Fall through to end
-            }
-            break;
+    QContactCompiledFilter m_compiled;
+    int m_generation; // the action manager generation the filter was compiled in
+};
 
-        case QContactFilter::CollectionFilter:
-            {
-                const QContactCollectionFilter cf(filter);
-                const QSet<QContactCollectionId>& ids = cf.collectionIds();
-                if (ids.contains(contact.collectionId()))
-                    return true;
-                return false;
-            }
-    }
-    return false;
-}
+Q_GLOBAL_STATIC(QThreadStorage<QContactTestFilterCache>, testFilterCache)
 
 /*!
-  Given a QContactFilter \a filter retrieved from a QContactAction,
-  check that it is valid and cannot cause infinite recursion.
+  Returns true if the supplied contact \a contact matches the supplied filter \a filter.
 
-  In particular, a filter from a QContactAction cannot contain
-  any instances of a QContactActionFilter.
+  This function will test each condition in the filter, possibly recursing.
 
-  Returns true if \a filter seems ok, or false otherwise.
+  The filter is compiled into a QContactCompiledFilter, which is kept until a different filter
+  is tested on the same thread; engines which test several filters against many contacts in turn
+  should construct a QContactCompiledFilter for each and use QContactCompiledFilter::matches()
+  instead.
  */
-
-bool validateActionFilter(const QContactFilter& filter)
+bool QContactManagerEngine::testFilter(const QContactFilter &filter, const QContact &contact)
 {
-    QList<QContactFilter> toVerify;
-    toVerify << filter;
-
-    while(toVerify.count() > 0) {
-        QContactFilter f = toVerify.takeFirst();
-        if (f.type() == QContactFilter::ActionFilter)
-            return false;
-        if (f.type() == QContactFilter::IntersectionFilter)
-            toVerify.append(QContactIntersectionFilter(f).filters());
-        if (f.type() == QContactFilter::UnionFilter)
-            toVerify.append(QContactUnionFilter(f).filters());
+    QThreadStorage<QContactTestFilterCache> *storage = testFilterCache();
+    if (!storage)
+        return QContactCompiledFilter(filter).matches(contact); // during application exit
+
+    QContactTestFilterCache &cache = storage->localData();
+    const int generation = QContactActionManager::instance()->generation();
+    if (cache.m_generation != generation
+            || QContactFilterPrivate::extract_d(cache.m_compiled.filter()).constData() != QContactFilterPrivate::extract_d(filter).constData()) {
+        cache.m_compiled = QContactCompiledFilter(filter);
+        cache.m_generation = generation;
     }
-
-    return true;
+    return cache.m_compiled.matches(contact);
 }
 
 /*!
@@ -1693,15 +1362,15 @@ int QContactManagerEngine::compareContact(const QContact& a, const QContact& b,
         const QContactDetail::DetailType detailType = sortOrder.detailType();
         const int detailField = sortOrder.detailField();
 
-        const QList<QContactDetail> aDetails = a.details(detailType);
-        const QList<QContactDetail> bDetails = b.details(detailType);
+        const QContactDetailTypeView aDetails = QContactData::get(a)->detailsOfType(detailType);
+        const QContactDetailTypeView bDetails = QContactData::get(b)->detailsOfType(detailType);
         if (aDetails.isEmpty() && bDetails.isEmpty())
             continue; // use next sort criteria.
 
         // See if we need to check the values
         if (detailField == -1) {
             // just testing for the presence of a detail of the specified definition
-            if (aDetails.size() == bDetails.size())
+            if (aDetails.count() == bDetails.count())
                 continue; // use next sort criteria.
             if (aDetails.isEmpty())
                 return sortOrder.blankPolicy() == QContactSortOrder::BlanksFirst ? -1 : 1;
@@ -1756,6 +1425,129 @@ class ContactLessThan {
         const QList<QContactSortOrder>* mSortOrders;
 };
 
+/* The value of one sort order for one contact, extracted once per sort so that comparisons
+ * do not need to look up details, build variants or collate strings. */
+struct ContactSortField
+{
+    ContactSortField() : detailCount(0), collationKey(-1) {}
+
+    QVariant value;     // invalid if the field is blank or missing
+    int detailCount;    // number of details of the sort order's type
+    int collationKey;   // index of the collation key of a string value, or -1
+};
+
+/* The sort keys of a list of contacts: one field per contact and sort order, stored contiguously.
+ * String values are collated once into QCollatorSortKeys, which compare like compareStrings(). */
+class ContactSortKeys
+{
+public:
+    ContactSortKeys(const QList<QContact> &contacts, const QList<QContactSortOrder> &sortOrders)
+    {
+        foreach (const QContactSortOrder &sortOrder, sortOrders) {
+            if (!sortOrder.isValid())
+                break;
+            m_sortOrders.append(sortOrder);
+        }
+
+        const int orderCount = m_sortOrders.size();
+        m_fields.resize(contacts.size() * orderCount);
+        if (orderCount == 0)
+            return;
+
+        QCollator collator;
+        collator.setCaseSensitivity(Qt::CaseSensitive);
+        for (int i = 0; i < contacts.size(); ++i) {
+            const QContact &contact = contacts.at(i);
+            for (int j = 0; j < orderCount; ++j) {
+                const QContactSortOrder &sortOrder = m_sortOrders.at(j);
+                const QContactDetailTypeView details = QContactData::get(contact)->detailsOfType(sortOrder.detailType());
+                ContactSortField &field = m_fields[i * orderCount + j];
+                field.detailCount = details.count();
+                if (details.isEmpty() || sortOrder.detailField() == -1)
+                    continue;
+
+                // treat empty strings as blank, like compareContact() does.
+                const QVariant value = details.first().value(sortOrder.detailField());
+                if (value.isNull() || (value.type() == QVariant::String && value.toString().isEmpty()))
+                    continue;
+
+                field.value = value;
+                if (value.type() == QVariant::String || value.type() == QVariant::Char) {
+                    const QString string = value.toString();
+                    m_collationKeys.append(collator.sortKey(sortOrder.caseSensitivity() == Qt::CaseSensitive ? string : string.toCaseFolded()));
+                    field.collationKey = m_collationKeys.size() - 1;
+                }
+            }
+        }
+    }
+
+    /* Compares the contacts at positions a and b; the result matches compareContact() */
+    int compare(int a, int b) const
+    {
+        const int orderCount = m_sortOrders.size();
+        for (int j = 0; j < orderCount; ++j) {
+            const QContactSortOrder &sortOrder = m_sortOrders.at(j);
+            const ContactSortField &aField = m_fields.at(a * orderCount + j);
+            const ContactSortField &bField = m_fields.at(b * orderCount + j);
+            if (aField.detailCount == 0 && bField.detailCount == 0)
+                continue;
+
+            if (sortOrder.detailField() == -1) {
+                if (aField.detailCount == bField.detailCount)
+                    continue;
+                if (aField.detailCount == 0)
+                    return sortOrder.blankPolicy() == QContactSortOrder::BlanksFirst ? -1 : 1;
+                if (bField.detailCount == 0)
+                    return sortOrder.blankPolicy() == QContactSortOrder::BlanksFirst ? 1 : -1;
+                return 0;
+            }
+
+            const bool aIsNull = !aField.value.isValid();
+            const bool bIsNull = !bField.value.isValid();
+            if (aIsNull && bIsNull)
+                continue;
+            if (aIsNull)
+                return (sortOrder.blankPolicy() == QContactSortOrder::BlanksFirst ? -1 : 1);
+            if (bIsNull)
+                return (sortOrder.blankPolicy() == QContactSortOrder::BlanksFirst ? 1 : -1);
+
+            int comparison;
+            if (aField.collationKey >= 0 && bField.collationKey >= 0)
+                comparison = m_collationKeys.at(aField.collationKey).compare(m_collationKeys.at(bField.collationKey));
+            else
+                comparison = QContactManagerEngine::compareVariant(aField.value, bField.value, sortOrder.caseSensitivity());
+            if (sortOrder.direction() != Qt::AscendingOrder)
+                comparison = -comparison;
+            if (comparison == 0)
+                continue;
+            return comparison;
+        }
+
+        return 0;
+    }
+
+private:
+    QList<QContactSortOrder> m_sortOrders;
+    QVector<ContactSortField> m_fields;
+    QVector<QCollatorSortKey> m_collationKeys;
+};
+
+/* A functor that orders positions in a list of contacts by their sort keys.  Contacts which are
+ * equal according to every sort order are ordered by position, so that unstable algorithms
+ * (such as std::partial_sort) preserve the original relative order.
+ * The keys pointer passed in must remain valid for the lifetime of the functor. */
+class ContactPositionLessThan {
+    public:
+        ContactPositionLessThan(const ContactSortKeys* keys) : mKeys(keys) {}
+        bool operator()(int a, int b) const
+        {
+            const int comparison = mKeys->compare(a, b);
+            return comparison != 0 ? comparison < 0 : a < b;
+        }
+    private:
+        const ContactSortKeys* mKeys;
+};
+
 /*!
   Performs insertion sort of the contact \a toAdd into the \a sorted list, according to the provided \a sortOrders list.
   The first QContactSortOrder in the list has the highest priority: if the contact \a toAdd is deemed equal to another
@@ -1782,10 +1574,7 @@ QList<QContactId> QContactManagerEngine::sortContacts(const QList<QContact>& cs,
 {
     QList<QContactId> sortedIds;
     QList<QContact> sortedContacts = cs;
-    if (!sortOrders.isEmpty()) {
-        ContactLessThan lessThan(&sortOrders);
-        std::stable_sort(sortedContacts.begin(), sortedContacts.end(), lessThan);
-    }
+    sortContacts(&sortedContacts, sortOrders);
 
     foreach(const QContact& c, sortedContacts) {
         sortedIds.append(c.id());
@@ -1793,6 +1582,51 @@ QList<QContactId> QContactManagerEngine::sortContacts(const QList<QContact>& cs,
     return sortedIds;
 }
 
+/*!
+  Sorts the given list of \a contacts in place according to the provided \a sortOrders.
+  Contacts which are equal according to every sort order keep their relative order.
+
+  The values the sort orders refer to are extracted from each contact only once, and
+  string values are collated once into sort keys, so the cost of each comparison made
+  while sorting does not depend on the contacts' details.
+
+  If \a maxCount is non-negative, only the first \a maxCount contacts of the sorted result
+  are kept in the list.  In that case only those contacts are fully ordered, which is
+  considerably cheaper than sorting the whole list when \a maxCount is small.
+
+  Engines which collect all of the contacts matching a fetch before ordering them should
+  use this function rather than inserting each contact with addSorted().
+ */
+void QContactManagerEngine::sortContacts(QList<QContact>* contacts, const QList<QContactSortOrder>& sortOrders, int maxCount)
+{
+    const int count = contacts->size();
+    if (maxCount < 0 || maxCount > count)
+        maxCount = count;
+
+    if (sortOrders.isEmpty() || !sortOrders.first().isValid() || count < 2) {
+        if (maxCount < count)
+            *contacts = contacts->mid(0, maxCount);
+        return;
+    }
+
+    const ContactSortKeys keys(*contacts, sortOrders);
+    QVector<int> positions(count);
+    for (int i = 0; i < count; ++i)
+        positions[i] = i;
+
+    // positions are a total order (ties are broken by position), so an unstable sort is enough.
+    if (maxCount == count)
+        std::sort(positions.begin(), positions.end(), ContactPositionLessThan(&keys));
+    else
+        std::partial_sort(positions.begin(), positions.begin() + maxCount, positions.end(), ContactPositionLessThan(&keys));
+
+    QList<QContact> sorted;
+    sorted.reserve(maxCount);
+    for (int i = 0; i < maxCount; ++i)
+        sorted.append(contacts->at(positions.at(i)));
+    *contacts = sorted;
+}
+
 /*!
   Notifies the manager engine that the given request \a req is in the process of being destroyed.
 
@@ -1883,6 +1717,81 @@ void QContactManagerEngine::updateRequestState(QContactAbstractRequest* req, QCo
 }
 
 
+/*!
+  Updates the given QContactCountRequest \a req with the latest result \a result, and operation error \a error.
+  In addition, the state of the request will be changed to \a newState.
+
+  It then causes the request to emit its resultsAvailable() signal to notify clients of the request progress.
+
+  If the new request state is different from the previous state, the stateChanged() signal will also be emitted from the request.
+ */
+void QContactManagerEngine::updateContactCountRequest(QContactCountRequest *req, int result, QContactManager::Error error, QContactAbstractRequest::State newState)
+{
+    Q_ASSERT(req);
+    QContactCountRequestPrivate* rd = static_cast<QContactCountRequestPrivate*>(req->d_ptr);
+    QMutexLocker ml(&rd->m_mutex);
+    bool emitState = rd->m_state != newState;
+    rd->m_count = result;
+    rd->m_error = error;
+    rd->m_state = newState;
+    ml.unlock();
+#if !defined(QT_NO_DEBUG) || defined(QT_FORCE_ASSERTS)
+    QPointer<QContactAbstractRequest> guard(req);
+#endif
+    Qt::ConnectionType connectionType = Qt::DirectConnection;
+#ifdef QT_NO_THREAD
+    if (req->thread() != QThread::currentThread())
+        connectionType = Qt::BlockingQueuedConnection;
+#endif
+    QMetaObject::invokeMethod(req, "resultsAvailable", connectionType);
+#if !defined(QT_NO_DEBUG) || defined(QT_FORCE_ASSERTS)
+    Q_ASSERT(guard);
+#endif
+    if (emitState)
+        QMetaObject::invokeMethod(req, "stateChanged", connectionType, Q_ARG(QContactAbstractRequest::State, newState));
+#if !defined(QT_NO_DEBUG) || defined(QT_FORCE_ASSERTS)
+    Q_ASSERT(guard);
+#endif
+}
+
+/*!
+  Updates the given QContactChangesFetchRequest \a req with the latest results \a result and \a currentRevision,
+  and operation error \a error.  In addition, the state of the request will be changed to \a newState.
+
+  It then causes the request to emit its resultsAvailable() signal to notify clients of the request progress.
+
+  If the new request state is different from the previous state, the stateChanged() signal will also be emitted from the request.
+ */
+void QContactManagerEngine::updateContactChangesFetchRequest(QContactChangesFetchRequest *req, const QContactChangeSet &result, quint64 currentRevision, QContactManager::Error error, QContactAbstractRequest::State newState)
+{
+    Q_ASSERT(req);
+    QContactChangesFetchRequestPrivate* rd = static_cast<QContactChangesFetchRequestPrivate*>(req->d_ptr);
+    QMutexLocker ml(&rd->m_mutex);
+    bool emitState = rd->m_state != newState;
+    rd->m_changeSet = result;
+    rd->m_currentRevision = currentRevision;
+    rd->m_error = error;
+    rd->m_state = newState;
+    ml.unlock();
+#if !defined(QT_NO_DEBUG) || defined(QT_FORCE_ASSERTS)
+    QPointer<QContactAbstractRequest> guard(req);
+#endif
+    Qt::ConnectionType connectionType = Qt::DirectConnection;
+#ifdef QT_NO_THREAD
+    if (req->thread() != QThread::currentThread())
+        connectionType = Qt::BlockingQueuedConnection;
+#endif
+    QMetaObject::invokeMethod(req, "resultsAvailable", connectionType);
+#if !defined(QT_NO_DEBUG) || defined(QT_FORCE_ASSERTS)
+    Q_ASSERT(guard);
+#endif
+    if (emitState)
+        QMetaObject::invokeMethod(req, "stateChanged", connectionType, Q_ARG(QContactAbstractRequest::State, newState));
+#if !defined(QT_NO_DEBUG) || defined(QT_FORCE_ASSERTS)
+    Q_ASSERT(guard);
+#endif
+}
+
 /*!
   Updates the given QContactIdFetchRequest \a req with the latest results \a result, and operation error \a error.
   In addition, the state of the request will be changed to \a newState.
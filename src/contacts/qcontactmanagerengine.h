@@ -48,6 +48,7 @@
 
 #include <QtContacts/qcontact.h>
 #include <QtContacts/qcontactabstractrequest.h>
+#include <QtContacts/qcontactcompiledfilter.h>
 #include <QtContacts/qcontactfetchhint.h>
 #include <QtContacts/qcontactfilter.h>
 #include <QtContacts/qcontactid.h>
@@ -83,6 +84,7 @@ public:
 
     /* Filtering */
     virtual QList<QContactId> contactIds(const QContactFilter &filter, const QList<QContactSortOrder> &sortOrders, QContactManager::Error *error) const;
+    virtual int contactCount(const QContactFilter &filter, QContactManager::Error *error) const;
     virtual QList<QContact> contacts(const QContactFilter &filter, const QList<QContactSortOrder>& sortOrders, const QContactFetchHint &fetchHint, QContactManager::Error *error) const;
     virtual QList<QContact> contacts(const QList<QContactId> &contactIds, const QContactFetchHint& fetchHint, QMap<int, QContactManager::Error> *errorMap, QContactManager::Error *error) const;
     virtual QContact contact(const QContactId &contactId, const QContactFetchHint &fetchHint, QContactManager::Error *error) const;
@@ -100,6 +102,10 @@ public:
     virtual bool setSelfContactId(const QContactId &contactId, QContactManager::Error *error);
     virtual QContactId selfContactId(QContactManager::Error *error) const;
 
+    /* Revisions, for synchronization */
+    virtual quint64 revision(QContactManager::Error *error) const;
+    virtual QContactChangeSet changesSince(quint64 revision, quint64 *currentRevision, QContactManager::Error *error) const;
+
     /* Relationships between contacts */
     virtual QList<QContactRelationship> relationships(const QString &relationshipType, const QContactId& participantId, QContactRelationship::Role role, QContactManager::Error *error) const;
     virtual bool saveRelationships(QList<QContactRelationship> *relationships, QMap<int, QContactManager::Error>* errorMap, QContactManager::Error *error);
@@ -146,6 +152,8 @@ public:
     static void updateRequestState(QContactAbstractRequest *req, QContactAbstractRequest::State state);
 
     static void updateContactIdFetchRequest(QContactIdFetchRequest *req, const QList<QContactId>& result, QContactManager::Error error, QContactAbstractRequest::State);
+    static void updateContactCountRequest(QContactCountRequest *req, int result, QContactManager::Error error, QContactAbstractRequest::State);
+    static void updateContactChangesFetchRequest(QContactChangesFetchRequest *req, const QContactChangeSet &result, quint64 currentRevision, QContactManager::Error error, QContactAbstractRequest::State);
     static void updateContactFetchRequest(QContactFetchRequest *req, const QList<QContact> &result, QContactManager::Error error, QContactAbstractRequest::State);
     static void updateContactFetchByIdRequest(QContactFetchByIdRequest *req, const QList<QContact>& result, QContactManager::Error error, const QMap<int, QContactManager::Error> &errorMap, QContactAbstractRequest::State);
     static void updateContactRemoveRequest(QContactRemoveRequest *req, QContactManager::Error error, const QMap<int, QContactManager::Error> &errorMap, QContactAbstractRequest::State);
@@ -170,6 +178,7 @@ public:
     static int compareVariant(const QVariant &first, const QVariant &second, Qt::CaseSensitivity sensitivity);
     static bool testFilter(const QContactFilter& filter, const QContact &contact);
     static QList<QContactId> sortContacts(const QList<QContact> &contacts, const QList<QContactSortOrder> &sortOrders);
+    static void sortContacts(QList<QContact> *contacts, const QList<QContactSortOrder> &sortOrders, int maxCount = -1);
 
     static QContactFilter canonicalizedFilter(const QContactFilter &filter);
 
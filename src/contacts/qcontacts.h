@@ -55,6 +55,7 @@
 #include <QtContacts/qcontactfetchhint.h>                  // backend optimization hint class
 #include <QtContacts/qcontactfilter.h>                     // contact filter
 #include <QtContacts/qcontactfilters.h>                    // leaf filter classes
+#include <QtContacts/qcontactcompiledfilter.h>             // compiled filter for engines
 #include <QtContacts/qcontactsortorder.h>                  // contact sorting
 #include <QtContacts/qcontactaction.h>                     // actions
 #include <QtContacts/qcontactactiondescriptor.h>           // action descriptors
@@ -0,0 +1,116 @@
+/****************************************************************************
+**
+** Copyright (C) 2017 The Qt Company Ltd.
+** Contact: https://www.qt.io/licensing/
+**
+** This file is part of the QtContacts module of the Qt Toolkit.
+**
+** $QT_BEGIN_LICENSE:LGPL$
+** Commercial License Usage
+** Licensees holding valid commercial Qt licenses may use this file in
+** accordance with the commercial license agreement provided with the
+** Software or, alternatively, in accordance with the terms contained in
+** a written agreement between you and The Qt Company. For licensing terms
+** and conditions see https://www.qt.io/terms-conditions. For further
+** information use the contact form at https://www.qt.io/contact-us.
+**
+** GNU Lesser General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU Lesser
+** General Public License version 3 as published by the Free Software
+** Foundation and appearing in the file LICENSE.LGPL3 included in the
+** packaging of this file. Please review the following information to
+** ensure the GNU Lesser General Public License version 3 requirements
+** will be met: https://www.gnu.org/licenses/lgpl-3.0.html.
+**
+** GNU General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU
+** General Public License version 2.0 or (at your option) the GNU General
+** Public license version 3 or any later version approved by the KDE Free
+** Qt Foundation. The licenses are as published by the Free Software
+** Foundation and appearing in the file LICENSE.GPL2 and LICENSE.GPL3
+** included in the packaging of this file. Please review the following
+** information to ensure the GNU General Public License requirements will
+** be met: https://www.gnu.org/licenses/gpl-2.0.html and
+** https://www.gnu.org/licenses/gpl-3.0.html.
+**
+** $QT_END_LICENSE$
+**
+****************************************************************************/
+
+#include "qcontactchangesfetchrequest.h"
+
+#include "qcontactrequests_p.h"
+
+QT_BEGIN_NAMESPACE_CONTACTS
+
+/*!
+  \class QContactChangesFetchRequest
+  \brief The QContactChangesFetchRequest class allows a client to asynchronously
+    request the contacts added, changed and removed since a revision of a contacts store manager.
+
+
+  For a QContactChangesFetchRequest, the resultsAvailable() signal will be emitted when the resultant
+  change set (which may be retrieved by calling changeSet()) and revision (which may be retrieved by
+  calling currentRevision()) are updated, as well as if the overall operation error (which may be
+  retrieved by calling error()) is updated.
+
+  Please see the class documentation of QContactAbstractRequest for more information about
+  the usage of request classes and ownership semantics.
+
+  \sa QContactManager::changesSince()
+
+  \inmodule QtContacts
+
+  \ingroup contacts-requests
+ */
+
+/*! Constructs a new contact changes fetch request whose parent is the specified \a parent */
+QContactChangesFetchRequest::QContactChangesFetchRequest(QObject* parent)
+    : QContactAbstractRequest(new QContactChangesFetchRequestPrivate, parent)
+{
+}
+
+/*! Frees any memory used by this request */
+QContactChangesFetchRequest::~QContactChangesFetchRequest()
+{
+}
+
+/*! Sets the revision, as returned by QContactManager::revision(), since which changes will be returned to \a revision
+*/
+void QContactChangesFetchRequest::setSinceRevision(quint64 revision)
+{
+    Q_D(QContactChangesFetchRequest);
+    QMutexLocker ml(&d->m_mutex);
+    d->m_sinceRevision = revision;
+}
+
+/*! Returns the revision since which changes will be returned
+*/
+quint64 QContactChangesFetchRequest::sinceRevision() const
+{
+    Q_D(const QContactChangesFetchRequest);
+    QMutexLocker ml(&d->m_mutex);
+    return d->m_sinceRevision;
+}
+
+/*! Returns the contacts added, changed and removed since the requested revision
+*/
+QContactChangeSet QContactChangesFetchRequest::changeSet() const
+{
+    Q_D(const QContactChangesFetchRequest);
+    QMutexLocker ml(&d->m_mutex);
+    return d->m_changeSet;
+}
+
+/*! Returns the revision which the changes returned by changeSet() bring the client up to
+*/
+quint64 QContactChangesFetchRequest::currentRevision() const
+{
+    Q_D(const QContactChangesFetchRequest);
+    QMutexLocker ml(&d->m_mutex);
+    return d->m_currentRevision;
+}
+
+QT_END_NAMESPACE_CONTACTS
+
+#include "moc_qcontactchangesfetchrequest.cpp"
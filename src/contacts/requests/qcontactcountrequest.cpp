@@ -0,0 +1,106 @@
+/****************************************************************************
+**
+** Copyright (C) 2017 The Qt Company Ltd.
+** Contact: https://www.qt.io/licensing/
+**
+** This file is part of the QtContacts module of the Qt Toolkit.
+**
+** $QT_BEGIN_LICENSE:LGPL$
+** Commercial License Usage
+** Licensees holding valid commercial Qt licenses may use this file in
+** accordance with the commercial license agreement provided with the
+** Software or, alternatively, in accordance with the terms contained in
+** a written agreement between you and The Qt Company. For licensing terms
+** and conditions see https://www.qt.io/terms-conditions. For further
+** information use the contact form at https://www.qt.io/contact-us.
+**
+** GNU Lesser General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU Lesser
+** General Public License version 3 as published by the Free Software
+** Foundation and appearing in the file LICENSE.LGPL3 included in the
+** packaging of this file. Please review the following information to
+** ensure the GNU Lesser General Public License version 3 requirements
+** will be met: https://www.gnu.org/licenses/lgpl-3.0.html.
+**
+** GNU General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU
+** General Public License version 2.0 or (at your option) the GNU General
+** Public license version 3 or any later version approved by the KDE Free
+** Qt Foundation. The licenses are as published by the Free Software
+** Foundation and appearing in the file LICENSE.GPL2 and LICENSE.GPL3
+** included in the packaging of this file. Please review the following
+** information to ensure the GNU General Public License requirements will
+** be met: https://www.gnu.org/licenses/gpl-2.0.html and
+** https://www.gnu.org/licenses/gpl-3.0.html.
+**
+** $QT_END_LICENSE$
+**
+****************************************************************************/
+
+#include "qcontactcountrequest.h"
+
+#include "qcontactrequests_p.h"
+
+QT_BEGIN_NAMESPACE_CONTACTS
+
+/*!
+  \class QContactCountRequest
+  \brief The QContactCountRequest class allows a client to asynchronously
+    request the number of contacts which match a filter from a contacts store manager.
+
+
+  For a QContactCountRequest, the resultsAvailable() signal will be emitted when the resultant
+  count (which may be retrieved by calling count()), is updated, as well as if
+  the overall operation error (which may be retrieved by calling error()) is updated.
+
+  Please see the class documentation of QContactAbstractRequest for more information about
+  the usage of request classes and ownership semantics.
+
+  \sa QContactManager::contactCount()
+
+  \inmodule QtContacts
+
+  \ingroup contacts-requests
+ */
+
+/*! Constructs a new contact count request whose parent is the specified \a parent */
+QContactCountRequest::QContactCountRequest(QObject* parent)
+    : QContactAbstractRequest(new QContactCountRequestPrivate, parent)
+{
+}
+
+/*! Frees any memory used by this request */
+QContactCountRequest::~QContactCountRequest()
+{
+}
+
+/*! Sets the filter which will be used to select the contacts which will be counted to \a filter
+*/
+void QContactCountRequest::setFilter(const QContactFilter& filter)
+{
+    Q_D(QContactCountRequest);
+    QMutexLocker ml(&d->m_mutex);
+    d->m_filter = filter;
+}
+
+/*! Returns the filter which will be used to select the contacts which will be counted
+*/
+QContactFilter QContactCountRequest::filter() const
+{
+    Q_D(const QContactCountRequest);
+    QMutexLocker ml(&d->m_mutex);
+    return d->m_filter;
+}
+
+/*! Returns the number of contacts which matched the request
+*/
+int QContactCountRequest::count() const
+{
+    Q_D(const QContactCountRequest);
+    QMutexLocker ml(&d->m_mutex);
+    return d->m_count;
+}
+
+QT_END_NAMESPACE_CONTACTS
+
+#include "moc_qcontactcountrequest.cpp"
@@ -52,6 +52,8 @@
 #include <QtContacts/qcontactidfetchrequest.h>
 #include <QtContacts/qcontactremoverequest.h>
 #include <QtContacts/qcontactsaverequest.h>
+#include <QtContacts/qcontactchangesfetchrequest.h>
+#include <QtContacts/qcontactcountrequest.h>
 
 #include <QtContacts/qcontactcollectionchangeset.h>
 #include <QtContacts/qcontactcollectionfetchrequest.h>
@@ -58,6 +58,7 @@
 #include <QtCore/qstringlist.h>
 
 #include <QtContacts/qcontact.h>
+#include <QtContacts/qcontactchangeset.h>
 #include <QtContacts/qcontactdetail.h>
 #include <QtContacts/qcontactfetchhint.h>
 #include <QtContacts/qcontactfilter.h>
@@ -216,6 +217,68 @@ public:
     QList<QContactId> m_ids;
 };
 
+class QContactCountRequestPrivate : public QContactAbstractRequestPrivate
+{
+public:
+    QContactCountRequestPrivate()
+        : QContactAbstractRequestPrivate(QContactAbstractRequest::ContactCountRequest),
+          m_count(0)
+    {
+    }
+
+    ~QContactCountRequestPrivate()
+    {
+    }
+
+#ifndef QT_NO_DEBUG_STREAM
+    QDebug& debugStreamOut(QDebug& dbg) const
+    {
+        dbg.nospace() << "QContactCountRequest("
+                      << "filter=" << m_filter << ","
+                      << "count=" << m_count;
+        dbg.nospace() << ")";
+        return dbg.maybeSpace();
+    }
+#endif
+
+    QContactFilter m_filter;
+
+    int m_count;
+};
+
+class QContactChangesFetchRequestPrivate : public QContactAbstractRequestPrivate
+{
+public:
+    QContactChangesFetchRequestPrivate()
+        : QContactAbstractRequestPrivate(QContactAbstractRequest::ContactChangesFetchRequest),
+          m_sinceRevision(0),
+          m_currentRevision(0)
+    {
+    }
+
+    ~QContactChangesFetchRequestPrivate()
+    {
+    }
+
+#ifndef QT_NO_DEBUG_STREAM
+    QDebug& debugStreamOut(QDebug& dbg) const
+    {
+        dbg.nospace() << "QContactChangesFetchRequest("
+                      << "sinceRevision=" << m_sinceRevision << ","
+                      << "addedContacts=" << m_changeSet.addedContacts() << ","
+                      << "removedContacts=" << m_changeSet.removedContacts() << ","
+                      << "currentRevision=" << m_currentRevision;
+        dbg.nospace() << ")";
+        return dbg.maybeSpace();
+    }
+#endif
+
+    quint64 m_sinceRevision;
+
+    QContactChangeSet m_changeSet;
+    quint64 m_currentRevision;
+};
+
 class QContactRelationshipFetchRequestPrivate : public QContactAbstractRequestPrivate
 {
 public:
@@ -1,9 +1,11 @@
 INCLUDEPATH += requests
 
 PUBLIC_HEADERS += \
+    requests/qcontactchangesfetchrequest.h \
     requests/qcontactcollectionfetchrequest.h \
     requests/qcontactcollectionremoverequest.h \
     requests/qcontactcollectionsaverequest.h \
+    requests/qcontactcountrequest.h \
     requests/qcontactfetchrequest.h \
     requests/qcontactfetchbyidrequest.h \
     requests/qcontactidfetchrequest.h \
@@ -18,9 +20,11 @@ PRIVATE_HEADERS += \
     requests/qcontactrequests_p.h
 
 SOURCES += \
+    requests/qcontactchangesfetchrequest.cpp \
     requests/qcontactcollectionfetchrequest.cpp \
     requests/qcontactcollectionremoverequest.cpp \
     requests/qcontactcollectionsaverequest.cpp \
+    requests/qcontactcountrequest.cpp \
     requests/qcontactfetchrequest.cpp \
     requests/qcontactfetchbyidrequest.cpp \
     requests/qcontactidfetchrequest.cpp \
@@ -78,6 +78,7 @@ void QOrganizerItemIdFilter::setIds(const QList<QOrganizerItemId> &ids)
 {
     Q_D(QOrganizerItemIdFilter);
     d->m_ids = ids;
+    d->idsChanged();
 }
 
 /*!
@@ -88,8 +89,10 @@ void QOrganizerItemIdFilter::setIds(const QList<QOrganizerItemId> &ids)
 void QOrganizerItemIdFilter::insert(const QOrganizerItemId &id)
 {
     Q_D(QOrganizerItemIdFilter);
-    if (!d->m_ids.contains(id))
+    if (!d->m_ids.contains(id)) {
         d->m_ids.append(id);
+        d->idsChanged();
+    }
 }
 
 /*!
@@ -100,7 +103,8 @@ void QOrganizerItemIdFilter::insert(const QOrganizerItemId &id)
 void QOrganizerItemIdFilter::remove(const QOrganizerItemId &id)
 {
     Q_D(QOrganizerItemIdFilter);
-    d->m_ids.removeAll(id);
+    if (d->m_ids.removeAll(id))
+        d->idsChanged();
 }
 
 /*!
@@ -113,6 +117,7 @@ void QOrganizerItemIdFilter::clear()
 {
     Q_D(QOrganizerItemIdFilter);
     d->m_ids.clear();
+    d->idsChanged();
 }
 
 /*!
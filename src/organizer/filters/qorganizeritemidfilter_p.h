@@ -51,6 +51,9 @@
 // We mean it.
 //
 
+#include <QtCore/qatomic.h>
+#include <QtCore/qset.h>
+
 #include <QtOrganizer/qorganizeritemidfilter.h>
 #include <QtOrganizer/private/qorganizeritemfilter_p.h>
 
@@ -60,13 +63,40 @@ class QOrganizerItemIdFilterPrivate : public QOrganizerItemFilterPrivate
 {
 public:
     QOrganizerItemIdFilterPrivate()
-        : QOrganizerItemFilterPrivate()
+        : QOrganizerItemFilterPrivate(), m_idSet(0)
     {
     }
 
     QOrganizerItemIdFilterPrivate(const QOrganizerItemIdFilterPrivate &other)
-        : QOrganizerItemFilterPrivate(other), m_ids(other.m_ids)
+        : QOrganizerItemFilterPrivate(other), m_ids(other.m_ids), m_idSet(0)
+    {
+    }
+
+    ~QOrganizerItemIdFilterPrivate()
     {
+        delete m_idSet.loadAcquire();
+    }
+
+    // returns true if the id is one of m_ids; the ids are hashed on first use, so that testing
+    // the same filter against many items costs O(1) per item.
+    bool containsId(const QOrganizerItemId &id) const
+    {
+        QSet<QOrganizerItemId> *idSet = m_idSet.loadAcquire();
+        if (!idSet) {
+            idSet = new QSet<QOrganizerItemId>(m_ids.toSet());
+            if (!m_idSet.testAndSetOrdered(0, idSet)) {
+                // another thread built it first.
+                delete idSet;
+                idSet = m_idSet.loadAcquire();
+            }
+        }
+        return idSet->contains(id);
+    }
+
+    // must be called whenever m_ids is modified.
+    void idsChanged()
+    {
+        delete m_idSet.fetchAndStoreOrdered(0);
     }
 
     virtual bool compare(const QOrganizerItemFilterPrivate *other) const
@@ -87,8 +117,10 @@ public:
 
     QDataStream &inputFromStream(QDataStream &stream, quint8 formatVersion)
     {
-        if (formatVersion == 1)
+        if (formatVersion == 1) {
             stream >> m_ids;
+            idsChanged();
+        }
         return stream;
     }
 #endif // QT_NO_DATASTREAM
@@ -107,6 +139,7 @@ public:
     Q_IMPLEMENT_ORGANIZERITEMFILTER_VIRTUALCTORS(QOrganizerItemIdFilter, QOrganizerItemFilter::IdFilter)
 
     QList<QOrganizerItemId> m_ids;
+    mutable QAtomicPointer<QSet<QOrganizerItemId> > m_idSet;
 };
 
 QT_END_NAMESPACE_ORGANIZER
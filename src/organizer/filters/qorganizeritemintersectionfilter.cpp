@@ -77,6 +77,7 @@ void QOrganizerItemIntersectionFilter::setFilters(const QList<QOrganizerItemFilt
 {
     Q_D(QOrganizerItemIntersectionFilter);
     d->m_filters = filters;
+    d->filtersChanged();
 }
 
 /*!
@@ -88,6 +89,7 @@ void QOrganizerItemIntersectionFilter::clear()
 {
     Q_D(QOrganizerItemIntersectionFilter);
     d->m_filters.clear();
+    d->filtersChanged();
 }
 
 /*!
@@ -99,6 +101,7 @@ void QOrganizerItemIntersectionFilter::prepend(const QOrganizerItemFilter &filte
 {
     Q_D(QOrganizerItemIntersectionFilter);
     d->m_filters.prepend(filter);
+    d->filtersChanged();
 }
 
 /*!
@@ -110,6 +113,7 @@ void QOrganizerItemIntersectionFilter::append(const QOrganizerItemFilter &filter
 {
     Q_D(QOrganizerItemIntersectionFilter);
     d->m_filters.append(filter);
+    d->filtersChanged();
 }
 
 /*!
@@ -121,6 +125,7 @@ void QOrganizerItemIntersectionFilter::remove(const QOrganizerItemFilter &filter
 {
     Q_D(QOrganizerItemIntersectionFilter);
     d->m_filters.removeAll(filter);
+    d->filtersChanged();
 }
 
 /*!
@@ -132,6 +137,7 @@ QOrganizerItemIntersectionFilter &QOrganizerItemIntersectionFilter::operator<<(c
 {
     Q_D(QOrganizerItemIntersectionFilter);
     d->m_filters << filter;
+    d->filtersChanged();
     return *this;
 }
 
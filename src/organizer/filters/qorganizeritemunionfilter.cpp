@@ -76,6 +76,7 @@ void QOrganizerItemUnionFilter::setFilters(const QList<QOrganizerItemFilter> &fi
 {
     Q_D(QOrganizerItemUnionFilter);
     d->m_filters = filters;
+    d->filtersChanged();
 }
 
 /*!
@@ -87,6 +88,7 @@ void QOrganizerItemUnionFilter::prepend(const QOrganizerItemFilter &filter)
 {
     Q_D(QOrganizerItemUnionFilter);
     d->m_filters.prepend(filter);
+    d->filtersChanged();
 }
 
 /*!
@@ -98,6 +100,7 @@ void QOrganizerItemUnionFilter::append(const QOrganizerItemFilter &filter)
 {
     Q_D(QOrganizerItemUnionFilter);
     d->m_filters.append(filter);
+    d->filtersChanged();
 }
 
 /*!
@@ -109,6 +112,7 @@ void QOrganizerItemUnionFilter::remove(const QOrganizerItemFilter &filter)
 {
     Q_D(QOrganizerItemUnionFilter);
     d->m_filters.removeAll(filter);
+    d->filtersChanged();
 }
 
 /*!
@@ -120,6 +124,7 @@ void QOrganizerItemUnionFilter::clear()
 {
     Q_D(QOrganizerItemUnionFilter);
     d->m_filters.clear();
+    d->filtersChanged();
 }
 
 /*!
@@ -131,6 +136,7 @@ QOrganizerItemUnionFilter &QOrganizerItemUnionFilter::operator<<(const QOrganize
 {
     Q_D(QOrganizerItemUnionFilter);
     d->m_filters << filter;
+    d->filtersChanged();
     return *this;
 }
 
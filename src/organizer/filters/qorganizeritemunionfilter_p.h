@@ -87,8 +87,10 @@ public:
 
     QDataStream &inputFromStream(QDataStream &stream, quint8 formatVersion)
     {
-        if (formatVersion == 1)
+        if (formatVersion == 1) {
             stream >> m_filters;
+            filtersChanged();
+        }
         return stream;
     }
 #endif // QT_NO_DATASTREAM
@@ -106,7 +108,14 @@ public:
 
     Q_IMPLEMENT_ORGANIZERITEMFILTER_VIRTUALCTORS(QOrganizerItemUnionFilter, QOrganizerItemFilter::UnionFilter)
 
+    // must be called whenever m_filters is modified.
+    void filtersChanged()
+    {
+        m_termOrder.clear();
+    }
+
     QList<QOrganizerItemFilter> m_filters;
+    QOrganizerItemFilterTermOrder m_termOrder;
 };
 
 QT_END_NAMESPACE_ORGANIZER
@@ -23,6 +23,7 @@ PUBLIC_HEADERS += \
     qorganizeritem.h \
     qorganizeritemid.h \
     qorganizeritemobserver.h \
+    qorganizeritemoccurrenceiterator.h \
     qorganizermanager.h \
     qorganizermanagerengine.h \
     qorganizermanagerenginefactory.h \
@@ -40,6 +41,7 @@ PRIVATE_HEADERS += \
     qorganizeritemdetail_p.h \
     qorganizeritemfilter_p.h \
     qorganizeritemfetchhint_p.h \
+    qorganizeritemoccurrenceiterator_p.h \
     qorganizermanager_p.h \
     qorganizerrecurrencerule_p.h \
     qorganizeritemsortorder_p.h
@@ -56,6 +58,7 @@ SOURCES += \
     qorganizeritemfilter.cpp \
     qorganizeritemid.cpp \
     qorganizeritemobserver.cpp \
+    qorganizeritemoccurrenceiterator.cpp \
     qorganizermanager.cpp \
     qorganizermanagerengine.cpp \
     qorganizermanagerenginefactory.cpp \
@@ -52,6 +52,7 @@
 #include <QtOrganizer/qorganizeritem.h>                           // organizer item
 #include <QtOrganizer/qorganizeritemid.h>                         // organizer item identifier
 #include <QtOrganizer/qorganizeritemobserver.h>                   // organizer item observer
+#include <QtOrganizer/qorganizeritemoccurrenceiterator.h>         // organizer item occurrence iterator
 #include <QtOrganizer/qorganizermanager.h>                        // manager
 #include <QtOrganizer/qorganizermanagerengine.h>                  // manager backend
 #include <QtOrganizer/qorganizermanagerenginefactory.h>           // manage backend instantiator
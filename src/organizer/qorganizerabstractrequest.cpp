@@ -101,6 +101,8 @@ QT_BEGIN_NAMESPACE_ORGANIZER
     \value CollectionSaveRequest       A request to save a collection.
     \value ItemFetchByIdRequest        A request to fetch an organizer item by ID.
     \value ItemRemoveByIdRequest       A request to remove an organizer item by ID.
+    \value ItemChangesFetchRequest     A request to fetch the organizer items added, changed and removed since a revision.
+    \value ItemCountRequest            A request to count the organizer items which match a filter.
 
  */
 
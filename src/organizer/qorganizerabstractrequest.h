@@ -81,7 +81,9 @@ public:
         ItemSaveRequest,
         CollectionFetchRequest,
         CollectionRemoveRequest,
-        CollectionSaveRequest
+        CollectionSaveRequest,
+        ItemChangesFetchRequest,
+        ItemCountRequest
     };
 
     RequestType type() const;
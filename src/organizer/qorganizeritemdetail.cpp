@@ -258,9 +258,9 @@ bool QOrganizerItemDetail::operator==(const QOrganizerItemDetail &other) const
 Q_ORGANIZER_EXPORT uint qHash(const QOrganizerItemDetail &key)
 {
     uint hash = QT_PREPEND_NAMESPACE(qHash)(key.d->m_detailType);
-    QMap<int, QVariant>::const_iterator it = key.d->m_values.constBegin();
+    QOrganizerItemDetailFieldStore::const_iterator it = key.d->m_values.constBegin();
     while (it != key.d->m_values.constEnd()) {
-        hash += QT_PREPEND_NAMESPACE(qHash)(it.key()) + QT_PREPEND_NAMESPACE(qHash)(it.value().toString());
+        hash += QT_PREPEND_NAMESPACE(qHash)(it->field) + QT_PREPEND_NAMESPACE(qHash)(it->value.toString());
         ++it;
     }
     return hash;
@@ -390,7 +390,7 @@ bool QOrganizerItemDetail::removeValue(int field)
  */
 QMap<int, QVariant> QOrganizerItemDetail::values() const
 {
-    return d->m_values;
+    return d->m_values.toMap();
 }
 
 /*!
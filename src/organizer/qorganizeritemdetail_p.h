@@ -51,13 +51,105 @@
 // We mean it.
 //
 
+#include <algorithm>
+
+#include <QtCore/qdatetime.h>
 #include <QtCore/qmap.h>
 #include <QtCore/qshareddata.h>
+#include <QtCore/qvariant.h>
+#include <QtCore/qvector.h>
 
 #include <QtOrganizer/qorganizeritemdetail.h>
 
 QT_BEGIN_NAMESPACE_ORGANIZER
 
+/*
+    Storage for the field values of a detail: (field, value) pairs kept sorted by field in a
+    single flat array, so that a detail needs one allocation for its fields rather than one per
+    field.
+*/
+class QOrganizerItemDetailFieldStore
+{
+public:
+    struct Entry {
+        int field;
+        QVariant value;
+    };
+    typedef const Entry *const_iterator;
+
+    bool isEmpty() const { return m_entries.isEmpty(); }
+    int size() const { return m_entries.size(); }
+
+    const_iterator constBegin() const { return m_entries.constData(); }
+    const_iterator constEnd() const { return m_entries.constData() + m_entries.size(); }
+
+    const_iterator constFind(int field) const
+    {
+        const int i = lowerBound(field);
+        return (i < m_entries.size() && m_entries.at(i).field == field) ? constBegin() + i : constEnd();
+    }
+
+    bool contains(int field) const { return constFind(field) != constEnd(); }
+
+    QVariant value(int field) const
+    {
+        const_iterator it = constFind(field);
+        return it != constEnd() ? it->value : QVariant();
+    }
+
+    void insert(int field, const QVariant &value)
+    {
+        const int i = lowerBound(field);
+        if (i < m_entries.size() && m_entries.at(i).field == field) {
+            m_entries[i].value = value;
+        } else {
+            Entry entry;
+            entry.field = field;
+            entry.value = value;
+            m_entries.insert(i, entry);
+        }
+    }
+
+    bool remove(int field)
+    {
+        const int i = lowerBound(field);
+        if (i == m_entries.size() || m_entries.at(i).field != field)
+            return false;
+        m_entries.remove(i);
+        return true;
+    }
+
+    QMap<int, QVariant> toMap() const
+    {
+        QMap<int, QVariant> map;
+        for (const_iterator it = constBegin(); it != constEnd(); ++it)
+            map.insert(map.constEnd(), it->field, it->value);
+        return map;
+    }
+
+    bool operator==(const QOrganizerItemDetailFieldStore &other) const
+    {
+        if (m_entries.size() != other.m_entries.size())
+            return false;
+        for (int i = 0; i < m_entries.size(); ++i) {
+            if (m_entries.at(i).field != other.m_entries.at(i).field || m_entries.at(i).value != other.m_entries.at(i).value)
+                return false;
+        }
+        return true;
+    }
+
+private:
+    static bool fieldLessThan(const Entry &entry, int field) { return entry.field < field; }
+
+    // returns the index of the first entry whose field is not less than the given field
+    int lowerBound(int field) const
+    {
+        return std::lower_bound(constBegin(), constEnd(), field, fieldLessThan) - constBegin();
+    }
+
+    QVector<Entry> m_entries;
+};
+
 class QOrganizerItemDetailPrivate : public QSharedData
 {
 public:
@@ -80,9 +172,38 @@ public:
     {
     }
 
+    static const QOrganizerItemDetailPrivate *get(const QOrganizerItemDetail &detail)
+    {
+        return detail.d.constData();
+    }
+
+    // typed accessors, used by filtering and sorting; these read the stored value in place
+    bool hasValue(int field) const
+    {
+        return m_values.contains(field);
+    }
+
+    QString stringValue(int field) const
+    {
+        QOrganizerItemDetailFieldStore::const_iterator it = m_values.constFind(field);
+        return it != m_values.constEnd() ? it->value.toString() : QString();
+    }
+
+    int intValue(int field) const
+    {
+        QOrganizerItemDetailFieldStore::const_iterator it = m_values.constFind(field);
+        return it != m_values.constEnd() ? it->value.toInt() : 0;
+    }
+
+    QDateTime dateTimeValue(int field) const
+    {
+        QOrganizerItemDetailFieldStore::const_iterator it = m_values.constFind(field);
+        return it != m_values.constEnd() ? it->value.toDateTime() : QDateTime();
+    }
+
     int m_id; // internal, unique id.
     QOrganizerItemDetail::DetailType m_detailType;
-    QMap<int, QVariant> m_values;
+    QOrganizerItemDetailFieldStore m_values;
 
     static QAtomicInt &lastDetailKey()
     {
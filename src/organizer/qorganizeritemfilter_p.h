@@ -57,9 +57,11 @@
 #ifndef QT_NO_DEBUG_STREAM
 #include <QtCore/qdebug.h>
 #endif
+#include <QtCore/qatomic.h>
 #include <QtCore/qlist.h>
 #include <QtCore/qset.h>
 #include <QtCore/qshareddata.h>
+#include <QtCore/qvector.h>
 
 #include <QtOrganizer/qorganizeritemfilter.h>
 
@@ -110,6 +112,35 @@ public:
     /* Helper functions for C++ protection rules */
     static const QSharedDataPointer<QOrganizerItemFilterPrivate> &extract_d(const QOrganizerItemFilter &other) { return other.d_ptr; }
 };
+
+/*
+    The order in which QOrganizerManagerEngine::testFilter() tests the terms of an intersection or
+    union.  It is worked out the first time the filter is tested, shared by every copy of the
+    filter, and must be cleared whenever the terms change.
+*/
+class QOrganizerItemFilterTermOrder
+{
+public:
+    QOrganizerItemFilterTermOrder() : m_order(0) {}
+    ~QOrganizerItemFilterTermOrder() { delete m_order.loadAcquire(); }
+
+    const QVector<int> *order() const { return m_order.loadAcquire(); }
+
+    // publishes the given order, unless another thread did so first; returns the published order
+    const QVector<int> *setOrder(const QVector<int> *order) const
+    {
+        if (m_order.testAndSetOrdered(0, order))
+            return order;
+        delete order;
+        return m_order.loadAcquire();
+    }
+
+    void clear() { delete m_order.fetchAndStoreOrdered(0); }
+
+private:
+    Q_DISABLE_COPY(QOrganizerItemFilterTermOrder)
+    mutable QAtomicPointer<const QVector<int> > m_order;
+};
 QT_END_NAMESPACE_ORGANIZER
 
 QT_BEGIN_NAMESPACE
@@ -0,0 +1,422 @@
+/****************************************************************************
+**
+** Copyright (C) 2017 The Qt Company Ltd.
+** Contact: https://www.qt.io/licensing/
+**
+** This file is part of the QtOrganizer module of the Qt Toolkit.
+**
+** $QT_BEGIN_LICENSE:LGPL$
+** Commercial License Usage
+** Licensees holding valid commercial Qt licenses may use this file in
+** accordance with the commercial license agreement provided with the
+** Software or, alternatively, in accordance with the terms contained in
+** a written agreement between you and The Qt Company. For licensing terms
+** and conditions see https://www.qt.io/terms-conditions. For further
+** information use the contact form at https://www.qt.io/contact-us.
+**
+** GNU Lesser General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU Lesser
+** General Public License version 3 as published by the Free Software
+** Foundation and appearing in the file LICENSE.LGPL3 included in the
+** packaging of this file. Please review the following information to
+** ensure the GNU Lesser General Public License version 3 requirements
+** will be met: https://www.gnu.org/licenses/lgpl-3.0.html.
+**
+** GNU General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU
+** General Public License version 2.0 or (at your option) the GNU General
+** Public license version 3 or any later version approved by the KDE Free
+** Qt Foundation. The licenses are as published by the Free Software
+** Foundation and appearing in the file LICENSE.GPL2 and LICENSE.GPL3
+** included in the packaging of this file. Please review the following
+** information to ensure the GNU General Public License requirements will
+** be met: https://www.gnu.org/licenses/gpl-2.0.html and
+** https://www.gnu.org/licenses/gpl-3.0.html.
+**
+** $QT_END_LICENSE$
+**
+****************************************************************************/
+
+#include "qorganizeritemoccurrenceiterator.h"
+#include "qorganizeritemoccurrenceiterator_p.h"
+
+#include "qorganizeritems.h"
+#include "qorganizeritemdetails.h"
+#include "qorganizermanagerengine.h"
+
+QT_BEGIN_NAMESPACE_ORGANIZER
+
+// The Gregorian calendar repeats every 400 years, so a rule repeats at most every 400 of its intervals
+static const int CalendarCycleYears = 400;
+// how far past the last generated date the rules are followed when none of their dates is left
+static const qint64 MaximumCycleYears = 100 * CalendarCycleYears;
+
+/*!
+    \class QOrganizerItemOccurrenceIterator
+    \brief The QOrganizerItemOccurrenceIterator class allows the occurrences of a recurring item to
+           be taken one at a time, in time order.
+    \inmodule QtOrganizer
+    \ingroup organizer-main
+
+    An occurrence iterator is returned by QOrganizerManager::itemOccurrenceIterator().  Unlike
+    QOrganizerManager::itemOccurrences(), which returns every occurrence within a period, the
+    iterator generates each occurrence only when it is taken, so a series which never ends can be
+    followed as far as the client wants, and taking the next few occurrences after a given time
+    costs no more than generating those occurrences.
+
+    \code
+        QOrganizerItemOccurrenceIterator it = manager.itemOccurrenceIterator(event, QDateTime::currentDateTime());
+        foreach (const QOrganizerItem &occurrence, it.next(10))
+            qDebug() << occurrence.detail(QOrganizerItemDetail::TypeEventTime);
+    \endcode
+
+    The iterator works on the parent item and its persisted exceptions as they were when it was
+    created; later changes to them are not reflected.  Copies of an iterator share their position,
+    so an occurrence taken from one of them is taken from all of them.
+ */
+
+/*!
+    Constructs an iterator which has no occurrences.
+ */
+QOrganizerItemOccurrenceIterator::QOrganizerItemOccurrenceIterator()
+{
+}
+
+/*!
+    \internal
+    Constructs an iterator which takes its occurrences from \a dd, taking ownership of it.
+ */
+QOrganizerItemOccurrenceIterator::QOrganizerItemOccurrenceIterator(QOrganizerItemOccurrenceIteratorPrivate *dd)
+    : d(dd)
+{
+}
+
+/*!
+    Constructs a copy of the \a other iterator, which shares its position.
+ */
+QOrganizerItemOccurrenceIterator::QOrganizerItemOccurrenceIterator(const QOrganizerItemOccurrenceIterator &other)
+    : d(other.d)
+{
+}
+
+/*!
+    Frees the memory used by this iterator.
+ */
+QOrganizerItemOccurrenceIterator::~QOrganizerItemOccurrenceIterator()
+{
+}
+
+/*!
+    Assigns this iterator to be equal to \a other, sharing its position.
+ */
+QOrganizerItemOccurrenceIterator &QOrganizerItemOccurrenceIterator::operator=(const QOrganizerItemOccurrenceIterator &other)
+{
+    d = other.d;
+    return *this;
+}
+
+/*!
+    Returns true if there is an occurrence left to take.
+
+    For a series which never ends this is always true.
+ */
+bool QOrganizerItemOccurrenceIterator::hasNext() const
+{
+    return !d.isNull() && d->hasNext();
+}
+
+/*!
+    Takes the next occurrence and returns it, or returns an empty item if there is none left.
+ */
+QOrganizerItem QOrganizerItemOccurrenceIterator::next()
+{
+    if (d.isNull())
+        return QOrganizerItem();
+    return d->next();
+}
+
+/*!
+    Takes up to \a count of the next occurrences and returns them, in time order.  Fewer are
+    returned if the series ends first.
+ */
+QList<QOrganizerItem> QOrganizerItemOccurrenceIterator::next(int count)
+{
+    QList<QOrganizerItem> retn;
+    while (retn.size() < count && hasNext())
+        retn.append(d->next());
+    return retn;
+}
+
+/* Returns \a rrule with any criteria missing from it inferred from \a initialDate */
+static QOrganizerRecurrenceRule inferredRule(QOrganizerRecurrenceRule rrule, const QDate &initialDate)
+{
+    if (rrule.frequency() != QOrganizerRecurrenceRule::Invalid && initialDate.isValid())
+        QOrganizerManagerEngine::inferMissingCriteria(&rrule, initialDate);
+    return rrule;
+}
+
+QOrganizerRecurrenceRuleIterator::QOrganizerRecurrenceRuleIterator(const QDateTime &initialDateTime, const QOrganizerRecurrenceRule &rrule,
+                                                                   const QDateTime &startDateTime)
+    : m_rule(inferredRule(rrule, initialDateTime.toLocalTime().date())),
+      m_matcher(m_rule),
+      // perform calculations in local time, for meaningful comparison with date values
+      m_localInitialDateTime(initialDateTime.toLocalTime()),
+      m_localStartDateTime(m_localInitialDateTime),
+      m_countLimitDates(0),
+      m_finished(!initialDateTime.isValid() || rrule.frequency() == QOrganizerRecurrenceRule::Invalid)
+{
+    if (startDateTime.isValid() && startDateTime > initialDateTime)
+        m_localStartDateTime = startDateTime.toLocalTime();
+
+    // the dates before the start count towards a count limit too
+    if (m_rule.limitType() == QOrganizerRecurrenceRule::CountLimit)
+        m_nextDate = m_localInitialDateTime.date();
+    else
+        m_nextDate = m_localStartDateTime.date();
+    m_giveUpDate = m_nextDate.addYears(CalendarCycleYears * qMax(1, m_rule.interval()));
+}
+
+bool QOrganizerRecurrenceRuleIterator::hasNext()
+{
+    return !m_pending.isEmpty() || expandNextPeriod();
+}
+
+QDateTime QOrganizerRecurrenceRuleIterator::peekNext()
+{
+    return hasNext() ? m_pending.first() : QDateTime();
+}
+
+QDateTime QOrganizerRecurrenceRuleIterator::next()
+{
+    return hasNext() ? m_pending.takeFirst() : QDateTime();
+}
+
+/* Expands the periods of the rule, from the next one, until one of them has a time to take */
+bool QOrganizerRecurrenceRuleIterator::expandNextPeriod()
+{
+    const QDate initialDate(m_localInitialDateTime.date());
+    const QOrganizerRecurrenceRule::Frequency frequency = m_rule.frequency();
+    const Qt::DayOfWeek firstDayOfWeek = m_rule.firstDayOfWeek();
+    while (m_pending.isEmpty() && !m_finished) {
+        if ((m_rule.limitType() == QOrganizerRecurrenceRule::DateLimit && m_nextDate > m_rule.limitDate())
+                || (m_rule.limitType() == QOrganizerRecurrenceRule::CountLimit && m_countLimitDates >= m_rule.limitCount())
+                || !m_nextDate.isValid() || m_nextDate > m_giveUpDate) {
+            m_finished = true;
+            break;
+        }
+        // Skip m_nextDate if it is not the right multiple of intervals away from the initial date.
+        if (QOrganizerManagerEngine::inMultipleOfInterval(m_nextDate, initialDate, frequency, m_rule.interval(), firstDayOfWeek)) {
+            // the dates in the current week/month/year that match the rule, in the order they count
+            const QDate periodStart(QOrganizerManagerEngine::firstDateInPeriod(m_nextDate, frequency, firstDayOfWeek));
+            const QDate periodEnd(QOrganizerManagerEngine::firstDateInNextPeriod(m_nextDate, frequency, firstDayOfWeek).addDays(-1));
+            const QList<QDate> matches(QOrganizerManagerEngine::filterByPosition(m_matcher.dates(periodStart, periodEnd),
+                                                                                 m_rule.positions()));
+            foreach (const QDate &match, matches) {
+                if (match < initialDate)
+                    continue;
+                if (m_rule.limitType() == QOrganizerRecurrenceRule::DateLimit && match > m_rule.limitDate())
+                    continue;
+
+                QDateTime generatedDateTime(m_localInitialDateTime);
+                generatedDateTime.setDate(match);
+                m_giveUpDate = match.addYears(CalendarCycleYears * qMax(1, m_rule.interval()));
+                m_countLimitDates++;
+                if (generatedDateTime >= m_localStartDateTime)
+                    m_pending.append(generatedDateTime.toUTC()); // convert back to UTC for the returned value
+                if (m_rule.limitType() == QOrganizerRecurrenceRule::CountLimit && m_countLimitDates >= m_rule.limitCount())
+                    break; // reached limit count defined in the recurrence rule
+            }
+            std::sort(m_pending.begin(), m_pending.end());
+            m_pending.erase(std::unique(m_pending.begin(), m_pending.end()), m_pending.end());
+        }
+        m_nextDate = QOrganizerManagerEngine::firstDateInNextPeriod(m_nextDate, frequency, firstDayOfWeek);
+    }
+    return !m_pending.isEmpty();
+}
+
+/* Returns the time at which the \a exception of a series whose first occurrence is at
+ * \a initialDateTime occurs: its start, else its end or due time, else its original date */
+static QDateTime exceptionDateTime(const QOrganizerItem &exception, const QDateTime &initialDateTime)
+{
+    QDateTime lowerBound;
+    QDateTime upperBound;
+    if (exception.type() == QOrganizerItemType::TypeEventOccurrence) {
+        QOrganizerEventOccurrence instance = exception;
+        lowerBound = instance.startDateTime();
+        upperBound = instance.endDateTime();
+    } else if (exception.type() == QOrganizerItemType::TypeTodoOccurrence) {
+        QOrganizerTodoOccurrence instance = exception;
+        lowerBound = instance.startDateTime();
+        upperBound = instance.dueDateTime();
+    }
+    if (lowerBound.isValid())
+        return lowerBound;
+    if (upperBound.isValid())
+        return upperBound;
+
+    const QOrganizerItemParent parent = exception.detail(QOrganizerItemDetail::TypeParent);
+    if (!parent.originalDate().isValid() || !initialDateTime.isValid())
+        return QDateTime();
+    QDateTime dateTime(initialDateTime.toLocalTime());
+    dateTime.setDate(parent.originalDate());
+    return dateTime.toUTC();
+}
+
+QOrganizerItemOccurrenceIteratorPrivate::QOrganizerItemOccurrenceIteratorPrivate(const QOrganizerItem &parentItem, const QDateTime &startDateTime,
+                                                                                 const QList<QOrganizerItem> &exceptions)
+    : m_parentItem(parentItem),
+      m_cycleYears(CalendarCycleYears)
+{
+    const QDateTime initial(initialDateTime(parentItem));
+    QDateTime realStartDateTime(startDateTime);
+    if (!realStartDateTime.isValid() || (initial.isValid() && initial > realStartDateTime))
+        realStartDateTime = initial;
+
+    if (initial.isValid()) {
+        const QOrganizerItemRecurrence recur = parentItem.detail(QOrganizerItemDetail::TypeRecurrence);
+
+        // the recurrence dates occur at the local time of the initial date, which is one of them
+        QList<QDateTime> recurrenceDates;
+        if (!recur.recurrenceDates().isEmpty())
+            recurrenceDates.append(initial.toUTC());
+        foreach (const QDate &rdate, recur.recurrenceDates()) {
+            QDateTime dt(initial.toLocalTime());
+            dt.setDate(rdate);
+            recurrenceDates.append(dt.toUTC());
+        }
+        std::sort(recurrenceDates.begin(), recurrenceDates.end());
+        foreach (const QDateTime &rdate, recurrenceDates) {
+            if (rdate >= realStartDateTime && (m_recurrenceDates.isEmpty() || rdate != m_recurrenceDates.last()))
+                m_recurrenceDates.append(rdate);
+        }
+
+        qint64 cycleYears = CalendarCycleYears;
+        foreach (const QOrganizerRecurrenceRule &rrule, recur.recurrenceRules()) {
+            if (rrule.frequency() != QOrganizerRecurrenceRule::Invalid) {
+                m_recurrenceRules.append(QOrganizerRecurrenceRuleIterator(initial, rrule, realStartDateTime));
+                cycleYears = qMin(cycleYears * qMax(1, rrule.interval()), MaximumCycleYears);
+            }
+        }
+        foreach (const QOrganizerRecurrenceRule &xrule, recur.exceptionRules()) {
+            if (xrule.frequency() != QOrganizerRecurrenceRule::Invalid) {
+                m_exceptionRules.append(QOrganizerRecurrenceRuleIterator(initial, xrule, realStartDateTime));
+                cycleYears = qMin(cycleYears * qMax(1, xrule.interval()), MaximumCycleYears);
+            }
+        }
+        m_exceptionDates = recur.exceptionDates();
+        m_cycleYears = int(cycleYears);
+        m_giveUpDate = realStartDateTime.toLocalTime().date().addYears(m_cycleYears);
+    }
+
+    foreach (const QOrganizerItem &exception, exceptions) {
+        const QDateTime dateTime(exceptionDateTime(exception, initial));
+        if (dateTime.isValid() && (!realStartDateTime.isValid() || dateTime >= realStartDateTime))
+            m_exceptions.insert(dateTime, exception);
+    }
+}
+
+/* Returns the time of the first occurrence of \a parentItem, which the recurrence is based on */
+QDateTime QOrganizerItemOccurrenceIteratorPrivate::initialDateTime(const QOrganizerItem &parentItem)
+{
+    if (parentItem.type() == QOrganizerItemType::TypeEvent) {
+        QOrganizerEvent evt = parentItem;
+        return evt.startDateTime().isValid() ? evt.startDateTime() : evt.endDateTime();
+    } else if (parentItem.type() == QOrganizerItemType::TypeTodo) {
+        QOrganizerTodo todo = parentItem;
+        return todo.startDateTime().isValid() ? todo.startDateTime() : todo.dueDateTime();
+    }
+    return QDateTime(); // not a recurring item in our schema
+}
+
+bool QOrganizerItemOccurrenceIteratorPrivate::hasNext()
+{
+    return findNextDateTime() || !m_exceptions.isEmpty();
+}
+
+/* Returns the time of the next occurrence, without taking it */
+QDateTime QOrganizerItemOccurrenceIteratorPrivate::nextDateTime()
+{
+    findNextDateTime();
+    return exceptionIsNext() ? m_exceptions.firstKey() : m_nextDateTime;
+}
+
+QOrganizerItem QOrganizerItemOccurrenceIteratorPrivate::next()
+{
+    findNextDateTime();
+    if (exceptionIsNext()) {
+        QMultiMap<QDateTime, QOrganizerItem>::iterator first = m_exceptions.begin();
+        const QOrganizerItem exception = first.value();
+        m_exceptions.erase(first);
+        return exception;
+    }
+    if (!m_nextDateTime.isValid())
+        return QOrganizerItem();
+
+    const QOrganizerItem occurrence = QOrganizerManagerEngine::generateOccurrence(m_parentItem, m_nextDateTime);
+    m_nextDateTime = QDateTime();
+    return occurrence;
+}
+
+bool QOrganizerItemOccurrenceIteratorPrivate::exceptionIsNext() const
+{
+    return !m_exceptions.isEmpty() && (!m_nextDateTime.isValid() || m_exceptions.firstKey() < m_nextDateTime);
+}
+
+/* Finds the next time generated by the recurrence dates and rules which is not excluded, unless
+ * it has already been found */
+bool QOrganizerItemOccurrenceIteratorPrivate::findNextDateTime()
+{
+    while (!m_nextDateTime.isValid()) {
+        QDateTime candidate;
+        int source = -1; // the rule the candidate is taken from, or -1 for the recurrence dates
+        if (!m_recurrenceDates.isEmpty())
+            candidate = m_recurrenceDates.first();
+        for (int i = 0; i < m_recurrenceRules.size(); ++i) {
+            QOrganizerRecurrenceRuleIterator &rule = m_recurrenceRules[i];
+            if (rule.hasNext() && (!candidate.isValid() || rule.peekNext() < candidate)) {
+                candidate = rule.peekNext();
+                source = i;
+            }
+        }
+        if (!candidate.isValid())
+            return false;
+
+        if (source < 0)
+            m_recurrenceDates.removeFirst();
+        else
+            m_recurrenceRules[source].next();
+        if (m_lastDateTime.isValid() && candidate == m_lastDateTime)
+            continue; // generated by more than one rule
+        m_lastDateTime = candidate;
+
+        const QDate localDate(candidate.toLocalTime().date());
+        if (!isExcluded(localDate)) {
+            m_nextDateTime = candidate;
+            m_giveUpDate = localDate.addYears(m_cycleYears);
+        } else if (localDate > m_giveUpDate) {
+            // a whole cycle of the rules has been excluded, so every later one will be too
+            m_recurrenceDates.clear();
+            m_recurrenceRules.clear();
+            return false;
+        }
+    }
+    return true;
+}
+
+/* Returns true if \a localDate is an exception date or a date of an exception rule.  The dates
+ * given must never decrease, since the exception rules are only ever advanced. */
+bool QOrganizerItemOccurrenceIteratorPrivate::isExcluded(const QDate &localDate)
+{
+    if (m_exceptionDates.contains(localDate))
+        return true;
+    for (int i = 0; i < m_exceptionRules.size(); ++i) {
+        QOrganizerRecurrenceRuleIterator &xrule = m_exceptionRules[i];
+        while (xrule.hasNext() && xrule.peekNext().toLocalTime().date() < localDate)
+            xrule.next();
+        if (xrule.hasNext() && xrule.peekNext().toLocalTime().date() == localDate)
+            return true;
+    }
+    return false;
+}
+
+QT_END_NAMESPACE_ORGANIZER
@@ -0,0 +1,278 @@
+/****************************************************************************
+**
+** Copyright (C) 2017 The Qt Company Ltd.
+** Contact: https://www.qt.io/licensing/
+**
+** This file is part of the QtOrganizer module of the Qt Toolkit.
+**
+** $QT_BEGIN_LICENSE:LGPL$
+** Commercial License Usage
+** Licensees holding valid commercial Qt licenses may use this file in
+** accordance with the commercial license agreement provided with the
+** Software or, alternatively, in accordance with the terms contained in
+** a written agreement between you and The Qt Company. For licensing terms
+** and conditions see https://www.qt.io/terms-conditions. For further
+** information use the contact form at https://www.qt.io/contact-us.
+**
+** GNU Lesser General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU Lesser
+** General Public License version 3 as published by the Free Software
+** Foundation and appearing in the file LICENSE.LGPL3 included in the
+** packaging of this file. Please review the following information to
+** ensure the GNU Lesser General Public License version 3 requirements
+** will be met: https://www.gnu.org/licenses/lgpl-3.0.html.
+**
+** GNU General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU
+** General Public License version 2.0 or (at your option) the GNU General
+** Public license version 3 or any later version approved by the KDE Free
+** Qt Foundation. The licenses are as published by the Free Software
+** Foundation and appearing in the file LICENSE.GPL2 and LICENSE.GPL3
+** included in the packaging of this file. Please review the following
+** information to ensure the GNU General Public License requirements will
+** be met: https://www.gnu.org/licenses/gpl-2.0.html and
+** https://www.gnu.org/licenses/gpl-3.0.html.
+**
+** $QT_END_LICENSE$
+**
+****************************************************************************/
+
+#ifndef QORGANIZERITEMOCCURRENCEITERATOR_P_H
+#define QORGANIZERITEMOCCURRENCEITERATOR_P_H
+
+//
+//  W A R N I N G
+//  -------------
+//
+// This file is not part of the Qt API.  It exists purely as an
+// implementation detail.  This header file may change from version to
+// version without notice, or even be removed.
+//
+// We mean it.
+//
+
+#include <algorithm>
+
+#include <QtCore/qdatetime.h>
+#include <QtCore/qlist.h>
+#include <QtCore/qmap.h>
+#include <QtCore/qset.h>
+#include <QtCore/qvector.h>
+
+#include <QtOrganizer/qorganizeritem.h>
+#include <QtOrganizer/qorganizerrecurrencerule.h>
+
+QT_BEGIN_NAMESPACE_ORGANIZER
+
+/*
+    The date criteria of a recurrence rule (its months, weeks and days of the year, days of the
+    month and days of the week), compiled once for every period of an expansion.
+
+    The dates of a period which match the criteria are computed from the most selective criterion
+    given (the days of the year, then the days of the month, the weeks of the year and the days
+    of the week), by date arithmetic, and only those candidates are tested against the others.
+    The result is the same as testing every day of the period, but costs time in proportion to
+    the candidates rather than to the length of the period.
+ */
+class QOrganizerRecurrenceDateMatcher
+{
+    QVector<int> m_daysOfYear;  // sorted; each criterion is empty if the rule does not restrict it
+    QVector<int> m_daysOfMonth; // sorted
+    QVector<int> m_weeksOfYear; // sorted
+    QVector<int> m_daysOfWeek;  // sorted, from Qt::Monday
+    uint m_months;              // bit n is set for month n, or 0 if the rule does not restrict the month
+
+    static QVector<int> sorted(const QSet<int> &values)
+    {
+        QVector<int> retn;
+        retn.reserve(values.size());
+        foreach (int value, values)
+            retn.append(value);
+        std::sort(retn.begin(), retn.end());
+        return retn;
+    }
+
+    static bool contains(const QVector<int> &values, int value)
+    {
+        return values.isEmpty() || std::binary_search(values.constBegin(), values.constEnd(), value);
+    }
+
+    bool monthMatches(int month) const
+    {
+        return m_months == 0 || (m_months & (1u << month));
+    }
+
+    bool matches(const QDate &date) const
+    {
+        return monthMatches(date.month())
+                && contains(m_weeksOfYear, date.weekNumber())
+                && contains(m_daysOfYear, date.dayOfYear())
+                && contains(m_daysOfMonth, date.day())
+                && contains(m_daysOfWeek, date.dayOfWeek());
+    }
+
+    /* Appends to \a dates the candidate \a date if it is within the period and matches */
+    void addCandidate(const QDate &date, const QDate &periodStart, const QDate &periodEnd, QList<QDate> *dates) const
+    {
+        if (date >= periodStart && date <= periodEnd && matches(date))
+            dates->append(date);
+    }
+
+public:
+    explicit QOrganizerRecurrenceDateMatcher(const QOrganizerRecurrenceRule &rrule)
+        : m_daysOfYear(sorted(rrule.daysOfYear())),
+          m_daysOfMonth(sorted(rrule.daysOfMonth())),
+          m_weeksOfYear(sorted(rrule.weeksOfYear())),
+          m_months(0)
+    {
+        foreach (Qt::DayOfWeek day, rrule.daysOfWeek())
+            m_daysOfWeek.append(day);
+        std::sort(m_daysOfWeek.begin(), m_daysOfWeek.end());
+        foreach (QOrganizerRecurrenceRule::Month month, rrule.monthsOfYear())
+            m_months |= 1u << month;
+    }
+
+    /* Returns the dates from \a periodStart to \a periodEnd (inclusive) which match, in order */
+    QList<QDate> dates(const QDate &periodStart, const QDate &periodEnd) const
+    {
+        QList<QDate> retn;
+        if (!periodStart.isValid() || !periodEnd.isValid() || periodStart > periodEnd)
+            return retn;
+
+        if (!m_daysOfYear.isEmpty()) {
+            for (int year = periodStart.year(); year <= periodEnd.year(); ++year) {
+                const QDate firstDate(year, 1, 1);
+                if (!firstDate.isValid())
+                    continue; // there is no year 0
+                foreach (int day, m_daysOfYear) {
+                    if (day >= 1 && day <= firstDate.daysInYear())
+                        addCandidate(firstDate.addDays(day - 1), periodStart, periodEnd, &retn);
+                }
+            }
+        } else if (!m_daysOfMonth.isEmpty() || (m_weeksOfYear.isEmpty() && !m_daysOfWeek.isEmpty())) {
+            QDate month(periodStart.year(), periodStart.month(), 1);
+            for ( ; month.isValid() && month <= periodEnd; month = month.addMonths(1)) {
+                if (!monthMatches(month.month()))
+                    continue;
+                if (!m_daysOfMonth.isEmpty()) {
+                    foreach (int day, m_daysOfMonth) {
+                        if (day >= 1 && day <= month.daysInMonth())
+                            addCandidate(QDate(month.year(), month.month(), day), periodStart, periodEnd, &retn);
+                    }
+                } else {
+                    // every given day of the week, a week apart, from the start of the month or period
+                    const QDate firstDate = qMax(month, periodStart);
+                    const int firstCandidate = retn.size();
+                    foreach (int dayOfWeek, m_daysOfWeek) {
+                        QDate date = firstDate.addDays((dayOfWeek - firstDate.dayOfWeek() + 7) % 7);
+                        for ( ; date.month() == month.month() && date <= periodEnd; date = date.addDays(7))
+                            addCandidate(date, periodStart, periodEnd, &retn);
+                    }
+                    std::sort(retn.begin() + firstCandidate, retn.end());
+                }
+            }
+        } else if (!m_weeksOfYear.isEmpty()) {
+            // a date's week number may belong to the year before or after its own
+            for (int year = periodStart.year() - 1; year <= periodEnd.year() + 1; ++year) {
+                const QDate fourthOfJanuary(year, 1, 4); // always in the first week of its year
+                if (!fourthOfJanuary.isValid())
+                    continue;
+                const QDate firstMonday = fourthOfJanuary.addDays(Qt::Monday - fourthOfJanuary.dayOfWeek());
+                const int weekCount = QDate(year, 12, 28).weekNumber(); // always in the last week of its year
+                foreach (int week, m_weeksOfYear) {
+                    if (week < 1 || week > weekCount)
+                        continue;
+                    const QDate monday = firstMonday.addDays(7 * (week - 1));
+                    if (monday > periodEnd || monday.addDays(6) < periodStart)
+                        continue;
+                    if (m_daysOfWeek.isEmpty()) {
+                        for (int day = 0; day < 7; ++day)
+                            addCandidate(monday.addDays(day), periodStart, periodEnd, &retn);
+                    } else {
+                        foreach (int dayOfWeek, m_daysOfWeek)
+                            addCandidate(monday.addDays(dayOfWeek - Qt::Monday), periodStart, periodEnd, &retn);
+                    }
+                }
+            }
+        } else {
+            // at most the months are given, so every day of a matching month matches
+            for (QDate date = periodStart; date.isValid() && date <= periodEnd; date = date.addDays(1)) {
+                if (monthMatches(date.month())) {
+                    retn.append(date);
+                } else {
+                    date = QDate(date.year(), date.month(), date.daysInMonth()); // skip the rest of the month
+                }
+            }
+        }
+        return retn;
+    }
+};
+
+/*
+    The start times generated by a single recurrence rule, from a given start time onwards and in
+    time order, as QOrganizerManagerEngine::generateDateTimes() would return them for a period
+    starting then.  The periods of the rule are expanded one at a time, as the times are taken, so
+    the cost of taking the first N times does not depend on how far into the series they are (with
+    the exception of count-limited rules, which are counted from their initial date).
+ */
+class QOrganizerRecurrenceRuleIterator
+{
+public:
+    QOrganizerRecurrenceRuleIterator(const QDateTime &initialDateTime, const QOrganizerRecurrenceRule &rrule,
+                                     const QDateTime &startDateTime);
+
+    bool hasNext();
+    QDateTime peekNext();
+    QDateTime next();
+
+private:
+    bool expandNextPeriod();
+
+    QOrganizerRecurrenceRule m_rule; // with the missing criteria inferred
+    QOrganizerRecurrenceDateMatcher m_matcher;
+    QDateTime m_localInitialDateTime;
+    QDateTime m_localStartDateTime;
+    QDate m_nextDate;                // a date in the next period to expand
+    QDate m_giveUpDate;              // if nothing has matched by this date, nothing ever will
+    int m_countLimitDates;
+    bool m_finished;
+    QList<QDateTime> m_pending;      // the times of the last period expanded not taken yet, in UTC
+};
+
+/*
+    The occurrences of a recurring item from a given start time onwards, in time order: those
+    generated from its recurrence dates and rules, less its exception dates and rules, merged with
+    the given persisted exceptions, which are returned at their own times.
+ */
+class Q_ORGANIZER_EXPORT QOrganizerItemOccurrenceIteratorPrivate
+{
+public:
+    QOrganizerItemOccurrenceIteratorPrivate(const QOrganizerItem &parentItem, const QDateTime &startDateTime,
+                                            const QList<QOrganizerItem> &exceptions);
+
+    bool hasNext();
+    QDateTime nextDateTime();
+    QOrganizerItem next();
+
+    static QDateTime initialDateTime(const QOrganizerItem &parentItem);
+
+private:
+    bool findNextDateTime();
+    bool isExcluded(const QDate &localDate);
+    bool exceptionIsNext() const;
+
+    QOrganizerItem m_parentItem;
+    QList<QDateTime> m_recurrenceDates;                  // sorted, in UTC
+    QList<QOrganizerRecurrenceRuleIterator> m_recurrenceRules;
+    QList<QOrganizerRecurrenceRuleIterator> m_exceptionRules;
+    QSet<QDate> m_exceptionDates;
+    QMultiMap<QDateTime, QOrganizerItem> m_exceptions;  // the persisted exceptions not taken yet
+    QDateTime m_nextDateTime;                            // the next generated time, if already found
+    QDateTime m_lastDateTime;                            // the last time generated, to skip duplicates
+    int m_cycleYears;                                    // the years after which all the rules repeat
+    QDate m_giveUpDate;
+};
+
+QT_END_NAMESPACE_ORGANIZER
+
+#endif // QORGANIZERITEMOCCURRENCEITERATOR_P_H
@@ -40,6 +40,8 @@
 #include "qorganizermanager.h"
 #include "qorganizermanager_p.h"
 
+#include "qorganizeritemchangeset.h"
+
 QT_BEGIN_NAMESPACE_ORGANIZER
 
 /*!
@@ -379,6 +381,30 @@ QList<QOrganizerItem> QOrganizerManager::itemOccurrences(const QOrganizerItem &p
     return d->m_engine->itemOccurrences(parentItem, startDateTime, endDateTime, maxCount, fetchHint, &h.error);
 }
 
+/*!
+    Returns an iterator over the occurrences of the given \a parentItem recurring item which occur
+    at or after the given \a startDateTime, in time order.
+
+    A default-constructed (invalid) \a startDateTime specifies the start of the series. Unlike
+    itemOccurrences(), no end date time or maximum count needs to be given: each occurrence is
+    generated only when it is taken from the iterator, so the next few occurrences after a date
+    time can be fetched without generating any others, and a series which never ends can be
+    followed as far as required.
+
+    The \a fetchHint allows clients to specify which pieces of information they are interested or
+    not interested in, to allow backends to optimise data retrieval if possible. Note that it is
+    simply a hint; backends can ignore the \a fetchHint and return the full items.
+
+    \sa QOrganizerItemOccurrenceIterator
+  */
+QOrganizerItemOccurrenceIterator QOrganizerManager::itemOccurrenceIterator(const QOrganizerItem &parentItem,
+                                                                         const QDateTime &startDateTime,
+                                                                         const QOrganizerItemFetchHint &fetchHint)
+{
+    QOrganizerManagerSyncOpErrorHolder h(this);
+    return d->m_engine->itemOccurrenceIterator(parentItem, startDateTime, fetchHint, &h.error);
+}
+
 /*!
     Returns a list of item IDs of persisted organizer items that match the given \a filter, sorted
     according to the given list of \a sortOrders, for any item which occurs (or has an occurrence
@@ -399,6 +425,20 @@ QList<QOrganizerItemId> QOrganizerManager::itemIds(const QDateTime &startDateTim
     return d->m_engine->itemIds(filter, startDateTime, endDateTime, sortOrders, &h.error);
 }
 
+/*!
+    Returns the number of persisted organizer items that match the given \a filter and occur (or
+    have an occurrence which occurs) in the range specified by the given \a startDateTime and
+    \a endDateTime, inclusive; this is the number of IDs itemIds() would return for them. The
+    backend may count the items without retrieving them or their IDs.
+
+    \sa QOrganizerItemCountRequest
+ */
+int QOrganizerManager::itemCount(const QDateTime &startDateTime, const QDateTime &endDateTime, const QOrganizerItemFilter &filter)
+{
+    QOrganizerManagerSyncOpErrorHolder h(this);
+    return d->m_engine->itemCount(filter, startDateTime, endDateTime, &h.error);
+}
+
 /*!
     Returns a list of a maximum of \a maxCount organizer items and occurrences that match the given
     \a filter, which occur in the range specified by the given \a startDateTime and \a endDateTime,
@@ -643,6 +683,48 @@ bool QOrganizerManager::removeItems(const QList<QOrganizerItem> *items)
     return d->m_engine->removeItems(items, &h.errorMap, &h.error);
 }
 
+/*!
+    Returns the current revision of the items stored in the manager.
+
+    The revision increases every time items are added, changed or removed, and never decreases; a
+    client which records it may later ask for the changes made since then with changesSince(). If
+    the backend does not keep revisions, zero is returned and the error will be set to
+    \c QOrganizerManager::NotSupportedError.
+
+    \sa changesSince()
+ */
+quint64 QOrganizerManager::revision() const
+{
+    QOrganizerManagerSyncOpErrorHolder h(this);
+    return d->m_engine->revision(&h.error);
+}
+
+/*!
+    Returns the items added, changed and removed since the given \a revision, as previously returned
+    by revision(). The types of the details changed in each changed item are reported as they are by
+    the itemsChanged() signal; an item added (or removed) since the revision is reported as added (or
+    removed) only.
+
+    If \a currentRevision is not null, it is set to the revision which the returned changes bring the
+    client up to, which may be passed to a later call.
+
+    If the backend no longer remembers the changes made since \a revision, an empty change set is
+    returned and the error will be set to \c QOrganizerManager::LimitReachedError; the client must
+    then fetch the items again. If the backend does not keep revisions, the error will be set to
+    \c QOrganizerManager::NotSupportedError.
+
+    \sa revision(), QOrganizerItemChangesFetchRequest
+ */
+QOrganizerItemChangeSet QOrganizerManager::changesSince(quint64 revision, quint64 *currentRevision) const
+{
+    QOrganizerManagerSyncOpErrorHolder h(this);
+    quint64 current = 0;
+    const QOrganizerItemChangeSet changes = d->m_engine->changesSince(revision, &current, &h.error);
+    if (currentRevision)
+        *currentRevision = current;
+    return changes;
+}
+
 /*!
     Returns the id of a default collection managed by this manager.
     There is always only one default collection for each backend.
@@ -51,10 +51,12 @@
 #include <QtOrganizer/qorganizeritem.h>
 #include <QtOrganizer/qorganizeritemfilter.h>
 #include <QtOrganizer/qorganizeritemfetchhint.h>
+#include <QtOrganizer/qorganizeritemoccurrenceiterator.h>
 #include <QtOrganizer/qorganizeritemsortorder.h>
 
 QT_BEGIN_NAMESPACE_ORGANIZER
 
+class QOrganizerItemChangeSet;
 class QOrganizerManagerData;
 
 class Q_ORGANIZER_EXPORT QOrganizerManager : public QObject
@@ -125,10 +127,17 @@ public:
                                     const QOrganizerItemFilter &filter = QOrganizerItemFilter(),
                                     const QList<QOrganizerItemSortOrder> &sortOrders = QList<QOrganizerItemSortOrder>());
 
+    int itemCount(const QDateTime &startDateTime = QDateTime(), const QDateTime &endDateTime = QDateTime(),
+                  const QOrganizerItemFilter &filter = QOrganizerItemFilter());
+
     QList<QOrganizerItem> itemOccurrences(const QOrganizerItem &parentItem, const QDateTime &startDateTime = QDateTime(),
                                           const QDateTime &endDateTime = QDateTime(), int maxCount = -1,
                                           const QOrganizerItemFetchHint &fetchHint = QOrganizerItemFetchHint());
 
+    QOrganizerItemOccurrenceIterator itemOccurrenceIterator(const QOrganizerItem &parentItem,
+                                                            const QDateTime &startDateTime = QDateTime(),
+                                                            const QOrganizerItemFetchHint &fetchHint = QOrganizerItemFetchHint());
+
     QList<QOrganizerItem> itemsForExport(const QDateTime &startDateTime = QDateTime(), const QDateTime &endDateTime = QDateTime(),
                                          const QOrganizerItemFilter &filter = QOrganizerItemFilter(),
                                          const QList<QOrganizerItemSortOrder> &sortOrders = QList<QOrganizerItemSortOrder>(),
@@ -147,6 +156,10 @@ public:
 
     bool removeItems(const QList<QOrganizerItem> *items);
 
+    // revisions, for synchronization
+    quint64 revision() const;
+    QOrganizerItemChangeSet changesSince(quint64 revision, quint64 *currentRevision = nullptr) const;
+
     // collections
     QOrganizerCollectionId defaultCollectionId() const;
     QOrganizerCollection collection(const QOrganizerCollectionId& collectionId);
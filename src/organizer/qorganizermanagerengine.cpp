@@ -41,10 +41,20 @@
 #include "qorganizeritems.h"
 #include "qorganizeritemdetails.h"
 #include "qorganizeritemfilters.h"
+#include "qorganizeritemchangeset.h"
 #include "qorganizeritemrequests.h"
 #include "qorganizeritemrequests_p.h"
+#include "qorganizeritemdetail_p.h"
+#include "qorganizeritemidfilter_p.h"
+#include "qorganizeritemintersectionfilter_p.h"
+#include "qorganizeritemunionfilter_p.h"
+#include "qorganizeritemoccurrenceiterator_p.h"
+
+#include <algorithm>
 
 #include <QtCore/qmutex.h>
+#include <QtCore/qvarlengtharray.h>
+#include <QtCore/qvector.h>
 
 QT_BEGIN_NAMESPACE_ORGANIZER
 
@@ -288,6 +298,34 @@ QList<QOrganizerItem> QOrganizerManagerEngine::itemOccurrences(const QOrganizerI
     return QList<QOrganizerItem>();
 }
 
+/*!
+    This function should be reimplemented to support synchronous calls to iterate over the
+    occurrences of the given parent item.
+
+    This function is supposed to return an iterator over the occurrences of the given \a parentItem
+    recurring item which occur at or after the given \a startDateTime, in time order, generating
+    each of them only when it is taken. A default-constructed (invalid) \a startDateTime specifies
+    the start of the series. Any error which occurs should be saved in \a error.
+
+    Engines which generate the occurrences themselves can return the iterator created by
+    createOccurrenceIterator() for the parent item and its persisted exceptions.
+
+    It's up to the backend to decide if fetch hint is supported. If supported, only the details
+    defined by \a fetchHint will be fetched.
+  */
+QOrganizerItemOccurrenceIterator QOrganizerManagerEngine::itemOccurrenceIterator(const QOrganizerItem &parentItem,
+                                                                                 const QDateTime &startDateTime,
+                                                                                 const QOrganizerItemFetchHint &fetchHint,
+                                                                                 QOrganizerManager::Error *error)
+{
+    Q_UNUSED(parentItem);
+    Q_UNUSED(startDateTime);
+    Q_UNUSED(fetchHint);
+
+    *error = QOrganizerManager::NotSupportedError;
+    return QOrganizerItemOccurrenceIterator();
+}
+
 /*!
     This function should be reimplemented to support synchronous calls to fetch organizer item IDs.
 
@@ -319,6 +357,22 @@ QList<QOrganizerItemId> QOrganizerManagerEngine::itemIds(const QOrganizerItemFil
     return QList<QOrganizerItemId>();
 }
 
+/*!
+    This function should be reimplemented to support synchronous calls to count organizer items.
+
+    This function is supposed to return the number of persisted organizer items that match the given
+    \a filter and occur (or have an occurrence which occurs) in the range specified by the given
+    \a startDateTime and \a endDateTime, inclusive, which must be the number of IDs itemIds() would
+    return for them. Any error which occurs should be saved in \a error.
+
+    The default implementation counts the IDs returned by itemIds().
+ */
+int QOrganizerManagerEngine::itemCount(const QOrganizerItemFilter &filter, const QDateTime &startDateTime,
+                                       const QDateTime &endDateTime, QOrganizerManager::Error *error)
+{
+    return itemIds(filter, startDateTime, endDateTime, QList<QOrganizerItemSortOrder>(), error).count();
+}
+
 /*!
     This function should be reimplemented to support synchronous calls to fetch organizer items.
 
@@ -524,6 +578,36 @@ bool QOrganizerManagerEngine::removeItems(const QList<QOrganizerItem> *items, QM
     return false;
 }
 
+/*!
+    This function should be reimplemented to support synchronous calls to fetch the current revision
+    of the items stored in the backend, which must increase every time items are added, changed or
+    removed. Any errors encountered during this operation should be stored to \a error.
+
+    \sa QOrganizerManager::revision()
+ */
+quint64 QOrganizerManagerEngine::revision(QOrganizerManager::Error *error) const
+{
+    *error = QOrganizerManager::NotSupportedError;
+    return 0;
+}
+
+/*!
+    This function should be reimplemented to support synchronous calls to fetch the items added,
+    changed and removed since the given \a revision, setting \a currentRevision to the revision which
+    those changes bring the caller up to. If the backend no longer knows the changes made since
+    \a revision, \a error should be set to \c QOrganizerManager::LimitReachedError.
+
+    \sa QOrganizerManager::changesSince()
+ */
+QOrganizerItemChangeSet QOrganizerManagerEngine::changesSince(quint64 revision, quint64 *currentRevision, QOrganizerManager::Error *error) const
+{
+    Q_UNUSED(revision)
+
+    *currentRevision = 0;
+    *error = QOrganizerManager::NotSupportedError;
+    return QOrganizerItemChangeSet();
+}
+
 
 /*!
     This function should be reimplemented to support synchronous calls to fetch the default collection id.
@@ -597,6 +681,93 @@ bool QOrganizerManagerEngine::removeCollection(const QOrganizerCollectionId& col
     return false;
 }
 
+/* Returns the estimated cost of testing an item against the given filter, relative to that of
+   looking up a hashed id.  Intersections and unions cost the sum of their terms. */
+static int estimatedCost(const QOrganizerItemFilter &filter)
+{
+    switch (filter.type()) {
+    case QOrganizerItemFilter::InvalidFilter:
+    case QOrganizerItemFilter::DefaultFilter:
+        return 0;
+
+    case QOrganizerItemFilter::IdFilter:
+    case QOrganizerItemFilter::CollectionFilter:
+        return 1;
+
+    case QOrganizerItemFilter::DetailFilter:
+        return 5;
+
+    case QOrganizerItemFilter::DetailFieldFilter:
+        {
+            const QOrganizerItemDetailFieldFilter cdf(filter);
+            if (cdf.detailField() == -1)
+                return 2;
+            if (!cdf.value().isValid())
+                return 3;
+            if (cdf.matchFlags() & (QOrganizerItemFilter::MatchEndsWith | QOrganizerItemFilter::MatchStartsWith | QOrganizerItemFilter::MatchContains | QOrganizerItemFilter::MatchFixedString))
+                return 10;
+            return 5;
+        }
+
+    case QOrganizerItemFilter::DetailRangeFilter:
+        return (QOrganizerItemDetailRangeFilter(filter).matchFlags() & QOrganizerItemFilter::MatchFixedString) ? 12 : 6;
+
+    case QOrganizerItemFilter::IntersectionFilter:
+    case QOrganizerItemFilter::UnionFilter:
+        {
+            const QList<QOrganizerItemFilter> terms = filter.type() == QOrganizerItemFilter::IntersectionFilter
+                    ? QOrganizerItemIntersectionFilter(filter).filters() : QOrganizerItemUnionFilter(filter).filters();
+            int cost = 0;
+            foreach (const QOrganizerItemFilter &term, terms)
+                cost += estimatedCost(term);
+            return cost;
+        }
+    }
+    return 0;
+}
+
+/* Filters costing at least this much are tested after the cheaper terms of a compound filter */
+static const int ExpensiveFilterCost = 10;
+
+/* Returns the order in which testFilter() tests the given terms of an intersection or union: the
+   cheap terms first, and then the expensive ones, each in their given order.  The order is worked
+   out the first time, and then kept in \a cached by the filter. */
+static const QVector<int> &termOrder(const QList<QOrganizerItemFilter> &terms, const QOrganizerItemFilterTermOrder &cached)
+{
+    const QVector<int> *order = cached.order();
+    if (!order) {
+        QVector<int> *computed = new QVector<int>;
+        computed->reserve(terms.count());
+        QVarLengthArray<int, 8> expensiveTerms;
+        for (int j = 0; j < terms.count(); j++) {
+            if (estimatedCost(terms.at(j)) >= ExpensiveFilterCost)
+                expensiveTerms.append(j);
+            else
+                computed->append(j);
+        }
+        for (int j = 0; j < expensiveTerms.count(); j++)
+            computed->append(expensiveTerms.at(j));
+        order = cached.setOrder(computed);
+    }
+    return *order;
+}
+
+/* Returns the given terms of an intersection or union, cheapest first */
+static QList<QOrganizerItemFilter> orderedByCost(const QList<QOrganizerItemFilter> &filters)
+{
+    QVector<QPair<int, int> > costs; // estimated cost and position of each term
+    costs.reserve(filters.count());
+    for (int i = 0; i < filters.count(); i++)
+        costs.append(qMakePair(estimatedCost(filters.at(i)), i));
+    std::sort(costs.begin(), costs.end());
+
+    QList<QOrganizerItemFilter> ordered;
+    ordered.reserve(filters.count());
+    for (int i = 0; i < costs.count(); i++)
+        ordered.append(filters.at(costs.at(i).second));
+    return ordered;
+}
+
 /*!
   Given an input \a filter, returns the canonical version of the filter.
 
@@ -614,6 +785,9 @@ bool QOrganizerManagerEngine::removeCollection(const QOrganizerCollectionId& col
    \li An intersection or union filter with a single entry will be replaced by that entry
    \li A QOrganizerItemDetailFieldFilter or QOrganizerItemDetailRangeFilter with no definition name will be replaced with a QOrganizerItemInvalidFilter
    \li A QOrganizerItemDetailRangeFilter with no range specified will be converted to a QOrganizerItemDetailFieldFilter
+   \li The terms of intersection and union filters will be ordered so that the cheapest
+     tests (such as id, collection and presence tests) come before the most expensive ones
+     (such as string comparisons); terms of equal cost keep their order
   \endlist
 */
 QOrganizerItemFilter QOrganizerManagerEngine::canonicalizedFilter(const QOrganizerItemFilter &filter)
@@ -643,7 +817,7 @@ QOrganizerItemFilter QOrganizerManagerEngine::canonicalizedFilter(const QOrganiz
             if (filters.count() == 1)
                 return filters.first();
 
-            f.setFilters(filters);
+            f.setFilters(orderedByCost(filters));
             return f;
         }
         // unreachable
@@ -672,7 +846,7 @@ QOrganizerItemFilter QOrganizerManagerEngine::canonicalizedFilter(const QOrganiz
             if (filters.count() == 1)
                 return filters.first();
 
-            f.setFilters(filters);
+            f.setFilters(orderedByCost(filters));
             return f;
         }
         // unreachable
@@ -795,8 +969,9 @@ bool QOrganizerManagerEngine::testFilter(const QOrganizerItemFilter &filter, con
 
         case QOrganizerItemFilter::IdFilter:
             {
-                const QOrganizerItemIdFilter idf(filter);
-                if (idf.ids().contains(item.id()))
+                // the filter's ids are hashed on first use, and the hash is shared by its copies
+                const QOrganizerItemIdFilterPrivate *idf = static_cast<const QOrganizerItemIdFilterPrivate *>(QOrganizerItemFilterPrivate::extract_d(filter).constData());
+                if (idf->containsId(item.id()))
                     return true;
             }
             // Fall through to end
@@ -849,7 +1024,7 @@ bool QOrganizerManagerEngine::testFilter(const QOrganizerItemFilter &filter, con
                         const QOrganizerItemDetail& detail = details.at(j);
 
                         /* Check that the field is present and has a non-empty value */
-                        if (detail.values().contains(cdf.detailField()) && !detail.value(cdf.detailField()).isNull())
+                        if (detail.hasValue(cdf.detailField()) && !detail.value(cdf.detailField()).isNull())
                             return true;
                     }
                     return false;
@@ -865,11 +1040,11 @@ bool QOrganizerManagerEngine::testFilter(const QOrganizerItemFilter &filter, con
                     bool matchEnds = (cdf.matchFlags() & 7) == QOrganizerItemFilter::MatchEndsWith;
                     bool matchContains = (cdf.matchFlags() & 7) == QOrganizerItemFilter::MatchContains;
 
+                    const QString needle = cdf.value().toString();
+
                     /* Value equality test */
                     for(int j=0; j < details.count(); j++) {
-                        const QOrganizerItemDetail& detail = details.at(j);
-                        const QString& var = detail.value(cdf.detailField()).toString();
-                        const QString& needle = cdf.value().toString();
+                        const QString var = QOrganizerItemDetailPrivate::get(details.at(j))->stringValue(cdf.detailField());
                         if (matchStarts && var.startsWith(needle, cs))
                             return true;
                         if (matchEnds && var.endsWith(needle, cs))
@@ -913,7 +1088,7 @@ bool QOrganizerManagerEngine::testFilter(const QOrganizerItemFilter &filter, con
                 if (!cdf.minValue().isValid() && !cdf.maxValue().isValid()) {
                     for(int j=0; j < details.count(); j++) {
                         const QOrganizerItemDetail& detail = details.at(j);
-                        if (detail.values().contains(cdf.detailField()))
+                        if (detail.hasValue(cdf.detailField()))
                             return true;
                     }
                     return false;
@@ -947,8 +1122,7 @@ bool QOrganizerManagerEngine::testFilter(const QOrganizerItemFilter &filter, con
 
                     /* Starts with is the normal compare case, endsWith is a bit trickier */
                     for(int j=0; j < details.count(); j++) {
-                        const QOrganizerItemDetail& detail = details.at(j);
-                        const QString& var = detail.value(cdf.detailField()).toString();
+                        const QString var = QOrganizerItemDetailPrivate::get(details.at(j))->stringValue(cdf.detailField());
                         if (!matchEnds) {
                             // MatchStarts or MatchFixedString
                             if (testMin && QString::compare(var, minVal, cs) < minComp)
@@ -986,14 +1160,14 @@ bool QOrganizerManagerEngine::testFilter(const QOrganizerItemFilter &filter, con
 
         case QOrganizerItemFilter::IntersectionFilter:
             {
-                /* XXX In theory we could reorder the terms to put the native tests first */
-                const QOrganizerItemIntersectionFilter bf(filter);
-                const QList<QOrganizerItemFilter>& terms = bf.filters();
+                /* Test the cheap terms first, since any of them may decide the result */
+                const QOrganizerItemIntersectionFilterPrivate *bf = static_cast<const QOrganizerItemIntersectionFilterPrivate *>(QOrganizerItemFilterPrivate::extract_d(filter).constData());
+                const QList<QOrganizerItemFilter>& terms = bf->m_filters;
                 if (terms.count() > 0) {
-                    for(int j = 0; j < terms.count(); j++) {
-                        if (!testFilter(terms.at(j), item)) {
+                    const QVector<int> &order = termOrder(terms, bf->m_termOrder);
+                    for (int j = 0; j < order.count(); j++) {
+                        if (!testFilter(terms.at(order.at(j)), item))
                             return false;
-                        }
                     }
                     return true;
                 }
@@ -1003,14 +1177,14 @@ bool QOrganizerManagerEngine::testFilter(const QOrganizerItemFilter &filter, con
 
         case QOrganizerItemFilter::UnionFilter:
             {
-                /* XXX In theory we could reorder the terms to put the native tests first */
-                const QOrganizerItemUnionFilter bf(filter);
-                const QList<QOrganizerItemFilter>& terms = bf.filters();
+                /* Test the cheap terms first, since any of them may decide the result */
+                const QOrganizerItemUnionFilterPrivate *bf = static_cast<const QOrganizerItemUnionFilterPrivate *>(QOrganizerItemFilterPrivate::extract_d(filter).constData());
+                const QList<QOrganizerItemFilter>& terms = bf->m_filters;
                 if (terms.count() > 0) {
-                    for(int j = 0; j < terms.count(); j++) {
-                        if (testFilter(terms.at(j), item)) {
+                    const QVector<int> &order = termOrder(terms, bf->m_termOrder);
+                    for (int j = 0; j < order.count(); j++) {
+                        if (testFilter(terms.at(order.at(j)), item))
                             return true;
-                        }
                     }
                     return false;
                 }
@@ -1047,13 +1221,13 @@ bool QOrganizerManagerEngine::isItemBetweenDates(const QOrganizerItem& item, con
     QDateTime itemDateEnd;
 
     if (item.type() == QOrganizerItemType::TypeEvent || item.type() == QOrganizerItemType::TypeEventOccurrence) {
-        QOrganizerEventTime etr = item.detail(QOrganizerItemDetail::TypeEventTime);
-        itemDateStart = etr.startDateTime();
-        itemDateEnd = etr.endDateTime();
+        const QOrganizerItemDetail etr = item.detail(QOrganizerItemDetail::TypeEventTime);
+        itemDateStart = QOrganizerItemDetailPrivate::get(etr)->dateTimeValue(QOrganizerEventTime::FieldStartDateTime);
+        itemDateEnd = QOrganizerItemDetailPrivate::get(etr)->dateTimeValue(QOrganizerEventTime::FieldEndDateTime);
     } else if (item.type() == QOrganizerItemType::TypeTodo || item.type() == QOrganizerItemType::TypeTodoOccurrence) {
-        QOrganizerTodoTime ttr = item.detail(QOrganizerItemDetail::TypeTodoTime);
-        itemDateStart = ttr.startDateTime();
-        itemDateEnd = ttr.dueDateTime();
+        const QOrganizerItemDetail ttr = item.detail(QOrganizerItemDetail::TypeTodoTime);
+        itemDateStart = QOrganizerItemDetailPrivate::get(ttr)->dateTimeValue(QOrganizerTodoTime::FieldStartDateTime);
+        itemDateEnd = QOrganizerItemDetailPrivate::get(ttr)->dateTimeValue(QOrganizerTodoTime::FieldDueDateTime);
     } else if (item.type() == QOrganizerItemType::TypeJournal) {
         QOrganizerJournal journal = item;
         itemDateStart = itemDateEnd = journal.dateTime();
@@ -1126,7 +1300,8 @@ QDateTime getDateForSorting(const QOrganizerItem& item)
     }
 
     // If it's a note, this will just return null, as expected
-    return item.detail(QOrganizerItemDetail::TypeJournalTime).value(QOrganizerJournalTime::FieldEntryDateTime).toDateTime();
+    const QOrganizerItemDetail journalTime = item.detail(QOrganizerItemDetail::TypeJournalTime);
+    return QOrganizerItemDetailPrivate::get(journalTime)->dateTimeValue(QOrganizerJournalTime::FieldEntryDateTime);
 }
 
 /*!
@@ -1231,6 +1406,133 @@ public:
     { return QOrganizerManagerEngine::compareItem(a, b, m_sortOrders) < 0; }
 };
 
+/*!
+    \internal
+    The value of one sort order for one item, extracted once per sort so that comparisons do not
+    need to look up details or build variants.
+*/
+struct OrganizerItemSortField
+{
+    OrganizerItemSortField() : detailCount(0), isString(false) {}
+
+    QVariant value;     // invalid if the field is blank or missing
+    QString string;     // the string value, case folded for case insensitive sort orders
+    int detailCount;    // number of details of the sort order's type
+    bool isString;
+};
+
+/*!
+    \internal
+    The sort keys of a list of items: one field per item and sort order, stored contiguously.
+    String values are case folded once, so they can be compared with a plain ordinal comparison.
+*/
+class OrganizerItemSortKeys
+{
+    QList<QOrganizerItemSortOrder> m_sortOrders;
+    QVector<OrganizerItemSortField> m_fields;
+
+public:
+    OrganizerItemSortKeys(const QList<QOrganizerItem> &items, const QList<QOrganizerItemSortOrder> &sortOrders)
+    {
+        foreach (const QOrganizerItemSortOrder &sortOrder, sortOrders) {
+            if (!sortOrder.isValid())
+                break;
+            m_sortOrders.append(sortOrder);
+        }
+
+        const int orderCount = m_sortOrders.size();
+        m_fields.resize(items.size() * orderCount);
+        for (int i = 0; i < items.size(); ++i) {
+            for (int j = 0; j < orderCount; ++j) {
+                const QOrganizerItemSortOrder &sortOrder = m_sortOrders.at(j);
+                const QList<QOrganizerItemDetail> details = items.at(i).details(sortOrder.detailType());
+                OrganizerItemSortField &field = m_fields[i * orderCount + j];
+                field.detailCount = details.size();
+                if (details.isEmpty() || sortOrder.detailField() == -1)
+                    continue;
+
+                // treat empty strings as blank, like compareItem() does.
+                const QVariant value = details.first().value(sortOrder.detailField());
+                if (value.isNull() || (value.type() == QVariant::String && value.toString().isEmpty()))
+                    continue;
+
+                field.value = value;
+                if (value.type() == QVariant::String) {
+                    field.string = sortOrder.caseSensitivity() == Qt::CaseSensitive ? value.toString() : value.toString().toCaseFolded();
+                    field.isString = true;
+                }
+            }
+        }
+    }
+
+    // compares the items at positions a and b; the result matches compareItem().
+    int compare(int a, int b) const
+    {
+        const int orderCount = m_sortOrders.size();
+        for (int j = 0; j < orderCount; ++j) {
+            const QOrganizerItemSortOrder &sortOrder = m_sortOrders.at(j);
+            const OrganizerItemSortField &aField = m_fields.at(a * orderCount + j);
+            const OrganizerItemSortField &bField = m_fields.at(b * orderCount + j);
+            if (aField.detailCount == 0 && bField.detailCount == 0)
+                continue;
+
+            if (sortOrder.detailField() == -1) {
+                if (aField.detailCount == bField.detailCount)
+                    continue;
+                if (aField.detailCount == 0)
+                    return sortOrder.blankPolicy() == QOrganizerItemSortOrder::BlanksFirst ? -1 : 1;
+                if (bField.detailCount == 0)
+                    return sortOrder.blankPolicy() == QOrganizerItemSortOrder::BlanksFirst ? 1 : -1;
+                return 0;
+            }
+
+            const bool aIsNull = !aField.value.isValid();
+            const bool bIsNull = !bField.value.isValid();
+            if (aIsNull && bIsNull)
+                continue;
+            if (aIsNull)
+                return (sortOrder.blankPolicy() == QOrganizerItemSortOrder::BlanksFirst ? -1 : 1);
+            if (bIsNull)
+                return (sortOrder.blankPolicy() == QOrganizerItemSortOrder::BlanksFirst ? 1 : -1);
+
+            int comparison;
+            if (aField.isString && bField.isString)
+                comparison = aField.string.compare(bField.string, Qt::CaseSensitive);
+            else
+                comparison = QOrganizerManagerEngine::compareVariant(aField.value, bField.value, sortOrder.caseSensitivity());
+            if (sortOrder.direction() != Qt::AscendingOrder)
+                comparison = -comparison;
+            if (comparison == 0)
+                continue;
+            return comparison;
+        }
+
+        return 0;
+    }
+};
+
+/*!
+    \internal
+    A functor that orders positions in a list of items by their sort \a keys. Items which are equal
+    according to every sort order are ordered by position, so that unstable algorithms keep them
+    in their original relative order.
+*/
+class OrganizerItemPositionLessThan
+{
+    const OrganizerItemSortKeys &m_keys;
+
+public:
+    inline OrganizerItemPositionLessThan(const OrganizerItemSortKeys &keys)
+        : m_keys(keys)
+    {}
+
+    inline bool operator()(int a, int b) const
+    {
+        const int comparison = m_keys.compare(a, b);
+        return comparison != 0 ? comparison < 0 : a < b;
+    }
+};
+
 /*!
     Insert \a toAdd to the \a sorted list, according to the provided \a sortOrders. The index where \a toAdd is inserted
     is returned.
@@ -1248,6 +1550,49 @@ int QOrganizerManagerEngine::addSorted(QList<QOrganizerItem> *sorted, const QOrg
     return it - sorted->begin();
 }
 
+/*!
+    Sorts \a items in place according to the provided \a sortOrders. Items which are equal according
+    to every sort order keep their relative order.
+
+    The values the sort orders refer to are extracted from each item only once, so the cost of each
+    comparison made while sorting does not depend on the items' details.
+
+    If \a maxCount is non-negative, only the first \a maxCount items of the sorted result are kept,
+    and only those are fully ordered. This is considerably cheaper than sorting every item when
+    \a maxCount is small compared to the number of items.
+
+    The first one in the \a sortOrders list has the highest priority.
+ */
+void QOrganizerManagerEngine::sortItems(QList<QOrganizerItem> *items, const QList<QOrganizerItemSortOrder> &sortOrders, int maxCount)
+{
+    const int count = items->size();
+    if (maxCount < 0 || maxCount > count)
+        maxCount = count;
+
+    if (sortOrders.isEmpty() || !sortOrders.first().isValid() || count < 2) {
+        if (maxCount < count)
+            *items = items->mid(0, maxCount);
+        return;
+    }
+
+    const OrganizerItemSortKeys keys(*items, sortOrders);
+    QVector<int> positions(count);
+    for (int i = 0; i < count; ++i)
+        positions[i] = i;
+
+    // ties are broken by position, so an unstable sort keeps equal items in order.
+    if (maxCount == count)
+        std::sort(positions.begin(), positions.end(), OrganizerItemPositionLessThan(keys));
+    else
+        std::partial_sort(positions.begin(), positions.begin() + maxCount, positions.end(), OrganizerItemPositionLessThan(keys));
+
+    QList<QOrganizerItem> sorted;
+    sorted.reserve(maxCount);
+    for (int i = 0; i < maxCount; ++i)
+        sorted.append(items->at(positions.at(i)));
+    *items = sorted;
+}
+
 /*!
     Insert \a toAdd to the \a defaultSorted map. If \a toAdd does not have valid start or end date,
     returns false and does not insert \a toAdd to \a defaultSorted map.
@@ -1379,76 +1724,48 @@ QOrganizerItem QOrganizerManagerEngine::generateOccurrence(const QOrganizerItem
     return instanceItem;
 }
 
+/*!
+    Returns an iterator over the occurrences of the given \a parentItem which occur at or after
+    \a startDateTime, in time order: those generated from its recurrence dates and rules, less its
+    exception dates and rules, merged with the given persisted \a exceptions, each of which is
+    returned at its own start time (or, if it has none, its end or due time).
+
+    The occurrences are generated as they are taken, so taking the first few of them costs the
+    same however far into the series \a startDateTime is, and a series which never ends can be
+    followed indefinitely.
+
+    \sa itemOccurrenceIterator(), generateOccurrence()
+ */
+QOrganizerItemOccurrenceIterator QOrganizerManagerEngine::createOccurrenceIterator(const QOrganizerItem &parentItem,
+                                                                                   const QDateTime &startDateTime,
+                                                                                   const QList<QOrganizerItem> &exceptions)
+{
+    return QOrganizerItemOccurrenceIterator(new QOrganizerItemOccurrenceIteratorPrivate(parentItem, startDateTime, exceptions));
+}
+
 /*!
     Generates all start times for recurrence \a rrule during the given time period. The time period is defined by
     \a periodStart and \a periodEnd. \a initialDateTime is the start time of the event, which defines the first
-    start time for \a rrule. \a maxCount can be used to limit the amount of generated start times.
+    start time for \a rrule. \a maxCount can be used to limit the amount of generated start times; if
+    \a periodEnd is invalid, the first \a maxCount start times from \a periodStart are generated.
+
+    The start times are returned in time order.
+
+    \sa createOccurrenceIterator()
  */
 QList<QDateTime> QOrganizerManagerEngine::generateDateTimes(const QDateTime &initialDateTime, QOrganizerRecurrenceRule rrule, const QDateTime &periodStart, const QDateTime &periodEnd, int maxCount)
 {
     QList<QDateTime> retn;
     if (periodEnd.isValid() || maxCount <= 0)
         maxCount = INT_MAX; // count of returned items is unlimited
+    if (!periodEnd.isValid() && maxCount == INT_MAX)
+        return retn; // an open period without a count never ends
 
-    // Perform calculations in local time, for meaningful comparison with date values
-    const QDateTime localInitialDateTime = initialDateTime.toLocalTime();
-    const QDateTime localPeriodStart = periodStart.toLocalTime();
-    const QDateTime localPeriodEnd = periodEnd.toLocalTime();
-
-    QDateTime realPeriodEnd(localPeriodEnd);
-    if (rrule.limitType() == QOrganizerRecurrenceRule::DateLimit
-            && rrule.limitDate() < realPeriodEnd.date()) {
-        realPeriodEnd.setDate(rrule.limitDate());
-        realPeriodEnd.setTime(QTime(23,59,59,999)); // the last instant of the limit date, since it's prior to the periodEnd.
-    }
-
-    QDate nextDate;
-    if (rrule.limitType() == QOrganizerRecurrenceRule::CountLimit)
-        nextDate = localInitialDateTime.date();
-    else
-        nextDate = localPeriodStart.date();
-
-    inferMissingCriteria(&rrule, localInitialDateTime.date());
-    int countLimitDates = 0;
-    bool periodEndReached = false;
-    while (!periodEndReached && nextDate <= realPeriodEnd.date() && retn.size() < maxCount) {
-        if (rrule.limitType() == QOrganizerRecurrenceRule::CountLimit && countLimitDates >= rrule.limitCount())
-            break; // reached limit count defined in the recurrence rule
-        // Skip nextDate if it is not the right multiple of intervals away from initialDateTime.
-        if (inMultipleOfInterval(nextDate, localInitialDateTime.date(), rrule.frequency(), rrule.interval(), rrule.firstDayOfWeek())) {
-            // Calculate the inclusive start and inclusive end of nextDate's week/month/year
-            QDate subPeriodStart(firstDateInPeriod(nextDate, rrule.frequency(), rrule.firstDayOfWeek()));
-            QDate subPeriodEnd(firstDateInNextPeriod(nextDate, rrule.frequency(), rrule.firstDayOfWeek()).addDays(-1));
-            // Compute matchesInPeriod to be the set of dates in the current week/month/year that match the rrule
-            QList<QDate> matchesInPeriod(filterByPosition(
-                    matchingDates(subPeriodStart, subPeriodEnd, rrule),
-                    rrule.positions()));
-            // A final filter over the dates list before adding it to the returned list
-            foreach (const QDate &match, matchesInPeriod) {
-                nextDate = match;
-                if (match < localInitialDateTime.date())
-                    continue;
-                if (match > realPeriodEnd.date() || retn.size() >= maxCount)
-                    break;
-
-                QDateTime generatedDateTime(localInitialDateTime);
-
-                generatedDateTime.setDate(match);
-                countLimitDates++;
-                if (generatedDateTime >= localPeriodStart && generatedDateTime <= realPeriodEnd) {
-                    // Convert back to UTC for returned value
-                    retn.append(generatedDateTime.toUTC());
-                } else if (generatedDateTime > realPeriodEnd) {
-                    // We've gone past the end of the period.  Ensure we break both the foreach and
-                    // the while loop
-                    periodEndReached = true;
-                    break;
-                }
-                if (rrule.limitType() == QOrganizerRecurrenceRule::CountLimit && countLimitDates >= rrule.limitCount())
-                    break; // reached limit count defined in the recurrence rule
-            }
-        }
-        nextDate = firstDateInNextPeriod(nextDate, rrule.frequency(), rrule.firstDayOfWeek());
+    QOrganizerRecurrenceRuleIterator dateTimes(initialDateTime, rrule, periodStart);
+    while (retn.size() < maxCount && dateTimes.hasNext()) {
+        if (periodEnd.isValid() && dateTimes.peekNext() > periodEnd)
+            break;
+        retn.append(dateTimes.next());
     }
     return retn;
 }
@@ -1520,36 +1837,33 @@ void QOrganizerManagerEngine::inferMissingCriteria(QOrganizerRecurrenceRule *rru
    interval multiple of periods ahead of the calendar period of \a initialDate. For Weekly frequencies,
    \a firstDayOfWeek is used to determine when the week boundary is. eg. If \a frequency is Monthly
    and \a interval is 3, then true is returned iff \a date is in the same month as \a initialDate,
-   in a month 3 months ahead, 6 months ahead, etc.
+   in a month 3 months ahead, 6 months ahead, etc.  False is returned if the calendar period of
+   \a date is before that of \a initialDate.
  */
 bool QOrganizerManagerEngine::inMultipleOfInterval(const QDate &date, const QDate &initialDate, QOrganizerRecurrenceRule::Frequency frequency, int interval, Qt::DayOfWeek firstDayOfWeek)
 {
-    Q_ASSERT(date >= initialDate);
+    // a date in a period before that of initialDate is never a multiple of the interval ahead;
+    // the deltas are signed, so that such a date does not wrap around to a large multiple
     switch (frequency) {
         case QOrganizerRecurrenceRule::Yearly: {
-            uint yearsDelta = date.year() - initialDate.year();
-            return (yearsDelta % interval == 0);
+            int yearsDelta = date.year() - initialDate.year();
+            return (yearsDelta >= 0 && yearsDelta % interval == 0);
         }
         case QOrganizerRecurrenceRule::Monthly: {
-            uint monthsDelta = date.month() - initialDate.month() + (12 * (date.year() - initialDate.year()));
-            return (monthsDelta % interval == 0);
+            int monthsDelta = date.month() - initialDate.month() + (12 * (date.year() - initialDate.year()));
+            return (monthsDelta >= 0 && monthsDelta % interval == 0);
         }
         case QOrganizerRecurrenceRule::Weekly: {
             // we need to adjust for the week start specified by the client if the interval is greater than 1
-            // ie, every time we hit the day specified, we increment the week count.
-            uint weekCount = 0;
-            QDate tempDate = initialDate;
-            while (tempDate < date) {
-                tempDate = tempDate.addDays(1);
-                if (static_cast<Qt::DayOfWeek>(tempDate.dayOfWeek()) == firstDayOfWeek) {
-                    weekCount += 1;
-                }
-            }
-            return (weekCount % interval == 0);
+            // ie, every time we hit the day specified, we increment the week count; that is the
+            // number of whole weeks between the starts of the weeks of the two dates.
+            qint64 weekCount = firstDateInPeriod(initialDate, frequency, firstDayOfWeek).daysTo(
+                        firstDateInPeriod(date, frequency, firstDayOfWeek)) / 7;
+            return (weekCount >= 0 && weekCount % interval == 0);
         }
         case QOrganizerRecurrenceRule::Daily: {
-            uint daysDelta = initialDate.daysTo(date);
-            return (daysDelta % interval == 0);
+            qint64 daysDelta = initialDate.daysTo(date);
+            return (daysDelta >= 0 && daysDelta % interval == 0);
         }
         case QOrganizerRecurrenceRule::Invalid:
             Q_ASSERT(false);
@@ -1574,10 +1888,8 @@ QDate QOrganizerManagerEngine::firstDateInPeriod(const QDate &date, QOrganizerRe
             retn.setDate(date.year(), date.month(), 1);
             return retn;
         case QOrganizerRecurrenceRule::Weekly:
-            while (retn.dayOfWeek() != firstDayOfWeek) {
-                retn = retn.addDays(-1);
-            }
-            return retn;
+            // the days since the last firstDayOfWeek
+            return retn.addDays(-((retn.dayOfWeek() - firstDayOfWeek + 7) % 7));
         case QOrganizerRecurrenceRule::Daily:
             return retn;
         default:
@@ -1606,10 +1918,7 @@ QDate QOrganizerManagerEngine::firstDateInNextPeriod(const QDate &date, QOrganiz
             }
             return retn;
         case QOrganizerRecurrenceRule::Weekly:
-            do {
-                retn = retn.addDays(1);
-            } while (retn.dayOfWeek() != firstDayOfWeek);
-            return retn;
+            return firstDateInPeriod(date, frequency, firstDayOfWeek).addDays(7);
         case QOrganizerRecurrenceRule::Daily:
             retn = retn.addDays(1);
             return retn;
@@ -1626,26 +1935,7 @@ QDate QOrganizerManagerEngine::firstDateInNextPeriod(const QDate &date, QOrganiz
  */
 QList<QDate> QOrganizerManagerEngine::matchingDates(const QDate &periodStart, const QDate &periodEnd, const QOrganizerRecurrenceRule &rrule)
 {
-    QList<QDate> retn;
-
-    QSet<Qt::DayOfWeek> daysOfWeek = rrule.daysOfWeek();
-    QSet<int> daysOfMonth = rrule.daysOfMonth();
-    QSet<int> daysOfYear = rrule.daysOfYear();
-    QSet<int> weeksOfYear = rrule.weeksOfYear();
-    QSet<QOrganizerRecurrenceRule::Month> monthsOfYear = rrule.monthsOfYear();
-
-    QDate tempDate = periodStart;
-    while (tempDate <= periodEnd) {
-        if ((monthsOfYear.isEmpty() || monthsOfYear.contains(static_cast<QOrganizerRecurrenceRule::Month>(tempDate.month())))
-                && (weeksOfYear.isEmpty() || weeksOfYear.contains(tempDate.weekNumber()))
-                && (daysOfYear.isEmpty() || daysOfYear.contains(tempDate.dayOfYear()))
-                && (daysOfMonth.isEmpty() || daysOfMonth.contains(tempDate.day()))
-                && (daysOfWeek.isEmpty() || daysOfWeek.contains(static_cast<Qt::DayOfWeek>(tempDate.dayOfWeek())))) {
-            retn.append(tempDate);
-        }
-        tempDate = tempDate.addDays(1);
-    }
-    return retn;
+    return QOrganizerRecurrenceDateMatcher(rrule).dates(periodStart, periodEnd);
 }
 
 /*!
@@ -1843,6 +2133,89 @@ void QOrganizerManagerEngine::updateItemIdFetchRequest(QOrganizerItemIdFetchRequ
 #endif
 }
 
+/*!
+    Updates the given QOrganizerItemCountRequest \a req with the latest result \a result, and operation
+    error \a error. In addition, the state of the request will be changed to \a newState.
+
+    It then causes the request to emit its resultsAvailable() signal to notify clients of the request
+    progress.
+
+    If the new request state is different from the previous state, the stateChanged() signal will also
+    be emitted from the request.
+ */
+void QOrganizerManagerEngine::updateItemCountRequest(QOrganizerItemCountRequest *req, int result, QOrganizerManager::Error error,
+                                                     QOrganizerAbstractRequest::State newState)
+{
+    Q_ASSERT(req);
+    QOrganizerItemCountRequestPrivate* rd = static_cast<QOrganizerItemCountRequestPrivate*>(req->d_ptr);
+    QMutexLocker ml(&rd->m_mutex);
+    bool emitState = rd->m_state != newState;
+    rd->m_count = result;
+    rd->m_error = error;
+    rd->m_state = newState;
+    ml.unlock();
+#if !defined(QT_NO_DEBUG) || defined(QT_FORCE_ASSERTS)
+    QPointer<QOrganizerAbstractRequest> guard(req);
+#endif
+    Qt::ConnectionType connectionType = Qt::DirectConnection;
+#ifdef QT_NO_THREAD
+    if (req->thread() != QThread::currentThread())
+        connectionType = Qt::BlockingQueuedConnection;
+#endif
+    QMetaObject::invokeMethod(req, "resultsAvailable", connectionType);
+#if !defined(QT_NO_DEBUG) || defined(QT_FORCE_ASSERTS)
+    Q_ASSERT(guard);
+#endif
+    if (emitState)
+        QMetaObject::invokeMethod(req, "stateChanged", connectionType, Q_ARG(QOrganizerAbstractRequest::State, newState));
+#if !defined(QT_NO_DEBUG) || defined(QT_FORCE_ASSERTS)
+    Q_ASSERT(guard);
+#endif
+}
+
+/*!
+    Updates the given QOrganizerItemChangesFetchRequest \a req with the latest results \a result and
+    \a currentRevision, and operation error \a error. In addition, the state of the request will be
+    changed to \a newState.
+
+    It then causes the request to emit its resultsAvailable() signal to notify clients of the request
+    progress.
+
+    If the new request state is different from the previous state, the stateChanged() signal will also
+    be emitted from the request.
+ */
+void QOrganizerManagerEngine::updateItemChangesFetchRequest(QOrganizerItemChangesFetchRequest *req, const QOrganizerItemChangeSet &result,
+                                                            quint64 currentRevision, QOrganizerManager::Error error,
+                                                            QOrganizerAbstractRequest::State newState)
+{
+    Q_ASSERT(req);
+    QOrganizerItemChangesFetchRequestPrivate* rd = static_cast<QOrganizerItemChangesFetchRequestPrivate*>(req->d_ptr);
+    QMutexLocker ml(&rd->m_mutex);
+    bool emitState = rd->m_state != newState;
+    rd->m_changeSet = result;
+    rd->m_currentRevision = currentRevision;
+    rd->m_error = error;
+    rd->m_state = newState;
+    ml.unlock();
+#if !defined(QT_NO_DEBUG) || defined(QT_FORCE_ASSERTS)
+    QPointer<QOrganizerAbstractRequest> guard(req);
+#endif
+    Qt::ConnectionType connectionType = Qt::DirectConnection;
+#ifdef QT_NO_THREAD
+    if (req->thread() != QThread::currentThread())
+        connectionType = Qt::BlockingQueuedConnection;
+#endif
+    QMetaObject::invokeMethod(req, "resultsAvailable", connectionType);
+#if !defined(QT_NO_DEBUG) || defined(QT_FORCE_ASSERTS)
+    Q_ASSERT(guard);
+#endif
+    if (emitState)
+        QMetaObject::invokeMethod(req, "stateChanged", connectionType, Q_ARG(QOrganizerAbstractRequest::State, newState));
+#if !defined(QT_NO_DEBUG) || defined(QT_FORCE_ASSERTS)
+    Q_ASSERT(guard);
+#endif
+}
+
 /*!
     Updates the given QOrganizerItemFetchByIdRequest \a req with the latest results \a result, and
     operation error \a error, and map of input index to individual error \a errorMap. In addition,
@@ -42,6 +42,7 @@
 
 #include <QtOrganizer/qorganizermanager.h>
 #include <QtOrganizer/qorganizerabstractrequest.h>
+#include <QtOrganizer/qorganizeritemoccurrenceiterator.h>
 #include <QtOrganizer/qorganizerrecurrencerule.h>
 
 QT_BEGIN_NAMESPACE_ORGANIZER
@@ -50,6 +51,8 @@ class QOrganizerCollectionFetchRequest;
 class QOrganizerCollectionRemoveRequest;
 class QOrganizerCollectionSaveRequest;
 class QOrganizerItemIdFetchRequest;
+class QOrganizerItemChangesFetchRequest;
+class QOrganizerItemCountRequest;
 class QOrganizerItemFetchByIdRequest;
 class QOrganizerItemFetchRequest;
 class QOrganizerItemOccurrenceFetchRequest;
@@ -90,10 +93,17 @@ public:
                                             const QDateTime &endDateTime, const QList<QOrganizerItemSortOrder> &sortOrders,
                                             QOrganizerManager::Error *error);
 
+    virtual int itemCount(const QOrganizerItemFilter &filter, const QDateTime &startDateTime,
+                          const QDateTime &endDateTime, QOrganizerManager::Error *error);
+
     virtual QList<QOrganizerItem> itemOccurrences(const QOrganizerItem &parentItem, const QDateTime &startDateTime,
                                                   const QDateTime &endDateTime, int maxCount,
                                                   const QOrganizerItemFetchHint &fetchHint, QOrganizerManager::Error *error);
 
+    virtual QOrganizerItemOccurrenceIterator itemOccurrenceIterator(const QOrganizerItem &parentItem, const QDateTime &startDateTime,
+                                                                    const QOrganizerItemFetchHint &fetchHint,
+                                                                    QOrganizerManager::Error *error);
+
     virtual QList<QOrganizerItem> itemsForExport(const QDateTime &startDateTime, const QDateTime &endDateTime,
                                                  const QOrganizerItemFilter &filter,
                                                  const QList<QOrganizerItemSortOrder> &sortOrders,
@@ -107,6 +117,10 @@ public:
 
     virtual bool removeItems(const QList<QOrganizerItem> *items, QMap<int, QOrganizerManager::Error> *errorMap, QOrganizerManager::Error *error);
 
+    // revisions, for synchronization
+    virtual quint64 revision(QOrganizerManager::Error *error) const;
+    virtual QOrganizerItemChangeSet changesSince(quint64 revision, quint64 *currentRevision, QOrganizerManager::Error *error) const;
+
     // collections
     virtual QOrganizerCollectionId defaultCollectionId() const;
     virtual QOrganizerCollection collection(const QOrganizerCollectionId &collectionId, QOrganizerManager::Error *error);
@@ -128,6 +142,13 @@ public:
     static void updateItemIdFetchRequest(QOrganizerItemIdFetchRequest *request, const QList<QOrganizerItemId> &result,
                                          QOrganizerManager::Error error, QOrganizerAbstractRequest::State newState);
 
+    static void updateItemCountRequest(QOrganizerItemCountRequest *request, int result,
+                                       QOrganizerManager::Error error, QOrganizerAbstractRequest::State newState);
+
+    static void updateItemChangesFetchRequest(QOrganizerItemChangesFetchRequest *request, const QOrganizerItemChangeSet &result,
+                                              quint64 currentRevision, QOrganizerManager::Error error,
+                                              QOrganizerAbstractRequest::State newState);
+
     static void updateItemFetchByIdRequest(QOrganizerItemFetchByIdRequest *request, const QList<QOrganizerItem> &result,
                                            QOrganizerManager::Error error, const QMap<int, QOrganizerManager::Error> &errorMap,
                                            QOrganizerAbstractRequest::State);
@@ -164,6 +185,7 @@ public:
 
     // helper
     static int addSorted(QList<QOrganizerItem> *sorted, const QOrganizerItem &toAdd, const QList<QOrganizerItemSortOrder> &sortOrders);
+    static void sortItems(QList<QOrganizerItem> *items, const QList<QOrganizerItemSortOrder> &sortOrders, int maxCount = -1);
     static bool addDefaultSorted(QMultiMap<QDateTime, QOrganizerItem> *defaultSorted, const QOrganizerItem &toAdd);
     static int compareItem(const QOrganizerItem &a, const QOrganizerItem &b, const QList<QOrganizerItemSortOrder> &sortOrders);
     static int compareVariant(const QVariant &a, const QVariant &b, Qt::CaseSensitivity sensitivity);
@@ -174,6 +196,8 @@ public:
 
     // recurrence help
     static QOrganizerItem generateOccurrence(const QOrganizerItem &parentItem, const QDateTime &rdate);
+    static QOrganizerItemOccurrenceIterator createOccurrenceIterator(const QOrganizerItem &parentItem, const QDateTime &startDateTime,
+                                                                     const QList<QOrganizerItem> &exceptions);
     static QList<QDateTime> generateDateTimes(const QDateTime &initialDateTime, QOrganizerRecurrenceRule rrule, const QDateTime &periodStart, const QDateTime &periodEnd, int maxCount);
     static void inferMissingCriteria(QOrganizerRecurrenceRule *rrule, const QDate &initialDate);
     static bool inMultipleOfInterval(const QDate &date, const QDate &initialDate, QOrganizerRecurrenceRule::Frequency frequency, int interval, Qt::DayOfWeek firstDayOfWeek);
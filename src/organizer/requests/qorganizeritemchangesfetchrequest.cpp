@@ -0,0 +1,114 @@
+/****************************************************************************
+**
+** Copyright (C) 2017 The Qt Company Ltd.
+** Contact: https://www.qt.io/licensing/
+**
+** This file is part of the QtOrganizer module of the Qt Toolkit.
+**
+** $QT_BEGIN_LICENSE:LGPL$
+** Commercial License Usage
+** Licensees holding valid commercial Qt licenses may use this file in
+** accordance with the commercial license agreement provided with the
+** Software or, alternatively, in accordance with the terms contained in
+** a written agreement between you and The Qt Company. For licensing terms
+** and conditions see https://www.qt.io/terms-conditions. For further
+** information use the contact form at https://www.qt.io/contact-us.
+**
+** GNU Lesser General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU Lesser
+** General Public License version 3 as published by the Free Software
+** Foundation and appearing in the file LICENSE.LGPL3 included in the
+** packaging of this file. Please review the following information to
+** ensure the GNU Lesser General Public License version 3 requirements
+** will be met: https://www.gnu.org/licenses/lgpl-3.0.html.
+**
+** GNU General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU
+** General Public License version 2.0 or (at your option) the GNU General
+** Public license version 3 or any later version approved by the KDE Free
+** Qt Foundation. The licenses are as published by the Free Software
+** Foundation and appearing in the file LICENSE.GPL2 and LICENSE.GPL3
+** included in the packaging of this file. Please review the following
+** information to ensure the GNU General Public License requirements will
+** be met: https://www.gnu.org/licenses/gpl-2.0.html and
+** https://www.gnu.org/licenses/gpl-3.0.html.
+**
+** $QT_END_LICENSE$
+**
+****************************************************************************/
+
+#include "qorganizeritemchangesfetchrequest.h"
+
+#include "qorganizeritemrequests_p.h"
+
+QT_BEGIN_NAMESPACE_ORGANIZER
+
+/*!
+    \class QOrganizerItemChangesFetchRequest
+    \brief The QOrganizerItemChangesFetchRequest class allows a client to asynchronously fetch the
+           organizer items added, changed and removed since a revision of a backend.
+    \inmodule QtOrganizer
+    \ingroup organizer-requests
+
+    \sa QOrganizerManager::changesSince()
+ */
+
+/*!
+    Constructs a new organizer item changes fetch request whose parent is the specified \a parent.
+*/
+QOrganizerItemChangesFetchRequest::QOrganizerItemChangesFetchRequest(QObject *parent)
+    : QOrganizerAbstractRequest(new QOrganizerItemChangesFetchRequestPrivate, parent)
+{
+}
+
+/*!
+    Frees memory in use by this request.
+*/
+QOrganizerItemChangesFetchRequest::~QOrganizerItemChangesFetchRequest()
+{
+}
+
+/*!
+    Sets the revision, as returned by QOrganizerManager::revision(), since which changes will be
+    returned to \a revision.
+*/
+void QOrganizerItemChangesFetchRequest::setSinceRevision(quint64 revision)
+{
+    Q_D(QOrganizerItemChangesFetchRequest);
+    QMutexLocker ml(&d->m_mutex);
+    d->m_sinceRevision = revision;
+}
+
+/*!
+    Returns the revision since which changes will be returned.
+*/
+quint64 QOrganizerItemChangesFetchRequest::sinceRevision() const
+{
+    Q_D(const QOrganizerItemChangesFetchRequest);
+    QMutexLocker ml(&d->m_mutex);
+    return d->m_sinceRevision;
+}
+
+/*!
+    Returns the organizer items added, changed and removed since the requested revision.
+*/
+QOrganizerItemChangeSet QOrganizerItemChangesFetchRequest::changeSet() const
+{
+    Q_D(const QOrganizerItemChangesFetchRequest);
+    QMutexLocker ml(&d->m_mutex);
+    return d->m_changeSet;
+}
+
+/*!
+    Returns the revision which the changes returned by changeSet() bring the client up to.
+*/
+quint64 QOrganizerItemChangesFetchRequest::currentRevision() const
+{
+    Q_D(const QOrganizerItemChangesFetchRequest);
+    QMutexLocker ml(&d->m_mutex);
+    return d->m_currentRevision;
+}
+
+QT_END_NAMESPACE_ORGANIZER
+
+#include "moc_qorganizeritemchangesfetchrequest.cpp"
@@ -0,0 +1,149 @@
+/****************************************************************************
+**
+** Copyright (C) 2017 The Qt Company Ltd.
+** Contact: https://www.qt.io/licensing/
+**
+** This file is part of the QtOrganizer module of the Qt Toolkit.
+**
+** $QT_BEGIN_LICENSE:LGPL$
+** Commercial License Usage
+** Licensees holding valid commercial Qt licenses may use this file in
+** accordance with the commercial license agreement provided with the
+** Software or, alternatively, in accordance with the terms contained in
+** a written agreement between you and The Qt Company. For licensing terms
+** and conditions see https://www.qt.io/terms-conditions. For further
+** information use the contact form at https://www.qt.io/contact-us.
+**
+** GNU Lesser General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU Lesser
+** General Public License version 3 as published by the Free Software
+** Foundation and appearing in the file LICENSE.LGPL3 included in the
+** packaging of this file. Please review the following information to
+** ensure the GNU Lesser General Public License version 3 requirements
+** will be met: https://www.gnu.org/licenses/lgpl-3.0.html.
+**
+** GNU General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU
+** General Public License version 2.0 or (at your option) the GNU General
+** Public license version 3 or any later version approved by the KDE Free
+** Qt Foundation. The licenses are as published by the Free Software
+** Foundation and appearing in the file LICENSE.GPL2 and LICENSE.GPL3
+** included in the packaging of this file. Please review the following
+** information to ensure the GNU General Public License requirements will
+** be met: https://www.gnu.org/licenses/gpl-2.0.html and
+** https://www.gnu.org/licenses/gpl-3.0.html.
+**
+** $QT_END_LICENSE$
+**
+****************************************************************************/
+
+#include "qorganizeritemcountrequest.h"
+
+#include "qorganizeritemrequests_p.h"
+
+QT_BEGIN_NAMESPACE_ORGANIZER
+
+/*!
+    \class QOrganizerItemCountRequest
+    \brief The QOrganizerItemCountRequest class allows a client to asynchronously count the organizer
+           items in a backend which match a filter.
+    \inmodule QtOrganizer
+    \ingroup organizer-requests
+
+    \sa QOrganizerManager::itemCount()
+ */
+
+/*!
+    Constructs a new organizer item count request whose parent is the specified \a parent.
+*/
+QOrganizerItemCountRequest::QOrganizerItemCountRequest(QObject *parent)
+    : QOrganizerAbstractRequest(new QOrganizerItemCountRequestPrivate, parent)
+{
+}
+
+/*!
+    Frees memory in use by this request.
+*/
+QOrganizerItemCountRequest::~QOrganizerItemCountRequest()
+{
+}
+
+/*!
+    Sets the filter which will be used to select the organizer items which will be counted to \a filter.
+*/
+void QOrganizerItemCountRequest::setFilter(const QOrganizerItemFilter &filter)
+{
+    Q_D(QOrganizerItemCountRequest);
+    QMutexLocker ml(&d->m_mutex);
+    d->m_filter = filter;
+}
+
+/*!
+    Sets the start period of the request to \a date.
+
+    A default-constructed (invalid) start date time specifies an open start date time (matches anything
+    which occurs up until the end date time).
+*/
+void QOrganizerItemCountRequest::setStartDate(const QDateTime &date)
+{
+    Q_D(QOrganizerItemCountRequest);
+    QMutexLocker ml(&d->m_mutex);
+    d->m_startDate = date;
+}
+
+/*!
+    Sets the end period of the request to \a date.
+
+    A default-constructed (invalid) end date time specifies an open end date time (matches anything
+    which occurs after the start date time).
+*/
+void QOrganizerItemCountRequest::setEndDate(const QDateTime &date)
+{
+    Q_D(QOrganizerItemCountRequest);
+    QMutexLocker ml(&d->m_mutex);
+    d->m_endDate = date;
+}
+
+/*!
+    Returns the filter which will be used to select the organizer items which will be counted.
+*/
+QOrganizerItemFilter QOrganizerItemCountRequest::filter() const
+{
+    Q_D(const QOrganizerItemCountRequest);
+    QMutexLocker ml(&d->m_mutex);
+    return d->m_filter;
+}
+
+/*!
+    Returns the date-time which is the lower bound for the range in which items will be counted.
+ */
+QDateTime QOrganizerItemCountRequest::startDate() const
+{
+    Q_D(const QOrganizerItemCountRequest);
+    QMutexLocker ml(&d->m_mutex);
+    return d->m_startDate;
+}
+
+/*!
+    Returns the date-time which is the upper bound for the range in which items will be counted.
+ */
+QDateTime QOrganizerItemCountRequest::endDate() const
+{
+    Q_D(const QOrganizerItemCountRequest);
+    QMutexLocker ml(&d->m_mutex);
+    return d->m_endDate;
+}
+
+/*!
+    Returns the number of organizer items which matched the request.
+*/
+int QOrganizerItemCountRequest::count() const
+{
+    Q_D(const QOrganizerItemCountRequest);
+    QMutexLocker ml(&d->m_mutex);
+    return d->m_count;
+}
+
+QT_END_NAMESPACE_ORGANIZER
+
+#include "moc_qorganizeritemcountrequest.cpp"
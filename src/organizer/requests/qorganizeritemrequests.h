@@ -43,6 +43,8 @@
 #include <QtOrganizer/qorganizercollectionfetchrequest.h>
 #include <QtOrganizer/qorganizercollectionremoverequest.h>
 #include <QtOrganizer/qorganizercollectionsaverequest.h>
+#include <QtOrganizer/qorganizeritemchangesfetchrequest.h>
+#include <QtOrganizer/qorganizeritemcountrequest.h>
 #include <QtOrganizer/qorganizeritemfetchrequest.h>
 #include <QtOrganizer/qorganizeritemfetchbyidrequest.h>
 #include <QtOrganizer/qorganizeritemfetchforexportrequest.h>
@@ -59,6 +59,7 @@
 #include <QtCore/qmap.h>
 
 #include <QtOrganizer/qorganizeritem.h>
+#include <QtOrganizer/qorganizeritemchangeset.h>
 #include <QtOrganizer/qorganizeritemdetail.h>
 #include <QtOrganizer/qorganizeritemfetchhint.h>
 #include <QtOrganizer/qorganizeritemfilter.h>
@@ -395,6 +396,86 @@ public:
     QDateTime m_endDate;
 };
 
+class QOrganizerItemCountRequestPrivate : public QOrganizerAbstractRequestPrivate
+{
+public:
+    QOrganizerItemCountRequestPrivate()
+        : QOrganizerAbstractRequestPrivate(QOrganizerAbstractRequest::ItemCountRequest),
+          m_count(0)
+    {
+    }
+
+    ~QOrganizerItemCountRequestPrivate()
+    {
+    }
+
+#ifndef QT_NO_DEBUG_STREAM
+    QDebug& debugStreamOut(QDebug &dbg) const
+    {
+        dbg.nospace() << "QOrganizerItemCountRequest(\n";
+        dbg.nospace() << "* count=";
+        dbg.nospace() << m_count;
+        dbg.nospace() << ",\n";
+        dbg.nospace() << "* filter=";
+        dbg.nospace() << m_filter;
+        dbg.nospace() << ",\n";
+        dbg.nospace() << "* startDate=";
+        dbg.nospace() << m_startDate;
+        dbg.nospace() << ",\n";
+        dbg.nospace() << "* endDate=";
+        dbg.nospace() << m_endDate;
+        dbg.nospace() << "\n)";
+        return dbg.maybeSpace();
+    }
+#endif
+
+    QOrganizerItemFilter m_filter;
+
+    int m_count;
+
+    QDateTime m_startDate;
+    QDateTime m_endDate;
+};
+
+class QOrganizerItemChangesFetchRequestPrivate : public QOrganizerAbstractRequestPrivate
+{
+public:
+    QOrganizerItemChangesFetchRequestPrivate()
+        : QOrganizerAbstractRequestPrivate(QOrganizerAbstractRequest::ItemChangesFetchRequest),
+          m_sinceRevision(0), m_currentRevision(0)
+    {
+    }
+
+    ~QOrganizerItemChangesFetchRequestPrivate()
+    {
+    }
+
+#ifndef QT_NO_DEBUG_STREAM
+    QDebug& debugStreamOut(QDebug &dbg) const
+    {
+        dbg.nospace() << "QOrganizerItemChangesFetchRequest(\n";
+        dbg.nospace() << "* sinceRevision=";
+        dbg.nospace() << m_sinceRevision;
+        dbg.nospace() << ",\n";
+        dbg.nospace() << "* addedItems=";
+        dbg.nospace() << m_changeSet.addedItems();
+        dbg.nospace() << ",\n";
+        dbg.nospace() << "* removedItems=";
+        dbg.nospace() << m_changeSet.removedItems();
+        dbg.nospace() << ",\n";
+        dbg.nospace() << "* currentRevision=";
+        dbg.nospace() << m_currentRevision;
+        dbg.nospace() << "\n)";
+        return dbg.maybeSpace();
+    }
+#endif
+
+    quint64 m_sinceRevision;
+
+    QOrganizerItemChangeSet m_changeSet;
+    quint64 m_currentRevision;
+};
+
 class QOrganizerCollectionFetchRequestPrivate : public QOrganizerAbstractRequestPrivate
 {
 public:
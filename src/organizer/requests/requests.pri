@@ -12,7 +12,9 @@ PUBLIC_HEADERS += requests/qorganizeritemrequests.h \
     requests/qorganizeritemidfetchrequest.h \
     requests/qorganizeritemremoverequest.h \
     requests/qorganizeritemsaverequest.h \
-    requests/qorganizeritemremovebyidrequest.h
+    requests/qorganizeritemremovebyidrequest.h \
+    requests/qorganizeritemchangesfetchrequest.h \
+    requests/qorganizeritemcountrequest.h
 
 PRIVATE_HEADERS += requests/qorganizeritemrequests_p.h
 
@@ -27,4 +29,6 @@ SOURCES += \
     requests/qorganizeritemidfetchrequest.cpp \
     requests/qorganizeritemremoverequest.cpp \
     requests/qorganizeritemsaverequest.cpp \
-    requests/qorganizeritemremovebyidrequest.cpp
+    requests/qorganizeritemremovebyidrequest.cpp \
+    requests/qorganizeritemchangesfetchrequest.cpp \
+    requests/qorganizeritemcountrequest.cpp
@@ -5,9 +5,11 @@ PLUGIN_TYPE = contacts
 load(qt_plugin)
 
 HEADERS += \
-    qcontactmemorybackend_p.h
+    qcontactmemorybackend_p.h \
+    qcontactmemoryindex_p.h
 
 SOURCES += \
-    qcontactmemorybackend.cpp
+    qcontactmemorybackend.cpp \
+    qcontactmemoryindex.cpp
 
 OTHER_FILES += memory.json
@@ -39,16 +39,28 @@
 
 #include "qcontactmemorybackend_p.h"
 
+#include <algorithm>
+
 #ifndef QT_NO_DEBUG_STREAM
 #include <QtCore/qdebug.h>
 #endif
 #include <QtCore/qpointer.h>
+#include <QtCore/qrunnable.h>
+#include <QtCore/qsemaphore.h>
+#include <QtCore/qsharedpointer.h>
 #include <QtCore/qstringbuilder.h>
+#include <QtCore/qthreadpool.h>
 #include <QtCore/quuid.h>
 
+#include <QtContacts/qcontactchangelogfilter.h>
+#include <QtContacts/qcontactcollectionfilter.h>
+#include <QtContacts/qcontactdetailfilter.h>
 #include <QtContacts/qcontactidfilter.h>
+#include <QtContacts/qcontactintersectionfilter.h>
+#include <QtContacts/qcontactphonenumber.h>
 #include <QtContacts/qcontactrequests.h>
 #include <QtContacts/qcontacttimestamp.h>
+#include <QtContacts/qcontactunionfilter.h>
 
 QT_BEGIN_NAMESPACE_CONTACTS
 
@@ -81,6 +93,26 @@ QString QContactMemoryEngineFactory::managerName() const
   identified by the "id" parameter from the given parameters if it exists, or a new,
   anonymous store if it does not.
 
+  If the "fullTextIndex" parameter is "true", the store keeps a full-text index of the
+  string fields of its contacts, through which detail filters matching with
+  QContactFilter::MatchContains, QContactFilter::MatchStartsWith,
+  QContactFilter::MatchEndsWith or QContactFilter::MatchFixedString on those fields
+  are answered.  Once enabled, the index is kept for as long as the store exists.
+
+  If the "parallelFilterThreshold" parameter is a positive number, queries which must test
+  at least that many contacts against a filter split them into chunks, which are tested on
+  the global thread pool; the results are the same, and in the same order, as when they are
+  tested one by one.  Smaller queries are always tested in the calling thread.
+
+  The store remembers when each contact was removed.  Asking for the ids of the contacts
+  matching a QContactChangeLogFilter with the QContactChangeLogFilter::EventRemoved event type
+  returns the ids of the contacts removed since the filter's time, in the order in which they
+  were removed; no contact matches such a filter, since removed contacts are no longer stored.
+
+  The store keeps a revision, which advances whenever contacts are added, changed or removed,
+  and a journal of the changes made in the last QContactMemoryChangeJournal::MaximumEntries
+  revisions, from which changesSince() is answered.
+
   Data stored in this engine is only available in the current process.
 
   This engine supports sharing, so an internal reference count is increased
@@ -117,6 +149,10 @@ QContactMemoryEngine* QContactMemoryEngine::createMemoryEngine(const QMap<QStrin
         data->m_anonymous = anonymous;
         engineDatas.insert(idValue, data);
     }
+    if (parameters.value(QStringLiteral("fullTextIndex")) == QLatin1String("true"))
+        data->enableTextIndex();
+    if (parameters.contains(QStringLiteral("parallelFilterThreshold")))
+        data->m_parallelFilterThreshold = qMax(0, parameters.value(QStringLiteral("parallelFilterThreshold")).toInt());
     return new QContactMemoryEngine(data);
 }
 
@@ -178,7 +214,7 @@ QMap<QString, QString> QContactMemoryEngine::idInterpretationParameters() const
 /*! \reimp */
 bool QContactMemoryEngine::setSelfContactId(const QContactId &contactId, QContactManager::Error *error)
 {
-    if (contactId.isNull() || d->m_contactIds.contains(contactId)) {
+    if (contactId.isNull() || d->m_contacts.contains(contactId)) {
         *error = QContactManager::NoError;
         QContactId oldId = d->m_selfContactId;
         d->m_selfContactId = contactId;
@@ -202,15 +238,29 @@ QContactId QContactMemoryEngine::selfContactId(QContactManager::Error *error) co
     return d->m_selfContactId;
 }
 
+/*! \reimp */
+quint64 QContactMemoryEngine::revision(QContactManager::Error *error) const
+{
+    *error = QContactManager::NoError;
+    return d->m_changeJournal.revision();
+}
+
+/*! \reimp */
+QContactChangeSet QContactMemoryEngine::changesSince(quint64 revision, quint64 *currentRevision, QContactManager::Error *error) const
+{
+    *currentRevision = d->m_changeJournal.revision();
+    return d->m_changeJournal.changesSince(revision, error);
+}
+
 /*! \reimp */
 QContact QContactMemoryEngine::contact(const QContactId &contactId, const QContactFetchHint &fetchHint, QContactManager::Error *error) const
 {
     Q_UNUSED(fetchHint); // no optimizations are possible in the memory backend; ignore the fetch hint.
-    int index = d->m_contactIds.indexOf(contactId);
-    if (index != -1) {
+    const QContact *stored = d->m_contacts.find(contactId);
+    if (stored) {
         // found the contact successfully.
         *error = QContactManager::NoError;
-        return d->m_contacts.at(index);
+        return *stored;
     }
 
     *error = QContactManager::DoesNotExistError;
@@ -222,7 +272,24 @@ QList<QContactId> QContactMemoryEngine::contactIds(const QContactFilter &filter,
 {
     /* Special case the fast case */
     if (filter.type() == QContactFilter::DefaultFilter && sortOrders.count() == 0) {
-        return d->m_contactIds;
+        return d->m_contacts.keys();
+    } else if (filter.type() == QContactFilter::ChangeLogFilter
+               && QContactChangeLogFilter(filter).eventType() == QContactChangeLogFilter::EventRemoved) {
+        /* Removed contacts cannot be sorted; report them in the order of their removal */
+        *error = QContactManager::NoError;
+        return d->m_changeLogIndex.removedSince(QContactChangeLogFilter(filter).since());
+    } else if (sortOrders.isEmpty() || !sortOrders.first().isValid()) {
+        /* Unsorted; the ids of the matching contacts can be read without copying the contacts */
+        *error = QContactManager::NoError;
+        if (filter.type() == QContactFilter::DefaultFilter)
+            return d->m_contacts.keys();
+
+        const QVector<int> matching = filteredPositions(filter);
+        QList<QContactId> ids;
+        ids.reserve(matching.count());
+        foreach (int position, matching)
+            ids.append(d->m_contacts.keyAt(position));
+        return ids;
     } else {
         QList<QContact> clist = contacts(filter, sortOrders, QContactFetchHint(), error);
 
@@ -235,29 +302,302 @@ QList<QContactId> QContactMemoryEngine::contactIds(const QContactFilter &filter,
     }
 }
 
+/*! \reimp */
+int QContactMemoryEngine::contactCount(const QContactFilter &filter, QContactManager::Error *error) const
+{
+    *error = QContactManager::NoError;
+    switch (filter.type()) {
+    case QContactFilter::DefaultFilter:
+        return d->m_contacts.count();
+
+    case QContactFilter::CollectionFilter:
+    {
+        /* The collection index knows the size of each collection; the ids are a set, so none is counted twice */
+        int count = 0;
+        foreach (const QContactCollectionId &collectionId, QContactCollectionFilter(filter).collectionIds())
+            count += d->contactCount(collectionId);
+        return count;
+    }
+
+    case QContactFilter::ChangeLogFilter:
+        if (QContactChangeLogFilter(filter).eventType() == QContactChangeLogFilter::EventRemoved)
+            return d->m_changeLogIndex.removedSince(QContactChangeLogFilter(filter).since()).count();
+        break;
+
+    default:
+        break;
+    }
+
+    return filteredPositions(filter).count();
+}
+
+namespace {
+
+/* The state of a filter tested in parallel.  Every chunk of the positions to test is claimed
+ * by exactly one thread, which may be the caller; the caller waits for every chunk, and any
+ * task which starts later finds nothing left to claim. */
+class ParallelFilter
+{
+public:
+    ParallelFilter(const QContactMemoryOrderedHash<QContactId, QContact> &contacts, const QContactCompiledFilter &filter,
+                   const QVector<int> *positions, int count, int chunks)
+        : m_contacts(contacts), m_filter(filter), m_positions(positions),
+          m_count(count), m_chunks(chunks), m_nextChunk(0), m_matches(chunks)
+    {
+        m_results = m_matches.data();
+    }
+
+    /* Tests chunks until none are left */
+    void run()
+    {
+        int chunk;
+        while ((chunk = m_nextChunk.fetchAndAddRelaxed(1)) < m_chunks) {
+            const int begin = int(qint64(m_count) * chunk / m_chunks);
+            const int end = int(qint64(m_count) * (chunk + 1) / m_chunks);
+            QVector<int> &matches = m_results[chunk];
+            for (int j = begin; j < end; ++j) {
+                const int position = m_positions ? m_positions->at(j) : j;
+                if ((m_positions || m_contacts.isLiveAt(position)) && m_filter.matches(m_contacts.valueAt(position)))
+                    matches.append(position);
+            }
+            m_done.release();
+        }
+    }
+
+    /* Returns the matching positions once every chunk has been tested */
+    QVector<int> matches()
+    {
+        m_done.acquire(m_chunks);
+        QVector<int> result;
+        for (int chunk = 0; chunk < m_chunks; ++chunk)
+            result += m_matches.at(chunk);
+        return result;
+    }
+
+private:
+    const QContactMemoryOrderedHash<QContactId, QContact> &m_contacts;
+    const QContactCompiledFilter m_filter;
+    const QVector<int> *m_positions;
+    const int m_count;
+    const int m_chunks;
+    QAtomicInt m_nextChunk;
+    QVector<QVector<int> > m_matches; // the matches in each chunk
+    QVector<int> *m_results;          // the data of m_matches, so that threads never detach it
+    QSemaphore m_done;                // released once for each chunk tested
+};
+
+class ParallelFilterTask : public QRunnable
+{
+public:
+    explicit ParallelFilterTask(const QSharedPointer<ParallelFilter> &filter) : m_filter(filter) {}
+    void run() { m_filter->run(); }
+
+private:
+    QSharedPointer<ParallelFilter> m_filter; // kept alive until every task has run
+};
+
+} // namespace
+
+/* Returns the positions among \a positions (or among every stored contact, if null) of the
+ * contacts which match \a filter, in increasing order.  If the store allows it and there are
+ * enough contacts to test, they are tested in parallel chunks. */
+QVector<int> QContactMemoryEngine::matchingPositions(const QContactCompiledFilter &filter, const QVector<int> *positions) const
+{
+    enum { MinimumChunkSize = 512 }; // below this, starting a task costs more than it saves
+
+    const int count = positions ? positions->count() : d->m_contacts.positionCount();
+    int chunks = 1;
+    if (d->m_parallelFilterThreshold > 0 && count >= d->m_parallelFilterThreshold)
+        chunks = qBound(1, count / MinimumChunkSize, QThreadPool::globalInstance()->maxThreadCount() + 1);
+
+    if (chunks == 1) {
+        QVector<int> matches;
+        for (int j = 0; j < count; ++j) {
+            const int position = positions ? positions->at(j) : j;
+            if ((positions || d->m_contacts.isLiveAt(position)) && filter.matches(d->m_contacts.valueAt(position)))
+                matches.append(position);
+        }
+        return matches;
+    }
+
+    // this thread tests chunks too, so the query completes even if the pool is busy
+    QSharedPointer<ParallelFilter> parallel(new ParallelFilter(d->m_contacts, filter, positions, count, chunks));
+    for (int j = 1; j < chunks; ++j)
+        QThreadPool::globalInstance()->start(new ParallelFilterTask(parallel));
+    parallel->run();
+    return parallel->matches();
+}
+
+/* Returns the positions of the stored contacts which match \a filter, in increasing order.
+ * The indexes narrow the contacts to test where they can. */
+QVector<int> QContactMemoryEngine::filteredPositions(const QContactFilter &filter) const
+{
+    const QContactCompiledFilter compiledFilter(filter);
+    QSet<QContactId> candidates;
+    QVector<int> positions;
+    const bool narrowed = findCandidates(filter, &candidates);
+    if (narrowed) {
+        /* Only the candidates can match; test them in the order in which they are stored */
+        positions.reserve(candidates.size());
+        foreach (const QContactId &id, candidates) {
+            const int position = d->m_contacts.position(id);
+            if (position >= 0)
+                positions.append(position);
+        }
+        std::sort(positions.begin(), positions.end());
+    }
+
+    return matchingPositions(compiledFilter, narrowed ? &positions : 0);
+}
+
 /*! \reimp */
 QList<QContact> QContactMemoryEngine::contacts(const QContactFilter &filter, const QList<QContactSortOrder> &sortOrders, const QContactFetchHint &fetchHint, QContactManager::Error *error) const
 {
-    Q_UNUSED(fetchHint); // no optimizations are possible in the memory backend; ignore the fetch hint.
     Q_UNUSED(error);
 
     QList<QContact> sorted;
 
     /* First filter out contacts - check for default filter first */
+    typedef QContactMemoryOrderedHash<QContactId, QContact>::const_iterator ContactIterator;
     if (filter.type() == QContactFilter::DefaultFilter) {
-        foreach(const QContact&c, d->m_contacts) {
-            QContactManagerEngine::addSorted(&sorted,c, sortOrders);
-        }
+        sorted.reserve(d->m_contacts.count());
+        for (ContactIterator it = d->m_contacts.constBegin(), end = d->m_contacts.constEnd(); it != end; ++it)
+            sorted.append(*it);
     } else {
-        foreach(const QContact&c, d->m_contacts) {
-            if (QContactManagerEngine::testFilter(filter, c))
-                QContactManagerEngine::addSorted(&sorted,c, sortOrders);
-        }
+        const QVector<int> matching = filteredPositions(filter);
+        sorted.reserve(matching.count());
+        foreach (int position, matching)
+            sorted.append(d->m_contacts.valueAt(position));
     }
 
+    /* Then sort the matching contacts once; only the first maxCountHint() of them need ordering */
+    QContactManagerEngine::sortContacts(&sorted, sortOrders, fetchHint.maxCountHint());
+
     return sorted;
 }
 
+/*! \reimp */
+QList<QContact> QContactMemoryEngine::contacts(const QList<QContactId> &contactIds, const QContactFetchHint &fetchHint, QMap<int, QContactManager::Error> *errorMap, QContactManager::Error *error) const
+{
+    Q_UNUSED(fetchHint); // no optimizations are possible in the memory backend; ignore the fetch hint.
+
+    // look each contact up directly, rather than testing an id filter against every stored contact
+    QList<QContact> results;
+    results.reserve(contactIds.size());
+    *error = QContactManager::NoError;
+    for (int i = 0; i < contactIds.count(); i++) {
+        const QContact *stored = d->m_contacts.find(contactIds.at(i));
+        if (stored) {
+            results.append(*stored);
+        } else {
+            if (errorMap)
+                errorMap->insert(i, QContactManager::DoesNotExistError);
+            *error = QContactManager::DoesNotExistError;
+            results.append(QContact());
+        }
+    }
+
+    return results;
+}
+
+/* Returns true if the given detail filter compares a field value as a string, with the string match flags */
+static bool isTextSearch(const QContactDetailFilter &cdf)
+{
+    const QContactFilter::MatchFlags flags = cdf.matchFlags();
+    return cdf.detailField() != -1
+            && cdf.value().isValid()
+            && !(flags & (QContactFilter::MatchPhoneNumber | QContactFilter::MatchKeypadCollation))
+            && (flags & (QContactFilter::MatchEndsWith | QContactFilter::MatchStartsWith | QContactFilter::MatchContains | QContactFilter::MatchFixedString));
+}
+
+/*
+ * Adds to \a candidates the ids of the contacts which may match the given \a filter,
+ * as found through the indexes.  Returns false if the indexes cannot narrow the filter,
+ * in which case every stored contact must be tested against it.
+ */
+bool QContactMemoryEngine::findCandidates(const QContactFilter &filter, QSet<QContactId> *candidates) const
+{
+    switch (filter.type()) {
+    case QContactFilter::IdFilter:
+    {
+        foreach (const QContactId &id, QContactIdFilter(filter).ids())
+            candidates->insert(id);
+        return true;
+    }
+
+    case QContactFilter::ChangeLogFilter:
+    {
+        const QContactChangeLogFilter ccf(filter);
+        d->m_changeLogIndex.findCandidates(ccf.eventType(), ccf.since(), candidates);
+        return true;
+    }
+
+    case QContactFilter::CollectionFilter:
+    {
+        foreach (const QContactCollectionId &collectionId, QContactCollectionFilter(filter).collectionIds()) {
+            QHash<QContactCollectionId, QSet<QContactId> >::const_iterator members = d->m_contactsInCollections.constFind(collectionId);
+            if (members != d->m_contactsInCollections.constEnd())
+                candidates->unite(*members);
+        }
+        return true;
+    }
+
+    case QContactFilter::ContactDetailFilter:
+    {
+        const QContactDetailFilter cdf(filter);
+        if ((cdf.matchFlags() & QContactFilter::MatchPhoneNumber)
+                && cdf.detailType() == QContactPhoneNumber::Type
+                && cdf.detailField() == QContactPhoneNumber::FieldNumber
+                && cdf.value().isValid()) {
+            return d->m_phoneNumberIndex.findCandidates(cdf.value().toString(), cdf.matchFlags() & 7, candidates);
+        }
+        if ((cdf.matchFlags() & (QContactFilter::MatchPhoneNumber | QContactFilter::MatchKeypadCollation)) == QContactFilter::MatchKeypadCollation
+                && cdf.value().isValid()) {
+            return d->m_keypadIndex.findCandidates(cdf.detailType(), cdf.detailField(), cdf.value().toString(), cdf.matchFlags() & 7, candidates);
+        }
+        if (d->m_textIndex && isTextSearch(cdf))
+            return d->m_textIndex->findCandidates(cdf.detailType(), cdf.detailField(), cdf.value().toString(), cdf.matchFlags() & 7, candidates);
+        return false;
+    }
+
+    case QContactFilter::IntersectionFilter:
+    {
+        // a contact must match every term, so any term which can be narrowed bounds the result
+        bool narrowed = false;
+        QSet<QContactId> intersection;
+        foreach (const QContactFilter &term, QContactIntersectionFilter(filter).filters()) {
+            QSet<QContactId> termCandidates;
+            if (!findCandidates(term, &termCandidates))
+                continue;
+            if (narrowed) {
+                intersection.intersect(termCandidates);
+            } else {
+                intersection.swap(termCandidates);
+                narrowed = true;
+            }
+            if (intersection.isEmpty())
+                break;
+        }
+        if (narrowed)
+            candidates->unite(intersection);
+        return narrowed;
+    }
+
+    case QContactFilter::UnionFilter:
+    {
+        // a contact may match any term, so every term must be narrowed
+        foreach (const QContactFilter &term, QContactUnionFilter(filter).filters()) {
+            if (!findCandidates(term, candidates))
+                return false;
+        }
+        return true;
+    }
+
+    default:
+        return false;
+    }
+}
+
 /*! Saves the given contact \a theContact, storing any error to \a error and
     filling the \a changeSet with ids of changed contacts as required
     Returns true if the operation was successful otherwise false.
@@ -279,16 +619,13 @@ bool QContactMemoryEngine::saveContacts(QList<QContact> *contacts, QMap<int, QCo
 */
 bool QContactMemoryEngine::removeContact(const QContactId &contactId, QContactChangeSet &changeSet, QContactManager::Error *error)
 {
-    int index = d->m_contactIds.indexOf(contactId);
-
-    if (index == -1) {
+    if (!d->m_contacts.contains(contactId)) {
         *error = QContactManager::DoesNotExistError;
         return false;
     }
 
     // remove the contact from any relationships it was in.
-    QContact thisContact = d->m_contacts.at(index);
-    QList<QContactRelationship> allRelationships = relationships(QString(), thisContact.id(), QContactRelationship::Either, error);
+    QList<QContactRelationship> allRelationships = relationships(QString(), contactId, QContactRelationship::Either, error);
     if (*error != QContactManager::NoError && *error != QContactManager::DoesNotExistError) {
         *error = QContactManager::UnspecifiedError; // failed to clean up relationships
         return false;
@@ -298,9 +635,10 @@ bool QContactMemoryEngine::removeContact(const QContactId &contactId, QContactCh
     // a real backend will use DBMS transactions to ensure database integrity.
     removeRelationships(allRelationships, 0, error);
 
-    // having cleaned up the relationships, remove the contact from the lists.
-    d->m_contacts.removeAt(index);
-    d->m_contactIds.removeAt(index);
+    // having cleaned up the relationships, remove the contact from the store.
+    d->removeFromIndexes(*d->m_contacts.find(contactId));
+    d->m_contacts.remove(contactId);
+    d->m_changeLogIndex.insertRemoved(contactId, QDateTime::currentDateTime());
     *error = QContactManager::NoError;
 
     // and if it was the self contact, reset the self contact id
@@ -342,22 +680,43 @@ bool QContactMemoryEngine::removeContacts(const QList<QContactId> &contactIds, Q
 /*! \reimp */
 QList<QContactRelationship> QContactMemoryEngine::relationships(const QString &relationshipType, const QContactId &participantId, QContactRelationship::Role role, QContactManager::Error *error) const
 {
-    const QContactId defaultId;
+    typedef QContactMemoryOrderedHash<QContactRelationship, bool> RelationshipHash;
     QList<QContactRelationship> retn;
-    for (int i = 0; i < d->m_relationships.size(); i++) {
-        QContactRelationship curr = d->m_relationships.at(i);
+
+    // if the participantId argument is default constructed, then every relationship
+    // of the given type (or of any type, if none is given) matches.
+    if (participantId.isNull()) {
+        const RelationshipHash *candidates = &d->m_relationships;
+        if (!relationshipType.isEmpty()) {
+            QHash<QString, RelationshipHash>::const_iterator typeIt = d->m_relationshipsByType.constFind(relationshipType);
+            candidates = typeIt != d->m_relationshipsByType.constEnd() ? &typeIt.value() : 0;
+        }
+
+        if (candidates) {
+            retn.reserve(candidates->count());
+            for (RelationshipHash::const_iterator it = candidates->constBegin(), end = candidates->constEnd(); it != end; ++it)
+                retn.append(it.key());
+        }
+
+        *error = retn.isEmpty() ? QContactManager::DoesNotExistError : QContactManager::NoError;
+        return retn;
+    }
+
+    // otherwise, only the relationships the participant takes part in need to be considered.
+    typedef QHash<QContactId, RelationshipHash>::const_iterator ParticipantIterator;
+    const ParticipantIterator participantIt = d->m_participantRelationships.constFind(participantId);
+    if (participantIt == d->m_participantRelationships.constEnd()) {
+        *error = QContactManager::DoesNotExistError;
+        return retn;
+    }
+    for (RelationshipHash::const_iterator it = participantIt.value().constBegin(), end = participantIt.value().constEnd(); it != end; ++it) {
+        const QContactRelationship &curr = it.key();
 
         // check that the relationship type matches
         if (curr.relationshipType() != relationshipType && !relationshipType.isEmpty())
             continue;
 
-        // if the participantId argument is default constructed, then the relationship matches.
-        if (participantId == defaultId) {
-            retn.append(curr);
-            continue;
-        }
-
-        // otherwise, check that the participant exists and plays the required role in the relationship.
+        // check that the participant plays the required role in the relationship.
         if (role == QContactRelationship::First && curr.first() == participantId) {
             retn.append(curr);
         } else if (role == QContactRelationship::Second && curr.second() == participantId) {
@@ -376,27 +735,30 @@ QList<QContactRelationship> QContactMemoryEngine::relationships(const QString &r
 /*! Saves the given relationship \a relationship, storing any error to \a error and
     filling the \a changeSet with ids of changed contacts and relationships as required
     Returns true if the operation was successful otherwise false.
+
+    The relationships cached in the participating contacts are not updated; the caller refreshes
+    them once for the whole batch with refreshContactRelationships().
 */
 bool QContactMemoryEngine::saveRelationship(QContactRelationship *relationship, QContactChangeSet &changeSet, QContactManager::Error *error)
 {
     // Attempt to validate the relationship.
     // first, check that the source contact exists and is in this manager.
     QString myUri = managerUri();
-    int firstContactIndex = d->m_contactIds.indexOf(relationship->first());
+    QContact *firstContact = d->m_contacts.find(relationship->first());
     if ((!relationship->first().managerUri().isEmpty() && relationship->first().managerUri() != myUri)
-            ||firstContactIndex == -1) {
+            || !firstContact) {
         *error = QContactManager::InvalidRelationshipError;
         return false;
     }
 
     // second, check that the second contact exists (if it's local); we cannot check other managers' contacts.
     QContactId dest = relationship->second();
-    int secondContactIndex = d->m_contactIds.indexOf(dest);
+    QContact *secondContact = d->m_contacts.find(dest);
 
     if (dest.managerUri().isEmpty() || dest.managerUri() == myUri) {
         // this entry in the destination list is supposedly stored in this manager.
         // check that it exists, and that it isn't the source contact (circular)
-        if (secondContactIndex == -1 || dest == relationship->first()) {
+        if (!secondContact || dest == relationship->first()) {
             *error = QContactManager::InvalidRelationshipError;
             return false;
         }
@@ -411,31 +773,21 @@ bool QContactMemoryEngine::saveRelationship(QContactRelationship *relationship,
     // check to see if the relationship already exists in the database.  If so, replace.
     // We do this because we don't want duplicates in our lists / maps of relationships.
     *error = QContactManager::NoError;
-    QList<QContactRelationship> allRelationships = d->m_relationships;
-    for (int i = 0; i < allRelationships.size(); i++) {
-        QContactRelationship curr = allRelationships.at(i);
-        if (curr == *relationship) {
-            return true;
-            // TODO: set error to AlreadyExistsError and return false?
-        }
+    if (d->m_relationships.contains(*relationship)) {
+        return true;
+        // TODO: set error to AlreadyExistsError and return false?
     }
 
-    // no matching relationship; must be new.  append it to lists in our map of relationships where required.
-    QList<QContactRelationship> firstRelationships = d->m_orderedRelationships.value(relationship->first());
-    QList<QContactRelationship> secondRelationships = d->m_orderedRelationships.value(relationship->second());
-    firstRelationships.append(*relationship);
-    secondRelationships.append(*relationship);
-    d->m_orderedRelationships.insert(relationship->first(), firstRelationships);
-    d->m_orderedRelationships.insert(relationship->second(), secondRelationships);
+    // no matching relationship; must be new.  append it to the relationships of both participants.
+    d->m_participantRelationships[relationship->first()].insert(*relationship, true);
+    d->m_participantRelationships[relationship->second()].insert(*relationship, true);
+
     changeSet.insertAddedRelationshipsContact(relationship->first());
     changeSet.insertAddedRelationshipsContact(relationship->second());
 
-    // update the contacts involved
-    QContactManagerEngine::setContactRelationships(&d->m_contacts[firstContactIndex], firstRelationships);
-    QContactManagerEngine::setContactRelationships(&d->m_contacts[secondContactIndex], secondRelationships);
-
-    // finally, insert into our list of all relationships, and return.
-    d->m_relationships.append(*relationship);
+    // finally, insert into our indexes of all relationships, and return.
+    d->m_relationships.insert(*relationship, true);
+    d->m_relationshipsByType[relationship->relationshipType()].insert(*relationship, true);
     return true;
 }
 
@@ -460,6 +812,7 @@ bool QContactMemoryEngine::saveRelationships(QList<QContactRelationship> *relati
             *error = functionError;
     }
 
+    refreshContactRelationships(changeSet.addedRelationshipsContacts());
     d->emitSharedSignals(&changeSet);
     return (*error == QContactManager::NoError);
 }
@@ -467,30 +820,27 @@ bool QContactMemoryEngine::saveRelationships(QList<QContactRelationship> *relati
 /*! Removes the given relationship \a relationship, storing any error to \a error and
     filling the \a changeSet with ids of changed contacts and relationships as required
     Returns true if the operation was successful otherwise false.
+
+    As for saveRelationship(), the caller refreshes the relationships cached in the contacts.
 */
 bool QContactMemoryEngine::removeRelationship(const QContactRelationship &relationship, QContactChangeSet &changeSet, QContactManager::Error *error)
 {
     // attempt to remove it from our list of relationships.
-    if (!d->m_relationships.removeOne(relationship)) {
+    if (!d->m_relationships.remove(relationship)) {
         *error = QContactManager::DoesNotExistError;
         return false;
     }
 
-    // if that worked, then we need to remove it from the two locations in our map, also.
-    QList<QContactRelationship> firstRelationships = d->m_orderedRelationships.value(relationship.first());
-    QList<QContactRelationship> secondRelationships = d->m_orderedRelationships.value(relationship.second());
-    firstRelationships.removeOne(relationship);
-    secondRelationships.removeOne(relationship);
-    d->m_orderedRelationships.insert(relationship.first(), firstRelationships);
-    d->m_orderedRelationships.insert(relationship.second(), secondRelationships);
-
-    // Update the contacts as well
-    int firstContactIndex = d->m_contactIds.indexOf(relationship.first());
-    int secondContactIndex = relationship.second().managerUri() == managerUri() ? d->m_contactIds.indexOf(relationship.second()) : -1;
-    if (firstContactIndex != -1)
-        QContactMemoryEngine::setContactRelationships(&d->m_contacts[firstContactIndex], firstRelationships);
-    if (secondContactIndex != -1)
-        QContactMemoryEngine::setContactRelationships(&d->m_contacts[secondContactIndex], secondRelationships);
+    QHash<QString, QContactMemoryOrderedHash<QContactRelationship, bool> >::iterator typeIt = d->m_relationshipsByType.find(relationship.relationshipType());
+    if (typeIt != d->m_relationshipsByType.end()) {
+        typeIt.value().remove(relationship);
+        if (typeIt.value().isEmpty())
+            d->m_relationshipsByType.erase(typeIt);
+    }
+
+    // if that worked, then we need to remove it from the relationships of both participants, also.
+    removeParticipantRelationship(relationship.first(), relationship);
+    removeParticipantRelationship(relationship.second(), relationship);
 
     // set our changes, and return.
     changeSet.insertRemovedRelationshipsContact(relationship.first());
@@ -499,6 +849,36 @@ bool QContactMemoryEngine::removeRelationship(const QContactRelationship &relati
     return true;
 }
 
+/*! Removes \a relationship from the relationships in which the contact identified by
+    \a participantId takes part.
+*/
+void QContactMemoryEngine::removeParticipantRelationship(const QContactId &participantId, const QContactRelationship &relationship)
+{
+    QHash<QContactId, QContactMemoryOrderedHash<QContactRelationship, bool> >::iterator it = d->m_participantRelationships.find(participantId);
+    if (it == d->m_participantRelationships.end())
+        return;
+
+    it.value().remove(relationship);
+    if (it.value().isEmpty())
+        d->m_participantRelationships.erase(it);
+}
+
+/*! Updates the relationships cached in each stored contact identified by \a contactIds to
+    those it currently participates in, in the order they were saved.
+*/
+void QContactMemoryEngine::refreshContactRelationships(const QSet<QContactId> &contactIds)
+{
+    typedef QHash<QContactId, QContactMemoryOrderedHash<QContactRelationship, bool> >::const_iterator ParticipantIterator;
+    foreach (const QContactId &contactId, contactIds) {
+        QContact *contact = d->m_contacts.find(contactId);
+        if (!contact)
+            continue;
+        const ParticipantIterator it = d->m_participantRelationships.constFind(contactId);
+        QContactManagerEngine::setContactRelationships(contact, it != d->m_participantRelationships.constEnd()
+                                                                ? it.value().keys() : QList<QContactRelationship>());
+    }
+}
+
 /*! \reimp */
 bool QContactMemoryEngine::removeRelationships(const QList<QContactRelationship> &relationships, QMap<int, QContactManager::Error> *errorMap, QContactManager::Error *error)
 {
@@ -515,6 +895,7 @@ bool QContactMemoryEngine::removeRelationships(const QList<QContactRelationship>
         }
     }
 
+    refreshContactRelationships(cs.removedRelationshipsContacts());
     d->emitSharedSignals(&cs);
     return (*error == QContactManager::NoError);
 }
@@ -589,7 +970,7 @@ bool QContactMemoryEngine::removeCollection(const QContactCollectionId &collecti
     // try to find the collection to remove it (and the items it contains)
     if (d->m_idToCollectionHash.contains(collectionId)) {
         // found the collection to remove.  remove the items in the collection.
-        const QList<QContactId> contactsToRemove = d->m_contactsInCollections.values(collectionId);
+        const QList<QContactId> contactsToRemove = d->m_contactsInCollections.value(collectionId).toList();
         if (!contactsToRemove.isEmpty()) {
             QMap<int, QContactManager::Error> errorMap;
             if (!removeContacts(contactsToRemove, &errorMap, error)) {
@@ -677,37 +1058,12 @@ void QContactMemoryEngine::performAsynchronousOperation(QContactAbstractRequest
         case QContactAbstractRequest::ContactFetchByIdRequest:
         {
             QContactFetchByIdRequest *r = static_cast<QContactFetchByIdRequest*>(currentRequest);
-            QContactIdFilter idFilter;
-            idFilter.setIds(r->contactIds());
-            QList<QContactSortOrder> sorting;
-            QContactFetchHint fetchHint = r->fetchHint();
             QContactManager::Error error = QContactManager::NoError;
-            QList<QContact> requestedContacts = contacts(idFilter, sorting, fetchHint, &error);
-            // Build an index into the results
-            QHash<QContactId, int> idMap; // value is index into unsorted
-            if (error == QContactManager::NoError) {
-                for (int i = 0; i < requestedContacts.size(); i++) {
-                    idMap.insert(requestedContacts[i].id(), i);
-                }
-            }
-            // Find the order in which the results should be presented
-            // Build up the results and errors
-            QList<QContact> results;
             QMap<int, QContactManager::Error> errorMap;
-            int index = 0;
-            foreach (const QContactId &id, r->contactIds()) {
-                if (!idMap.contains(id)) {
-                    errorMap.insert(index, QContactManager::DoesNotExistError);
-                    error = QContactManager::DoesNotExistError;
-                    results.append(QContact());
-                } else {
-                    results.append(requestedContacts[idMap[id]]);
-                }
-                index++;
-            }
+            QList<QContact> results = contacts(r->contactIds(), r->fetchHint(), &errorMap, &error);
 
             // update the request with the results.
-            if (!requestedContacts.isEmpty() || error != QContactManager::NoError)
+            if (!results.isEmpty() || error != QContactManager::NoError)
                 QContactManagerEngine::updateContactFetchByIdRequest(r, results, error, errorMap, QContactAbstractRequest::FinishedState);
             else
                 updateRequestState(currentRequest, QContactAbstractRequest::FinishedState);
@@ -730,6 +1086,29 @@ void QContactMemoryEngine::performAsynchronousOperation(QContactAbstractRequest
         }
         break;
 
+        case QContactAbstractRequest::ContactCountRequest:
+        {
+            QContactCountRequest *r = static_cast<QContactCountRequest*>(currentRequest);
+
+            QContactManager::Error operationError = QContactManager::NoError;
+            const int count = contactCount(r->filter(), &operationError);
+
+            updateContactCountRequest(r, count, operationError, QContactAbstractRequest::FinishedState);
+        }
+        break;
+
+        case QContactAbstractRequest::ContactChangesFetchRequest:
+        {
+            QContactChangesFetchRequest *r = static_cast<QContactChangesFetchRequest*>(currentRequest);
+
+            QContactManager::Error operationError = QContactManager::NoError;
+            quint64 currentRevision = 0;
+            QContactChangeSet changes = changesSince(r->sinceRevision(), &currentRevision, &operationError);
+
+            updateContactChangesFetchRequest(r, changes, currentRevision, operationError, QContactAbstractRequest::FinishedState);
+        }
+        break;
+
         case QContactAbstractRequest::ContactSaveRequest:
         {
             QContactSaveRequest *r = static_cast<QContactSaveRequest*>(currentRequest);
@@ -776,13 +1155,24 @@ void QContactMemoryEngine::performAsynchronousOperation(QContactAbstractRequest
         {
             QContactRelationshipFetchRequest *r = static_cast<QContactRelationshipFetchRequest*>(currentRequest);
             QContactManager::Error operationError = QContactManager::NoError;
-            QList<QContactManager::Error> operationErrors;
-            QList<QContactRelationship> allRelationships = relationships(QString(), QContactId(), QContactRelationship::Either, &operationError);
-            QList<QContactRelationship> requestedRelationships;
+
+            // narrow the candidates down through the participant and type indexes where possible.
+            QList<QContactRelationship> candidateRelationships;
+            if (!r->first().isNull())
+                candidateRelationships = relationships(r->relationshipType(), r->first(), QContactRelationship::First, &operationError);
+            else if (!r->second().isNull())
+                candidateRelationships = relationships(r->relationshipType(), r->second(), QContactRelationship::Second, &operationError);
+            else
+                candidateRelationships = relationships(r->relationshipType(), QContactId(), QContactRelationship::Either, &operationError);
+
+            // only report an error if there are no relationships at all.
+            if (operationError == QContactManager::DoesNotExistError && !d->m_relationships.isEmpty())
+                operationError = QContactManager::NoError;
 
             // select the requested relationships.
-            for (int i = 0; i < allRelationships.size(); i++) {
-                QContactRelationship currRel = allRelationships.at(i);
+            QList<QContactRelationship> requestedRelationships;
+            for (int i = 0; i < candidateRelationships.size(); i++) {
+                const QContactRelationship &currRel = candidateRelationships.at(i);
                 if (r->first() != QContactId() && r->first() != currRel.first())
                     continue;
                 if (r->second() != QContactId() && r->second() != currRel.second())
@@ -971,9 +1361,37 @@ QList<QVariant::Type> QContactMemoryEngine::supportedDataTypes() const
  */
 bool QContactMemoryEngine::isFilterSupported(const QContactFilter &filter) const
 {
-    Q_UNUSED(filter);
-    // Until we add hashes for common stuff, fall back to slow code
-    return false;
+    // Only string searches on fields covered by the full-text index, if there is one, beat the fallback
+    switch (filter.type()) {
+    case QContactFilter::ContactDetailFilter:
+    {
+        const QContactDetailFilter cdf(filter);
+        return d->m_textIndex && isTextSearch(cdf) && QContactMemoryTextIndex::isIndexed(cdf.detailType(), cdf.detailField());
+    }
+
+    case QContactFilter::IntersectionFilter:
+    {
+        const QList<QContactFilter> terms = QContactIntersectionFilter(filter).filters();
+        foreach (const QContactFilter &term, terms) {
+            if (!isFilterSupported(term))
+                return false;
+        }
+        return !terms.isEmpty();
+    }
+
+    case QContactFilter::UnionFilter:
+    {
+        const QList<QContactFilter> terms = QContactUnionFilter(filter).filters();
+        foreach (const QContactFilter &term, terms) {
+            if (!isFilterSupported(term))
+                return false;
+        }
+        return !terms.isEmpty();
+    }
+
+    default:
+        return false;
+    }
 }
 
 bool QContactMemoryEngine::saveContacts(QList<QContact> *contacts, QMap<int, QContactManager::Error> *errorMap,
@@ -1020,10 +1438,10 @@ bool QContactMemoryEngine::saveContact(QContact *theContact, QContactChangeSet &
     }
 
     // check to see if this contact already exists
-    int index = d->m_contactIds.indexOf(id);
-    if (index != -1) {
+    const QContact *stored = d->m_contacts.find(id);
+    if (stored) {
         /* We also need to check that there are no modified create only details */
-        QContact oldContact = d->m_contacts.at(index);
+        QContact oldContact = *stored;
 
         if (oldContact.type() != theContact->type()) {
             *error = QContactManager::AlreadyExistsError;
@@ -1037,13 +1455,19 @@ bool QContactMemoryEngine::saveContact(QContact *theContact, QContactChangeSet &
             *theContact = tempContact;
         }
 
+        // it already exists, so keep it in its collection unless another one was given
+        if (theContact->collectionId().isNull())
+            theContact->setCollectionId(oldContact.collectionId());
+
         QContactTimestamp ts = theContact->detail(QContactTimestamp::Type);
         ts.setLastModified(QDateTime::currentDateTime());
         QContactManagerEngine::setDetailAccessConstraints(&ts, QContactDetail::ReadOnly | QContactDetail::Irremovable);
         theContact->saveDetail(&ts);
 
         // Looks ok, so continue
-        d->m_contacts.replace(index, *theContact);
+        d->removeFromIndexes(oldContact);
+        d->m_contacts.insert(id, *theContact);
+        d->addToIndexes(*theContact);
         changeSet.insertChangedContact(theContact->id(), mask);
     } else {
         // id does not exist; if not zero, fail.
@@ -1088,9 +1512,8 @@ bool QContactMemoryEngine::saveContact(QContact *theContact, QContactChangeSet &
         theContact->setId(newContactId);
 
         // finally, add the contact to our internal lists and return
-        d->m_contacts.append(*theContact);                   // add contact to list
-        d->m_contactIds.append(theContact->id());  // track the contact id.
-        d->m_contactsInCollections.insert(collectionId, newContactId); // link contact to collection
+        d->m_contacts.insert(newContactId, *theContact);   // add contact to the store
+        d->addToIndexes(*theContact);                      // which also links the contact to its collection
 
         changeSet.insertAddedContact(theContact->id());
     }
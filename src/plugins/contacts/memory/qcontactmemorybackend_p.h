@@ -52,12 +52,19 @@
 // We mean it.
 //
 
+#include <QtCore/qhash.h>
+#include <QtCore/qscopedpointer.h>
+#include <QtCore/qset.h>
+#include <QtCore/qvector.h>
+
 #include <QtContacts/qcontact.h>
 #include <QtContacts/qcontactmanager.h>
 #include <QtContacts/qcontactmanagerengine.h>
 #include <QtContacts/qcontactchangeset.h>
 #include <QtContacts/qcontactmanagerenginefactory.h>
 
+#include "qcontactmemoryindex_p.h"
+
 QT_BEGIN_NAMESPACE_CONTACTS
 
 class QContactMemoryEngine;
@@ -71,6 +78,139 @@ public:
     QString managerName() const;
 };
 
+/*
+ * A hash which also remembers the order in which its keys were first inserted.
+ *
+ * Lookup, insertion and removal are O(1); removal is amortized, since a removed
+ * entry leaves a hole in the entry vector which is reclaimed once the holes
+ * outnumber the live entries.  Iteration visits the live entries in insertion
+ * order, and replacing the value of an existing key keeps its position.
+ */
+template <typename Key, typename T>
+class QContactMemoryOrderedHash
+{
+    struct Entry
+    {
+        Entry() : live(false) {}
+        Entry(const Key &k, const T &v) : key(k), value(v), live(true) {}
+
+        Key key;
+        T value;
+        bool live;
+    };
+
+public:
+    class const_iterator
+    {
+    public:
+        const_iterator() : m_entries(0), m_pos(0) {}
+
+        const Key &key() const { return m_entries->at(m_pos).key; }
+        const T &value() const { return m_entries->at(m_pos).value; }
+        const T &operator*() const { return value(); }
+        const T *operator->() const { return &value(); }
+
+        const_iterator &operator++() { ++m_pos; skipHoles(); return *this; }
+        bool operator==(const const_iterator &other) const { return m_pos == other.m_pos; }
+        bool operator!=(const const_iterator &other) const { return m_pos != other.m_pos; }
+
+    private:
+        friend class QContactMemoryOrderedHash;
+        const_iterator(const QVector<Entry> *entries, int pos) : m_entries(entries), m_pos(pos) { skipHoles(); }
+        void skipHoles() { while (m_pos < m_entries->size() && !m_entries->at(m_pos).live) ++m_pos; }
+
+        const QVector<Entry> *m_entries;
+        int m_pos;
+    };
+
+    QContactMemoryOrderedHash() : m_holes(0) {}
+
+    int count() const { return m_index.count(); }
+    bool isEmpty() const { return m_index.isEmpty(); }
+    bool contains(const Key &key) const { return m_index.contains(key); }
+
+    const T *find(const Key &key) const
+    {
+        typename QHash<Key, int>::const_iterator it = m_index.constFind(key);
+        return it == m_index.constEnd() ? 0 : &m_entries.at(it.value()).value;
+    }
+
+    T *find(const Key &key)
+    {
+        typename QHash<Key, int>::const_iterator it = m_index.constFind(key);
+        return it == m_index.constEnd() ? 0 : &m_entries[it.value()].value;
+    }
+
+    void insert(const Key &key, const T &value)
+    {
+        typename QHash<Key, int>::const_iterator it = m_index.constFind(key);
+        if (it != m_index.constEnd()) {
+            m_entries[it.value()].value = value;
+        } else {
+            m_index.insert(key, m_entries.size());
+            m_entries.append(Entry(key, value));
+        }
+    }
+
+    bool remove(const Key &key)
+    {
+        typename QHash<Key, int>::iterator it = m_index.find(key);
+        if (it == m_index.end())
+            return false;
+
+        m_entries[it.value()] = Entry(); // release the stored value now, not at compaction time
+        m_index.erase(it);
+        if (++m_holes > m_index.count())
+            compact();
+        return true;
+    }
+
+    void clear()
+    {
+        m_entries.clear();
+        m_index.clear();
+        m_holes = 0;
+    }
+
+    QList<Key> keys() const
+    {
+        QList<Key> retn;
+        retn.reserve(count());
+        for (const_iterator it = constBegin(), end = constEnd(); it != end; ++it)
+            retn.append(it.key());
+        return retn;
+    }
+
+    const_iterator constBegin() const { return const_iterator(&m_entries, 0); }
+    const_iterator constEnd() const { return const_iterator(&m_entries, m_entries.size()); }
+
+    // positions follow the iteration order, and stay valid until the next removal
+    int position(const Key &key) const { return m_index.value(key, -1); }
+    const Key &keyAt(int position) const { return m_entries.at(position).key; }
+    const T &valueAt(int position) const { return m_entries.at(position).value; }
+    int positionCount() const { return m_entries.size(); } // including those of removed values
+    bool isLiveAt(int position) const { return m_entries.at(position).live; }
+
+private:
+    void compact()
+    {
+        QVector<Entry> entries;
+        entries.reserve(m_index.count());
+        for (int i = 0; i < m_entries.size(); ++i) {
+            if (m_entries.at(i).live) {
+                m_index[m_entries.at(i).key] = entries.size();
+                entries.append(m_entries.at(i));
+            }
+        }
+        m_entries.swap(entries);
+        m_holes = 0;
+    }
+
+    QVector<Entry> m_entries;
+    QHash<Key, int> m_index;  // key to position in m_entries
+    int m_holes;
+};
+
 class QContactMemoryEngineData : public QSharedData
 {
 public:
@@ -80,6 +220,7 @@ public:
         , m_selfContactId()
         , m_nextContactId(1)
         , m_anonymous(false)
+        , m_parallelFilterThreshold(0)
     {
     }
 
@@ -88,7 +229,8 @@ public:
         m_refCount(QAtomicInt(1)),
         m_selfContactId(other.m_selfContactId),
         m_nextContactId(other.m_nextContactId),
-        m_anonymous(other.m_anonymous)
+        m_anonymous(other.m_anonymous),
+        m_parallelFilterThreshold(other.m_parallelFilterThreshold)
     {
     }
 
@@ -102,20 +244,68 @@ public:
     QString m_id;                                  // the id parameter value
 
     QContactId m_selfContactId;               // the "MyCard" contact id
-    QList<QContact> m_contacts;               // list of contacts
-    QHash<QContactCollectionId, QContactId> m_contactsInCollections;   // hash of contacts for each collection
+    QContactMemoryOrderedHash<QContactId, QContact> m_contacts; // contacts keyed by id, in insertion order
+    QContactMemoryPhoneNumberIndex m_phoneNumberIndex; // the phone numbers of m_contacts, by their rightmost digits
+    QContactMemoryKeypadIndex m_keypadIndex;           // the keypad forms of the names and labels of m_contacts
+    QScopedPointer<QContactMemoryTextIndex> m_textIndex; // the trigrams of the text fields of m_contacts, if requested
+    QContactMemoryChangeLogIndex m_changeLogIndex;     // the creation, modification and removal times of contacts
+    QContactMemoryChangeJournal m_changeJournal;       // the revision, and the changes made in recent revisions
+    QHash<QContactCollectionId, QSet<QContactId> > m_contactsInCollections; // the ids of the contacts in each collection
     QHash<QContactCollectionId, QContactCollection> m_idToCollectionHash; // hash of id to the collection identified by that id
-    QList<QContactId> m_contactIds;           // list of contact Id's
-    QList<QContactRelationship> m_relationships;   // list of contact relationships
-    QMap<QContactId, QList<QContactRelationship> > m_orderedRelationships; // map of ordered lists of contact relationships
+    QContactMemoryOrderedHash<QContactRelationship, bool> m_relationships; // all contact relationships, in insertion order
+    QHash<QString, QContactMemoryOrderedHash<QContactRelationship, bool> > m_relationshipsByType; // relationships of each type, in insertion order
+    QHash<QContactId, QContactMemoryOrderedHash<QContactRelationship, bool> > m_participantRelationships; // the relationships each contact participates in, in insertion order
     QList<QString> m_definitionIds;                // list of definition types (id's)
     quint32 m_nextContactId;
     bool m_anonymous;                              // Is this backend ever shared?
+    int m_parallelFilterThreshold;                 // contacts to test before filtering in parallel, or 0 if never
     QString m_managerUri;                        // for faster lookup.
 
 
+    // the indexes must be told of every contact stored in, or removed from, m_contacts
+    void addToIndexes(const QContact &contact)
+    {
+        m_phoneNumberIndex.insert(contact);
+        m_keypadIndex.insert(contact);
+        if (m_textIndex)
+            m_textIndex->insert(contact);
+        m_changeLogIndex.insert(contact);
+        m_contactsInCollections[contact.collectionId()].insert(contact.id());
+    }
+
+    void removeFromIndexes(const QContact &contact)
+    {
+        m_phoneNumberIndex.remove(contact);
+        m_keypadIndex.remove(contact);
+        if (m_textIndex)
+            m_textIndex->remove(contact);
+        m_changeLogIndex.remove(contact);
+        QHash<QContactCollectionId, QSet<QContactId> >::iterator members = m_contactsInCollections.find(contact.collectionId());
+        if (members != m_contactsInCollections.end()) {
+            members->remove(contact.id());
+            if (members->isEmpty())
+                m_contactsInCollections.erase(members);
+        }
+    }
+
+    int contactCount(const QContactCollectionId &collectionId) const
+    {
+        QHash<QContactCollectionId, QSet<QContactId> >::const_iterator members = m_contactsInCollections.constFind(collectionId);
+        return members == m_contactsInCollections.constEnd() ? 0 : members->size();
+    }
+
+    void enableTextIndex()
+    {
+        if (m_textIndex)
+            return;
+        m_textIndex.reset(new QContactMemoryTextIndex);
+        for (QContactMemoryOrderedHash<QContactId, QContact>::const_iterator it = m_contacts.constBegin(), end = m_contacts.constEnd(); it != end; ++it)
+            m_textIndex->insert(*it);
+    }
+
     void emitSharedSignals(QContactChangeSet *cs)
     {
+        m_changeJournal.record(*cs);
         foreach(QContactManagerEngine* engine, m_sharedEngines)
             cs->emitSignals(engine);
     }
@@ -148,7 +338,9 @@ public:
     int managerVersion() const {return 1;}
 
     virtual QList<QContactId> contactIds(const QContactFilter &filter, const QList<QContactSortOrder> &sortOrders, QContactManager::Error *error) const;
+    virtual int contactCount(const QContactFilter &filter, QContactManager::Error *error) const;
     virtual QList<QContact> contacts(const QContactFilter &filter, const QList<QContactSortOrder> &sortOrders, const QContactFetchHint &fetchHint, QContactManager::Error *error) const;
+    virtual QList<QContact> contacts(const QList<QContactId> &contactIds, const QContactFetchHint &fetchHint, QMap<int, QContactManager::Error> *errorMap, QContactManager::Error *error) const;
     virtual QContact contact(const QContactId &contactId, const QContactFetchHint &fetchHint, QContactManager::Error *error) const;
 
     virtual bool saveContacts(QList<QContact> *contacts, QMap<int, QContactManager::Error> *errorMap, QContactManager::Error *error);
@@ -158,6 +350,10 @@ public:
     virtual bool setSelfContactId(const QContactId &contactId, QContactManager::Error *error);
     virtual QContactId selfContactId(QContactManager::Error *error) const;
 
+    /* Revisions, for synchronization */
+    virtual quint64 revision(QContactManager::Error *error) const;
+    virtual QContactChangeSet changesSince(quint64 revision, quint64 *currentRevision, QContactManager::Error *error) const;
+
     /* Relationships between contacts */
     virtual QList<QContactRelationship> relationships(const QString &relationshipType, const QContactId &participantId, QContactRelationship::Role role, QContactManager::Error *error) const;
     virtual bool saveRelationships(QList<QContactRelationship> *relationships, QMap<int, QContactManager::Error> *errorMap, QContactManager::Error *error);
@@ -212,6 +408,12 @@ private:
     bool saveContacts(QList<QContact> *contacts, QMap<int, QContactManager::Error> *errorMap, QContactManager::Error *error, const QList<QContactDetail::DetailType> &mask);
     bool saveContact(QContact *theContact, QContactChangeSet &changeSet, QContactManager::Error *error, const QList<QContactDetail::DetailType> &mask);
     void partiallySyncDetails(QContact *to, const QContact &from, const QList<QContactDetail::DetailType> &mask);
+    void removeParticipantRelationship(const QContactId &participantId, const QContactRelationship &relationship);
+    void refreshContactRelationships(const QSet<QContactId> &contactIds);
+
+    bool findCandidates(const QContactFilter &filter, QSet<QContactId> *candidates) const;
+    QVector<int> matchingPositions(const QContactCompiledFilter &filter, const QVector<int> *positions) const;
+    QVector<int> filteredPositions(const QContactFilter &filter) const;
 
     void performAsynchronousOperation(QContactAbstractRequest *request);
 
@@ -0,0 +1,695 @@
+/****************************************************************************
+**
+** Copyright (C) 2017 The Qt Company Ltd.
+** Contact: https://www.qt.io/licensing/
+**
+** This file is part of the QtContacts module of the Qt Toolkit.
+**
+** $QT_BEGIN_LICENSE:LGPL$
+** Commercial License Usage
+** Licensees holding valid commercial Qt licenses may use this file in
+** accordance with the commercial license agreement provided with the
+** Software or, alternatively, in accordance with the terms contained in
+** a written agreement between you and The Qt Company. For licensing terms
+** and conditions see https://www.qt.io/terms-conditions. For further
+** information use the contact form at https://www.qt.io/contact-us.
+**
+** GNU Lesser General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU Lesser
+** General Public License version 3 as published by the Free Software
+** Foundation and appearing in the file LICENSE.LGPL3 included in the
+** packaging of this file. Please review the following information to
+** ensure the GNU Lesser General Public License version 3 requirements
+** will be met: https://www.gnu.org/licenses/lgpl-3.0.html.
+**
+** GNU General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU
+** General Public License version 2.0 or (at your option) the GNU General
+** Public license version 3 or any later version approved by the KDE Free
+** Qt Foundation. The licenses are as published by the Free Software
+** Foundation and appearing in the file LICENSE.GPL2 and LICENSE.GPL3
+** included in the packaging of this file. Please review the following
+** information to ensure the GNU General Public License requirements will
+** be met: https://www.gnu.org/licenses/gpl-2.0.html and
+** https://www.gnu.org/licenses/gpl-3.0.html.
+**
+** $QT_END_LICENSE$
+**
+****************************************************************************/
+
+
+#include "qcontactmemoryindex_p.h"
+
+#include <algorithm>
+
+#include <QtContacts/qcontactaddress.h>
+#include <QtContacts/qcontactdisplaylabel.h>
+#include <QtContacts/qcontactemailaddress.h>
+#include <QtContacts/qcontactfilter.h>
+#include <QtContacts/qcontactname.h>
+#include <QtContacts/qcontactnickname.h>
+#include <QtContacts/qcontactnote.h>
+#include <QtContacts/qcontactorganization.h>
+#include <QtContacts/qcontactphonenumber.h>
+#include <QtContacts/qcontacttimestamp.h>
+
+QT_BEGIN_NAMESPACE_CONTACTS
+
+/* The rightmost digits which MatchPhoneNumber compares regardless of the match type */
+static const int PhoneNumberSuffixLength = 7;
+
+/*
+ * Returns the digits of the given phone \a number, ignoring every other character,
+ * just as the MatchPhoneNumber filter test does.
+ */
+QString QContactMemoryPhoneNumberIndex::digits(const QString &number)
+{
+    QString retn;
+    retn.reserve(number.size());
+    for (int i = 0; i < number.size(); i++) {
+        const QChar current = number.at(i);
+        if (current.isDigit())
+            retn.append(current);
+    }
+    return retn;
+}
+
+/* Files each phone number of the given \a contact under its rightmost digits */
+void QContactMemoryPhoneNumberIndex::insert(const QContact &contact)
+{
+    foreach (const QContactPhoneNumber &phoneNumber, contact.details<QContactPhoneNumber>())
+        m_contactsBySuffix[digits(phoneNumber.number()).right(PhoneNumberSuffixLength)].append(contact.id());
+}
+
+/* Removes the entries filed by insert() for the given \a contact, which must be unchanged since */
+void QContactMemoryPhoneNumberIndex::remove(const QContact &contact)
+{
+    foreach (const QContactPhoneNumber &phoneNumber, contact.details<QContactPhoneNumber>()) {
+        QHash<QString, QList<QContactId> >::iterator it = m_contactsBySuffix.find(digits(phoneNumber.number()).right(PhoneNumberSuffixLength));
+        if (it == m_contactsBySuffix.end())
+            continue;
+        it->removeOne(contact.id());
+        if (it->isEmpty())
+            m_contactsBySuffix.erase(it);
+    }
+}
+
+/*
+ * Adds to \a candidates the ids of the contacts with a phone number which may match
+ * the given \a number under MatchPhoneNumber with the given \a matchType.
+ *
+ * Every such number shares its rightmost seven digits with the query whenever the
+ * query must match exactly, or must match the end of a number and has at least seven
+ * digits.  Returns false for any other query, which must be tested against every contact.
+ */
+bool QContactMemoryPhoneNumberIndex::findCandidates(const QString &number, int matchType, QSet<QContactId> *candidates) const
+{
+    const QString queryDigits = digits(number);
+    if (matchType != QContactFilter::MatchExactly
+            && (matchType != QContactFilter::MatchEndsWith || queryDigits.size() < PhoneNumberSuffixLength)) {
+        return false;
+    }
+
+    QHash<QString, QList<QContactId> >::const_iterator it = m_contactsBySuffix.constFind(queryDigits.right(PhoneNumberSuffixLength));
+    if (it != m_contactsBySuffix.constEnd()) {
+        foreach (const QContactId &id, *it)
+            candidates->insert(id);
+    }
+    return true;
+}
+
+/* The fields whose keypad forms are indexed: names and labels, which dialers search */
+static const struct {
+    QContactDetail::DetailType type;
+    int field;
+} KeypadIndexedFields[] = {
+    { QContactName::Type, QContactName::FieldPrefix },
+    { QContactName::Type, QContactName::FieldFirstName },
+    { QContactName::Type, QContactName::FieldMiddleName },
+    { QContactName::Type, QContactName::FieldLastName },
+    { QContactName::Type, QContactName::FieldSuffix },
+    { QContactName::Type, QContactName::FieldCustomLabel },
+    { QContactNickname::Type, QContactNickname::FieldNickname },
+    { QContactDisplayLabel::Type, QContactDisplayLabel::FieldLabel }
+};
+static const int KeypadIndexedFieldCount = sizeof(KeypadIndexedFields) / sizeof(KeypadIndexedFields[0]);
+
+QContactMemoryKeypadIndex::QContactMemoryKeypadIndex()
+    : m_contactsByForm(KeypadIndexedFieldCount),
+      m_lastLookupValid(false),
+      m_lastField(-1),
+      m_lastMatchType(-1)
+{
+}
+
+/*
+ * Returns the ITU-T keypad form of the given \a value, as the MatchKeypadCollation
+ * filter test computes it: letters are lowercased and replaced by the key which
+ * carries them, and every other character is kept.
+ */
+QString QContactMemoryKeypadIndex::collated(const QString &value)
+{
+    static const char keys[] = "22233344455566677778889999";
+
+    const QString lower = value.toLower();
+    QString retn;
+    retn.reserve(lower.size());
+    for (int i = 0; i < lower.size(); i++) {
+        const QChar current = lower.at(i);
+        if (current >= QLatin1Char('a') && current <= QLatin1Char('z'))
+            retn.append(QLatin1Char(keys[current.unicode() - 'a']));
+        else
+            retn.append(current);
+    }
+    return retn;
+}
+
+/* Returns the position of the given field in KeypadIndexedFields, or -1 if it is not indexed */
+int QContactMemoryKeypadIndex::indexedField(QContactDetail::DetailType type, int field)
+{
+    for (int i = 0; i < KeypadIndexedFieldCount; i++) {
+        if (KeypadIndexedFields[i].type == type && KeypadIndexedFields[i].field == field)
+            return i;
+    }
+    return -1;
+}
+
+/*
+ * Files the keypad form of each indexed field of each detail of the given \a contact.
+ * A detail without a value for a field has the empty form, since the filter test
+ * compares such a field as an empty string.
+ */
+void QContactMemoryKeypadIndex::insert(const QContact &contact)
+{
+    QVector<QPair<int, QString> > forms;
+    for (int i = 0; i < KeypadIndexedFieldCount; i++) {
+        foreach (const QContactDetail &detail, contact.details(KeypadIndexedFields[i].type)) {
+            const QString form = collated(detail.value(KeypadIndexedFields[i].field).toString());
+            m_contactsByForm[i][form].append(contact.id());
+            forms.append(qMakePair(i, form));
+        }
+    }
+
+    if (!forms.isEmpty())
+        m_forms.insert(contact.id(), forms);
+    invalidateLastLookup();
+}
+
+/* Removes the forms filed by insert() for the given \a contact */
+void QContactMemoryKeypadIndex::remove(const QContact &contact)
+{
+    const QVector<QPair<int, QString> > forms = m_forms.take(contact.id());
+    for (int i = 0; i < forms.size(); i++) {
+        QMap<QString, QList<QContactId> > &contactsByForm(m_contactsByForm[forms.at(i).first]);
+        QMap<QString, QList<QContactId> >::iterator it = contactsByForm.find(forms.at(i).second);
+        if (it == contactsByForm.end())
+            continue;
+        it->removeOne(contact.id());
+        if (it->isEmpty())
+            contactsByForm.erase(it);
+    }
+    invalidateLastLookup();
+}
+
+void QContactMemoryKeypadIndex::clear()
+{
+    m_contactsByForm = QVector<QMap<QString, QList<QContactId> > >(KeypadIndexedFieldCount);
+    m_forms.clear();
+    invalidateLastLookup();
+}
+
+void QContactMemoryKeypadIndex::invalidateLastLookup()
+{
+    QMutexLocker locker(&m_lastLookupMutex);
+    m_lastLookupValid = false;
+    m_lastCandidates.clear();
+}
+
+static bool matchesKeypadQuery(int matchType, const QString &form, const QString &query)
+{
+    if (matchType == QContactFilter::MatchContains)
+        return form.contains(query);
+    if (matchType == QContactFilter::MatchStartsWith)
+        return form.startsWith(query);
+    return form == query;
+}
+
+/*
+ * Adds to \a candidates the ids of the contacts with a keypad form of the given
+ * \a field of a \a type detail which matches the given \a query, which is compared
+ * as it is, without being collated itself.
+ *
+ * Returns false if the field is not indexed, or if the \a matchType is not one of
+ * exact, starts-with and contains, in which case every contact must be tested.
+ */
+bool QContactMemoryKeypadIndex::findCandidates(QContactDetail::DetailType type, int field, const QString &query, int matchType, QSet<QContactId> *candidates) const
+{
+    const int fieldIndex = indexedField(type, field);
+    if (fieldIndex < 0)
+        return false;
+    if (matchType != QContactFilter::MatchExactly
+            && matchType != QContactFilter::MatchStartsWith
+            && matchType != QContactFilter::MatchContains) {
+        return false;
+    }
+
+    QMutexLocker locker(&m_lastLookupMutex);
+
+    const bool extendsLastLookup = m_lastLookupValid
+            && m_lastField == fieldIndex
+            && m_lastMatchType == matchType
+            && (matchType == QContactFilter::MatchContains ? query.contains(m_lastQuery)
+                : matchType == QContactFilter::MatchStartsWith ? query.startsWith(m_lastQuery)
+                : query == m_lastQuery);
+
+    QSet<QContactId> found;
+    if (extendsLastLookup) {
+        // every match of the extended query also matched the last one, so only those need testing
+        foreach (const QContactId &id, m_lastCandidates) {
+            const QVector<QPair<int, QString> > forms = m_forms.value(id);
+            for (int i = 0; i < forms.size(); i++) {
+                if (forms.at(i).first == fieldIndex && matchesKeypadQuery(matchType, forms.at(i).second, query)) {
+                    found.insert(id);
+                    break;
+                }
+            }
+        }
+    } else {
+        const QMap<QString, QList<QContactId> > &contactsByForm(m_contactsByForm.at(fieldIndex));
+        QMap<QString, QList<QContactId> >::const_iterator it, end = contactsByForm.constEnd();
+        if (matchType == QContactFilter::MatchContains) {
+            for (it = contactsByForm.constBegin(); it != end; ++it) {
+                if (it.key().contains(query)) {
+                    foreach (const QContactId &id, *it)
+                        found.insert(id);
+                }
+            }
+        } else {
+            // the forms starting with the query sort together, from the query itself onwards
+            for (it = contactsByForm.lowerBound(query); it != end && it.key().startsWith(query); ++it) {
+                if (matchType == QContactFilter::MatchExactly && it.key() != query)
+                    break;
+                foreach (const QContactId &id, *it)
+                    found.insert(id);
+            }
+        }
+    }
+
+    m_lastLookupValid = true;
+    m_lastField = fieldIndex;
+    m_lastMatchType = matchType;
+    m_lastQuery = query;
+    m_lastCandidates = found;
+
+    candidates->unite(found);
+    return true;
+}
+
+/* The fields covered by the full-text index: those which free-text searches look through */
+static const struct {
+    QContactDetail::DetailType type;
+    int field;
+} TextIndexedFields[] = {
+    { QContactName::Type, QContactName::FieldPrefix },
+    { QContactName::Type, QContactName::FieldFirstName },
+    { QContactName::Type, QContactName::FieldMiddleName },
+    { QContactName::Type, QContactName::FieldLastName },
+    { QContactName::Type, QContactName::FieldSuffix },
+    { QContactName::Type, QContactName::FieldCustomLabel },
+    { QContactNickname::Type, QContactNickname::FieldNickname },
+    { QContactDisplayLabel::Type, QContactDisplayLabel::FieldLabel },
+    { QContactEmailAddress::Type, QContactEmailAddress::FieldEmailAddress },
+    { QContactNote::Type, QContactNote::FieldNote },
+    { QContactOrganization::Type, QContactOrganization::FieldName },
+    { QContactOrganization::Type, QContactOrganization::FieldLocation },
+    { QContactOrganization::Type, QContactOrganization::FieldRole },
+    { QContactOrganization::Type, QContactOrganization::FieldTitle },
+    { QContactAddress::Type, QContactAddress::FieldStreet },
+    { QContactAddress::Type, QContactAddress::FieldLocality },
+    { QContactAddress::Type, QContactAddress::FieldRegion },
+    { QContactAddress::Type, QContactAddress::FieldPostcode },
+    { QContactAddress::Type, QContactAddress::FieldCountry },
+    { QContactAddress::Type, QContactAddress::FieldPostOfficeBox }
+};
+static const int TextIndexedFieldCount = sizeof(TextIndexedFields) / sizeof(TextIndexedFields[0]);
+
+/* Delimit indexed texts, so that trigrams can anchor a query to the start or end of a value */
+static const QChar TextStart(0x0002);
+static const QChar TextEnd(0x0003);
+
+static inline quint64 trigramAt(const QString &text, int i)
+{
+    return (quint64(text.at(i).unicode()) << 32) | (quint64(text.at(i + 1).unicode()) << 16) | text.at(i + 2).unicode();
+}
+
+QContactMemoryTextIndex::QContactMemoryTextIndex()
+    : m_contactsByTrigram(TextIndexedFieldCount)
+    , m_contactsByCollationKey(TextIndexedFieldCount)
+{
+    m_collator.setCaseSensitivity(Qt::CaseSensitive);
+}
+
+bool QContactMemoryTextIndex::isIndexed(QContactDetail::DetailType type, int field)
+{
+    return indexedField(type, field) >= 0;
+}
+
+/* Returns the position of the given field in TextIndexedFields, or -1 if it is not indexed */
+int QContactMemoryTextIndex::indexedField(QContactDetail::DetailType type, int field)
+{
+    for (int i = 0; i < TextIndexedFieldCount; i++) {
+        if (TextIndexedFields[i].type == type && TextIndexedFields[i].field == field)
+            return i;
+    }
+    return -1;
+}
+
+/* Returns the case folded \a value, delimited by the start and end markers */
+QString QContactMemoryTextIndex::delimitedText(const QString &value)
+{
+    return TextStart + value.toCaseFolded() + TextEnd;
+}
+
+QSet<quint64> QContactMemoryTextIndex::trigrams(const QString &text)
+{
+    QSet<quint64> retn;
+    for (int i = 0; i + 3 <= text.size(); i++)
+        retn.insert(trigramAt(text, i));
+    return retn;
+}
+
+/* Returns the collation keys of the given \a value, as compared by case sensitive and case insensitive filters */
+QList<QCollatorSortKey> QContactMemoryTextIndex::collationKeys(const QString &value) const
+{
+    QList<QCollatorSortKey> keys;
+    keys.append(m_collator.sortKey(value));
+    const QString folded = value.toCaseFolded();
+    if (folded != value)
+        keys.append(m_collator.sortKey(folded));
+    return keys;
+}
+
+/* Files the delimited, case folded text and the collation keys of each indexed field of the given \a contact */
+void QContactMemoryTextIndex::insert(const QContact &contact)
+{
+    QVector<QPair<int, QString> > values;
+    for (int i = 0; i < TextIndexedFieldCount; i++) {
+        foreach (const QContactDetail &detail, contact.details(TextIndexedFields[i].type)) {
+            const QString value = detail.value(TextIndexedFields[i].field).toString();
+            foreach (quint64 trigram, trigrams(delimitedText(value)))
+                m_contactsByTrigram[i][trigram].insert(contact.id());
+            foreach (const QCollatorSortKey &key, collationKeys(value))
+                m_contactsByCollationKey[i][key].insert(contact.id());
+            values.append(qMakePair(i, value));
+        }
+    }
+
+    if (!values.isEmpty())
+        m_values.insert(contact.id(), values);
+}
+
+/* Removes the entries filed by insert() for the given \a contact */
+void QContactMemoryTextIndex::remove(const QContact &contact)
+{
+    const QVector<QPair<int, QString> > values = m_values.take(contact.id());
+    for (int i = 0; i < values.size(); i++) {
+        QHash<quint64, QSet<QContactId> > &contactsByTrigram(m_contactsByTrigram[values.at(i).first]);
+        foreach (quint64 trigram, trigrams(delimitedText(values.at(i).second))) {
+            QHash<quint64, QSet<QContactId> >::iterator it = contactsByTrigram.find(trigram);
+            if (it == contactsByTrigram.end())
+                continue;
+            it->remove(contact.id());
+            if (it->isEmpty())
+                contactsByTrigram.erase(it);
+        }
+
+        QMap<QCollatorSortKey, QSet<QContactId> > &contactsByCollationKey(m_contactsByCollationKey[values.at(i).first]);
+        foreach (const QCollatorSortKey &key, collationKeys(values.at(i).second)) {
+            QMap<QCollatorSortKey, QSet<QContactId> >::iterator it = contactsByCollationKey.find(key);
+            if (it == contactsByCollationKey.end())
+                continue;
+            it->remove(contact.id());
+            if (it->isEmpty())
+                contactsByCollationKey.erase(it);
+        }
+    }
+}
+
+static bool fewerContacts(const QSet<QContactId> *a, const QSet<QContactId> *b)
+{
+    return a->size() < b->size();
+}
+
+/*
+ * Adds to \a candidates the ids of the contacts with a text in the given \a field
+ * of a \a type detail which contains every trigram of the given \a query, or which
+ * collates equal to the query.
+ *
+ * Returns false if the field is not indexed, or if the query delimited as the
+ * \a matchType requires is shorter than a trigram, in which case every contact
+ * must be tested.
+ */
+bool QContactMemoryTextIndex::findCandidates(QContactDetail::DetailType type, int field, const QString &query, int matchType, QSet<QContactId> *candidates) const
+{
+    const int fieldIndex = indexedField(type, field);
+    if (fieldIndex < 0)
+        return false;
+
+    QString pattern = query.toCaseFolded();
+    switch (matchType) {
+    case QContactFilter::MatchContains:
+        break;
+    case QContactFilter::MatchStartsWith:
+        pattern.prepend(TextStart);
+        break;
+    case QContactFilter::MatchEndsWith:
+        pattern.append(TextEnd);
+        break;
+    case QContactFilter::MatchExactly:
+        pattern = TextStart + pattern + TextEnd;
+        break;
+    default:
+        return false;
+    }
+    if (pattern.size() < 3)
+        return false;
+
+    // a value which collates equal to the query matches whatever the match type; see
+    // QContactCompiledFilter.  The query is collated like the values are, with and
+    // without case folding.
+    QCollator collator;
+    collator.setCaseSensitivity(Qt::CaseSensitive);
+    const QMap<QCollatorSortKey, QSet<QContactId> > &contactsByCollationKey(m_contactsByCollationKey.at(fieldIndex));
+    const QStringList forms = QStringList() << query << query.toCaseFolded();
+    foreach (const QString &form, forms) {
+        QMap<QCollatorSortKey, QSet<QContactId> >::const_iterator it = contactsByCollationKey.constFind(collator.sortKey(form));
+        if (it != contactsByCollationKey.constEnd())
+            candidates->unite(it.value());
+    }
+
+    const QHash<quint64, QSet<QContactId> > &contactsByTrigram(m_contactsByTrigram.at(fieldIndex));
+    QVector<const QSet<QContactId> *> postings;
+    for (int i = 0; i + 3 <= pattern.size(); i++) {
+        QHash<quint64, QSet<QContactId> >::const_iterator it = contactsByTrigram.constFind(trigramAt(pattern, i));
+        if (it == contactsByTrigram.constEnd())
+            return true; // no indexed text contains this trigram, so nothing matches
+        postings.append(&it.value());
+    }
+
+    // intersect from the rarest trigram up, so that each step tests the fewest contacts
+    std::sort(postings.begin(), postings.end(), fewerContacts);
+    QSet<QContactId> found = *postings.first();
+    for (int i = 1; i < postings.size() && !found.isEmpty(); i++)
+        found.intersect(*postings.at(i));
+
+    candidates->unite(found);
+    return true;
+}
+
+QContactMemoryChangeLogIndex::QContactMemoryChangeLogIndex()
+    : m_removedCount(0)
+{
+}
+
+/* Files the given \a contact under the times of its timestamp, if it has one */
+void QContactMemoryChangeLogIndex::insert(const QContact &contact)
+{
+    const QContactTimestamp ts = contact.detail(QContactTimestamp::Type);
+    if (ts.isEmpty())
+        return; // never matched by a change log filter
+    insert(&m_created, ts.created(), contact.id());
+    insert(&m_modified, ts.lastModified(), contact.id());
+}
+
+/* Removes the entries filed by insert() for the given \a contact, which must be unchanged since */
+void QContactMemoryChangeLogIndex::remove(const QContact &contact)
+{
+    const QContactTimestamp ts = contact.detail(QContactTimestamp::Type);
+    if (ts.isEmpty())
+        return;
+    remove(&m_created, ts.created(), contact.id());
+    remove(&m_modified, ts.lastModified(), contact.id());
+}
+
+/*
+ * Records that the contact identified by \a contactId was removed at the time \a removed;
+ * once more than MaximumRemoved removals are recorded, the earliest is forgotten.
+ */
+void QContactMemoryChangeLogIndex::insertRemoved(const QContactId &contactId, const QDateTime &removed)
+{
+    insert(&m_removed, removed, contactId);
+    if (++m_removedCount <= MaximumRemoved)
+        return;
+
+    TimeIndex::iterator earliest = m_removed.begin();
+    earliest->removeFirst();
+    if (earliest->isEmpty())
+        m_removed.erase(earliest);
+    --m_removedCount;
+}
+
+/*
+ * Adds to \a candidates the ids of the stored contacts which were added (or changed) at
+ * or after \a since, as a change log filter with the given \a eventType matches them.
+ * Removed contacts are not stored, so they are never candidates.
+ */
+void QContactMemoryChangeLogIndex::findCandidates(QContactChangeLogFilter::EventType eventType, const QDateTime &since, QSet<QContactId> *candidates) const
+{
+    if (eventType == QContactChangeLogFilter::EventRemoved)
+        return;
+
+    const TimeIndex &index = eventType == QContactChangeLogFilter::EventAdded ? m_created : m_modified;
+    TimeIndex::const_iterator it = index.lowerBound(since);
+    for ( ; it != index.constEnd(); ++it) {
+        foreach (const QContactId &id, it.value())
+            candidates->insert(id);
+    }
+}
+
+/*
+ * Returns the ids of the contacts removed at or after \a since, in the order of their removal.
+ * Only the latest MaximumRemoved removals are known, so if \a since is earlier than those,
+ * the earlier removals are missing from the result.
+ */
+QList<QContactId> QContactMemoryChangeLogIndex::removedSince(const QDateTime &since) const
+{
+    QList<QContactId> retn;
+    TimeIndex::const_iterator it = m_removed.lowerBound(since);
+    for ( ; it != m_removed.constEnd(); ++it)
+        retn += it.value();
+    return retn;
+}
+
+void QContactMemoryChangeLogIndex::insert(TimeIndex *index, const QDateTime &time, const QContactId &contactId)
+{
+    (*index)[time].append(contactId);
+}
+
+void QContactMemoryChangeLogIndex::remove(TimeIndex *index, const QDateTime &time, const QContactId &contactId)
+{
+    TimeIndex::iterator it = index->find(time);
+    if (it == index->end())
+        return;
+    it->removeOne(contactId);
+    if (it->isEmpty())
+        index->erase(it);
+}
+
+QContactMemoryChangeJournal::QContactMemoryChangeJournal()
+    : m_revision(0), m_oldestRevision(0)
+{
+}
+
+/* Records the contacts added, changed and removed in \a changeSet as the next revision */
+void QContactMemoryChangeJournal::record(const QContactChangeSet &changeSet)
+{
+    const QSet<QContactId> added = changeSet.addedContacts();
+    const QList<QContactChangeSet::ContactChangeList> changed = changeSet.changedContacts();
+    const QSet<QContactId> removed = changeSet.removedContacts();
+    if (added.isEmpty() && changed.isEmpty() && removed.isEmpty() && !changeSet.dataChanged())
+        return;
+
+    ++m_revision;
+    if (changeSet.dataChanged()) {
+        // which contacts changed is not known, so nor are the changes since any earlier revision
+        m_entries.clear();
+        m_oldestRevision = m_revision;
+        return;
+    }
+
+    Entry entry;
+    entry.added = added.toList();
+    entry.changed = changed;
+    entry.removed = removed.toList();
+    m_entries.append(entry);
+    if (m_entries.size() > MaximumEntries) {
+        m_entries.removeFirst();
+        ++m_oldestRevision;
+    }
+}
+
+/*
+ * Returns the changes made since \a revision, merged into a single change set.  Sets
+ * \a error to LimitReachedError if the journal no longer reaches back to \a revision,
+ * or to BadArgumentError if \a revision is later than the current revision.
+ */
+QContactChangeSet QContactMemoryChangeJournal::changesSince(quint64 revision, QContactManager::Error *error) const
+{
+    QContactChangeSet retn;
+    if (revision > m_revision) {
+        *error = QContactManager::BadArgumentError;
+        return retn;
+    }
+    if (revision < m_oldestRevision) {
+        *error = QContactManager::LimitReachedError;
+        return retn;
+    }
+
+    // the entries are consecutive revisions, ending with the current one
+    QSet<QContactId> added;
+    QHash<QContactId, QList<QContactDetail::DetailType> > changed; // an empty list of types means that any may have changed
+    QSet<QContactId> removed;
+    for (int i = m_entries.size() - int(m_revision - revision); i < m_entries.size(); ++i) {
+        const Entry &entry = m_entries.at(i);
+        foreach (const QContactId &id, entry.added) {
+            // a contact removed and added again since the revision may differ in anything
+            if (removed.remove(id))
+                changed.insert(id, QList<QContactDetail::DetailType>());
+            else
+                added.insert(id);
+        }
+        foreach (const QContactChangeSet::ContactChangeList &change, entry.changed) {
+            foreach (const QContactId &id, change.second) {
+                if (added.contains(id))
+                    continue;
+                QHash<QContactId, QList<QContactDetail::DetailType> >::iterator it = changed.find(id);
+                if (it == changed.end()) {
+                    changed.insert(id, change.first);
+                } else if (!it->isEmpty()) {
+                    if (change.first.isEmpty()) {
+                        it->clear();
+                    } else {
+                        foreach (QContactDetail::DetailType type, change.first) {
+                            if (!it->contains(type))
+                                it->append(type);
+                        }
+                    }
+                }
+            }
+        }
+        foreach (const QContactId &id, entry.removed) {
+            changed.remove(id);
+            if (!added.remove(id))
+                removed.insert(id);
+        }
+    }
+
+    retn.insertAddedContacts(added.toList());
+    for (QHash<QContactId, QList<QContactDetail::DetailType> >::const_iterator it = changed.constBegin(); it != changed.constEnd(); ++it)
+        retn.insertChangedContact(it.key(), it.value());
+    retn.insertRemovedContacts(removed.toList());
+    *error = QContactManager::NoError;
+    return retn;
+}
+
+QT_END_NAMESPACE_CONTACTS
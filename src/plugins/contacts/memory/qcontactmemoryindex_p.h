@@ -0,0 +1,258 @@
+/****************************************************************************
+**
+** Copyright (C) 2017 The Qt Company Ltd.
+** Contact: https://www.qt.io/licensing/
+**
+** This file is part of the QtContacts module of the Qt Toolkit.
+**
+** $QT_BEGIN_LICENSE:LGPL$
+** Commercial License Usage
+** Licensees holding valid commercial Qt licenses may use this file in
+** accordance with the commercial license agreement provided with the
+** Software or, alternatively, in accordance with the terms contained in
+** a written agreement between you and The Qt Company. For licensing terms
+** and conditions see https://www.qt.io/terms-conditions. For further
+** information use the contact form at https://www.qt.io/contact-us.
+**
+** GNU Lesser General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU Lesser
+** General Public License version 3 as published by the Free Software
+** Foundation and appearing in the file LICENSE.LGPL3 included in the
+** packaging of this file. Please review the following information to
+** ensure the GNU Lesser General Public License version 3 requirements
+** will be met: https://www.gnu.org/licenses/lgpl-3.0.html.
+**
+** GNU General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU
+** General Public License version 2.0 or (at your option) the GNU General
+** Public license version 3 or any later version approved by the KDE Free
+** Qt Foundation. The licenses are as published by the Free Software
+** Foundation and appearing in the file LICENSE.GPL2 and LICENSE.GPL3
+** included in the packaging of this file. Please review the following
+** information to ensure the GNU General Public License requirements will
+** be met: https://www.gnu.org/licenses/gpl-2.0.html and
+** https://www.gnu.org/licenses/gpl-3.0.html.
+**
+** $QT_END_LICENSE$
+**
+****************************************************************************/
+
+
+#ifndef QCONTACTMEMORYINDEX_P_H
+#define QCONTACTMEMORYINDEX_P_H
+
+//
+//  W A R N I N G
+//  -------------
+//
+// This file is not part of the Qt API.  It exists purely as an
+// implementation detail.  This header file may change from version to
+// version without notice, or even be removed.
+//
+// We mean it.
+//
+
+#include <QtCore/qcollator.h>
+#include <QtCore/qdatetime.h>
+#include <QtCore/qhash.h>
+#include <QtCore/qlist.h>
+#include <QtCore/qmap.h>
+#include <QtCore/qmutex.h>
+#include <QtCore/qpair.h>
+#include <QtCore/qset.h>
+#include <QtCore/qstring.h>
+#include <QtCore/qvector.h>
+
+#include <QtContacts/qcontact.h>
+#include <QtContacts/qcontactchangelogfilter.h>
+#include <QtContacts/qcontactchangeset.h>
+#include <QtContacts/qcontactmanager.h>
+
+QT_BEGIN_NAMESPACE_CONTACTS
+
+/*
+ * An index of the phone numbers of the stored contacts, for MatchPhoneNumber filters.
+ *
+ * Each number is reduced to its digits once, when the contact is saved, and filed
+ * under its rightmost seven digits (or all of them, for shorter numbers); those are
+ * the digits which MatchPhoneNumber always compares.  A caller-id lookup then costs
+ * one hash of the query's digits, rather than a pass over every stored contact.
+ *
+ * The index only narrows the search: the contacts it returns are candidates, which
+ * must still be tested against the filter itself.
+ */
+class QContactMemoryPhoneNumberIndex
+{
+public:
+    void insert(const QContact &contact);
+    void remove(const QContact &contact);
+    void clear() { m_contactsBySuffix.clear(); }
+
+    bool findCandidates(const QString &number, int matchType, QSet<QContactId> *candidates) const;
+
+    static QString digits(const QString &number);
+
+private:
+    QHash<QString, QList<QContactId> > m_contactsBySuffix; // one entry per indexed number
+};
+
+/*
+ * An index of the keypad (ITU-T) forms of the name, nickname and display label
+ * fields of the stored contacts, for MatchKeypadCollation filters.
+ *
+ * Each field value is collated once, when the contact is saved.  The forms of each
+ * field are kept in an ordered map, which serves as the prefix index: the forms
+ * starting with a query are a contiguous range of its keys.  Contains queries test
+ * the distinct stored forms, without collating anything again.
+ *
+ * Dialer-style searches extend the query one key press at a time, and the matches
+ * of an extended query are a subset of those of the previous query; so the last
+ * lookup is remembered, and narrowed rather than repeated when the next query
+ * extends it.
+ *
+ * As with the phone number index, the contacts returned are candidates, which must
+ * still be tested against the filter itself.
+ */
+class QContactMemoryKeypadIndex
+{
+public:
+    QContactMemoryKeypadIndex();
+
+    void insert(const QContact &contact);
+    void remove(const QContact &contact);
+    void clear();
+
+    bool findCandidates(QContactDetail::DetailType type, int field, const QString &query, int matchType, QSet<QContactId> *candidates) const;
+
+    static QString collated(const QString &value);
+
+private:
+    static int indexedField(QContactDetail::DetailType type, int field);
+    void invalidateLastLookup();
+
+    QVector<QMap<QString, QList<QContactId> > > m_contactsByForm; // for each indexed field, the contacts with each form
+    QHash<QContactId, QVector<QPair<int, QString> > > m_forms;     // the indexed fields and forms of each contact
+
+    mutable QMutex m_lastLookupMutex;
+    mutable bool m_lastLookupValid;
+    mutable int m_lastField;
+    mutable int m_lastMatchType;
+    mutable QString m_lastQuery;
+    mutable QSet<QContactId> m_lastCandidates;
+};
+
+/*
+ * An optional full-text index of the name, nickname, display label, email, note,
+ * organization and address fields of the stored contacts, for detail filters which
+ * match with MatchContains, MatchStartsWith, MatchEndsWith or MatchFixedString.
+ *
+ * Each field value is case folded, delimited by start and end markers, and filed
+ * under each run of three characters (trigram) it contains.  A value can only match
+ * a query if it contains every trigram of the query, delimited as its match type
+ * requires, so the contacts filed under all of them are the candidates.
+ *
+ * String filters also accept a value which compares equal to the query under the
+ * locale's collation, whatever their match type.  Each value is therefore also filed
+ * under its collation keys, with and without case folding, and the values which
+ * collate equal to the query are candidates as well.
+ */
+class QContactMemoryTextIndex
+{
+public:
+    QContactMemoryTextIndex();
+
+    void insert(const QContact &contact);
+    void remove(const QContact &contact);
+
+    static bool isIndexed(QContactDetail::DetailType type, int field);
+    bool findCandidates(QContactDetail::DetailType type, int field, const QString &query, int matchType, QSet<QContactId> *candidates) const;
+
+private:
+    static int indexedField(QContactDetail::DetailType type, int field);
+    static QString delimitedText(const QString &value);
+    static QSet<quint64> trigrams(const QString &text);
+    QList<QCollatorSortKey> collationKeys(const QString &value) const;
+
+    QVector<QHash<quint64, QSet<QContactId> > > m_contactsByTrigram;              // for each indexed field, the contacts with each trigram
+    QVector<QMap<QCollatorSortKey, QSet<QContactId> > > m_contactsByCollationKey; // for each indexed field, the contacts with each collation key
+    QHash<QContactId, QVector<QPair<int, QString> > > m_values;                   // the indexed fields and values of each contact
+    QCollator m_collator;
+};
+
+/*
+ * An index of the creation and modification times of the stored contacts, and of
+ * the times at which contacts were removed, for QContactChangeLogFilter.
+ *
+ * Each contact is filed under the times of its timestamp detail, in maps ordered by
+ * time, so the contacts added or changed since a time are a contiguous range of the
+ * map.  Removed contacts leave a tombstone, so that removals since a time can be
+ * reported too.  Only the latest MaximumRemoved tombstones are kept, as many as the
+ * change journal keeps entries; a query for the removals since an earlier time
+ * reports only those which are still kept.
+ */
+class QContactMemoryChangeLogIndex
+{
+public:
+    enum { MaximumRemoved = 1024 };
+
+    QContactMemoryChangeLogIndex();
+
+    void insert(const QContact &contact);
+    void remove(const QContact &contact);
+    void insertRemoved(const QContactId &contactId, const QDateTime &removed);
+
+    void findCandidates(QContactChangeLogFilter::EventType eventType, const QDateTime &since, QSet<QContactId> *candidates) const;
+    QList<QContactId> removedSince(const QDateTime &since) const;
+
+private:
+    typedef QMap<QDateTime, QList<QContactId> > TimeIndex;
+    static void insert(TimeIndex *index, const QDateTime &time, const QContactId &contactId);
+    static void remove(TimeIndex *index, const QDateTime &time, const QContactId &contactId);
+
+    TimeIndex m_created;  // the contacts created at each time
+    TimeIndex m_modified; // the contacts last modified at each time
+    TimeIndex m_removed;  // the contacts removed at each time, in the order in which they were removed
+    int m_removedCount;   // the number of contacts in m_removed
+};
+
+/*
+ * A bounded journal of the changes made to the stored contacts, for revision based
+ * synchronization.
+ *
+ * Every change set which adds, changes or removes contacts advances the revision by
+ * one, and is kept as a journal entry; once there are more than MaximumEntries, the
+ * oldest is discarded, and the changes since any earlier revision are no longer
+ * known.  A change set which only reports that the data changed (without saying
+ * which contacts) advances the revision and empties the journal.
+ *
+ * The changes since a revision are the entries after it, merged: a contact added and
+ * removed since then is not reported at all, a contact added since then is reported
+ * as added only, and the detail types changed in a contact are merged across entries.
+ */
+class QContactMemoryChangeJournal
+{
+public:
+    enum { MaximumEntries = 1024 };
+
+    QContactMemoryChangeJournal();
+
+    quint64 revision() const { return m_revision; }
+    void record(const QContactChangeSet &changeSet);
+    QContactChangeSet changesSince(quint64 revision, QContactManager::Error *error) const;
+
+private:
+    struct Entry
+    {
+        QList<QContactId> added;
+        QList<QContactChangeSet::ContactChangeList> changed;
+        QList<QContactId> removed;
+    };
+
+    QList<Entry> m_entries;   // one entry for each revision after m_oldestRevision, oldest first
+    quint64 m_revision;       // the current revision
+    quint64 m_oldestRevision; // the earliest revision from which the changes are known
+};
+
+QT_END_NAMESPACE_CONTACTS
+
+#endif // QCONTACTMEMORYINDEX_P_H
@@ -126,9 +126,15 @@ QMultiHash<QString, QContactActionDescriptor> QContactActionServiceManager::desc
     return m_descriptorHash;
 }
 
+QObject *QContactActionServiceManager::changeNotifier()
+{
+    return this;
+}
+
 void QContactActionServiceManager::serviceAdded(const QString& serviceName)
 {
     QMutexLocker locker(&m_instanceMutex);
+    bool changed = false;
     QList<QServiceInterfaceDescriptor> sids = m_serviceManager.findInterfaces(serviceName);
     foreach (const QServiceInterfaceDescriptor& sid, sids) {
         if (sid.interfaceName() == QContactActionFactory::InterfaceName) {
@@ -142,15 +148,22 @@ void QContactActionServiceManager::serviceAdded(const QString& serviceName)
                 foreach (const QContactActionDescriptor& ad, descriptors) {
                     m_descriptorHash.insert(ad.actionName(), ad); // multihash insert.
                     m_actionFactoryHash.insert(ad, actionFactory);
+                    changed = true;
                 }
             }
         }
     }
+
+    // listeners may ask for our hashes again, so only tell them once we are unlocked.
+    locker.unlock();
+    if (changed)
+        emit descriptorsChanged();
 }
 
 void QContactActionServiceManager::serviceRemoved(const QString& serviceName)
 {
     QMutexLocker locker(&m_instanceMutex);
+    bool changed = false;
     QList<QServiceInterfaceDescriptor> sids = m_serviceManager.findInterfaces(serviceName);
     foreach (const QServiceInterfaceDescriptor& sid, sids) {
         if (sid.interfaceName() == QContactActionFactory::InterfaceName) {
@@ -164,9 +177,14 @@ void QContactActionServiceManager::serviceRemoved(const QString& serviceName)
                 delete m_actionFactoryHash.value(cad);
                 m_actionFactoryHash.remove(cad);
                 m_descriptorHash.remove(cad.actionName(), cad);
+                changed = true;
             }
         }
     }
+
+    locker.unlock();
+    if (changed)
+        emit descriptorsChanged();
 }
 
 #include "moc_qcontactactionservicemanager_p.cpp"
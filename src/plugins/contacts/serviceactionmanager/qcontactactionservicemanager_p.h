@@ -76,6 +76,10 @@ public:
 
     QHash<QContactActionDescriptor, QContactActionFactory*> actionFactoryHash();
     QMultiHash<QString, QContactActionDescriptor> descriptorHash();
+    QObject *changeNotifier();
+
+signals:
+    void descriptorsChanged();
 
 public slots:
     void serviceAdded(const QString& serviceName);
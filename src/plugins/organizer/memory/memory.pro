@@ -5,9 +5,11 @@ PLUGIN_TYPE = organizer
 load(qt_plugin)
 
 HEADERS += \
-    qorganizeritemmemorybackend_p.h
+    qorganizeritemmemorybackend_p.h \
+    qorganizeritemmemoryindex_p.h
 
 SOURCES += \
-    qorganizeritemmemorybackend.cpp
+    qorganizeritemmemorybackend.cpp \
+    qorganizeritemmemoryindex.cpp
 
 OTHER_FILES += memory.json
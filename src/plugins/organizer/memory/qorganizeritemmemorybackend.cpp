@@ -44,11 +44,16 @@
 #include <QtOrganizer/qorganizeritemdetails.h>
 #include <QtOrganizer/qorganizeritemfilters.h>
 #include <QtOrganizer/qorganizeritemrequests.h>
+#include <QtOrganizer/private/qorganizeritemoccurrenceiterator_p.h>
 
 #ifndef QT_NO_DEBUG_STREAM
 #include <QtCore/qdebug.h>
 #endif
+#include <QtCore/qrunnable.h>
+#include <QtCore/qsemaphore.h>
+#include <QtCore/qsharedpointer.h>
 #include <QtCore/qstringbuilder.h>
+#include <QtCore/qthreadpool.h>
 #include <QtCore/quuid.h>
 
 QT_BEGIN_NAMESPACE_ORGANIZER
@@ -66,6 +71,100 @@ QString QOrganizerItemMemoryFactory::managerName() const
     return QString::fromLatin1("memory");
 }
 
+QOrganizerItemMemoryChangeJournal::QOrganizerItemMemoryChangeJournal()
+    : m_revision(0), m_oldestRevision(0)
+{
+}
+
+/*!
+  Records the items added, changed and removed in \a changeSet as the next revision.
+ */
+void QOrganizerItemMemoryChangeJournal::record(const QOrganizerItemChangeSet &changeSet)
+{
+    if (changeSet.addedItems().isEmpty() && changeSet.changedItems().isEmpty()
+            && changeSet.removedItems().isEmpty() && !changeSet.dataChanged()) {
+        return;
+    }
+
+    ++m_revision;
+    if (changeSet.dataChanged()) {
+        // which items changed is not known, so nor are the changes since any earlier revision
+        m_entries.clear();
+        m_oldestRevision = m_revision;
+        return;
+    }
+
+    m_entries.append(changeSet);
+    if (m_entries.size() > MaximumEntries) {
+        m_entries.removeFirst();
+        ++m_oldestRevision;
+    }
+}
+
+/*!
+  Returns the changes made since \a revision, merged into a single change set. Sets \a error to
+  LimitReachedError if the journal no longer reaches back to \a revision, or to BadArgumentError
+  if \a revision is later than the current revision.
+ */
+QOrganizerItemChangeSet QOrganizerItemMemoryChangeJournal::changesSince(quint64 revision, QOrganizerManager::Error *error) const
+{
+    QOrganizerItemChangeSet retn;
+    if (revision > m_revision) {
+        *error = QOrganizerManager::BadArgumentError;
+        return retn;
+    }
+    if (revision < m_oldestRevision) {
+        *error = QOrganizerManager::LimitReachedError;
+        return retn;
+    }
+
+    // the entries are consecutive revisions, ending with the current one
+    QSet<QOrganizerItemId> added;
+    QHash<QOrganizerItemId, QList<QOrganizerItemDetail::DetailType> > changed; // an empty list of types means that any may have changed
+    QSet<QOrganizerItemId> removed;
+    for (int i = m_entries.size() - int(m_revision - revision); i < m_entries.size(); ++i) {
+        const QOrganizerItemChangeSet &entry = m_entries.at(i);
+        foreach (const QOrganizerItemId &id, entry.addedItems()) {
+            // an item removed and added again since the revision may differ in anything
+            if (removed.remove(id))
+                changed.insert(id, QList<QOrganizerItemDetail::DetailType>());
+            else
+                added.insert(id);
+        }
+        foreach (const QOrganizerItemChangeSet::ItemChangeList &change, entry.changedItems()) {
+            foreach (const QOrganizerItemId &id, change.second) {
+                if (added.contains(id))
+                    continue;
+                QHash<QOrganizerItemId, QList<QOrganizerItemDetail::DetailType> >::iterator it = changed.find(id);
+                if (it == changed.end()) {
+                    changed.insert(id, change.first);
+                } else if (!it->isEmpty()) {
+                    if (change.first.isEmpty()) {
+                        it->clear();
+                    } else {
+                        foreach (QOrganizerItemDetail::DetailType type, change.first) {
+                            if (!it->contains(type))
+                                it->append(type);
+                        }
+                    }
+                }
+            }
+        }
+        foreach (const QOrganizerItemId &id, entry.removedItems()) {
+            changed.remove(id);
+            if (!added.remove(id))
+                removed.insert(id);
+        }
+    }
+
+    retn.insertAddedItems(added.toList());
+    for (QHash<QOrganizerItemId, QList<QOrganizerItemDetail::DetailType> >::const_iterator it = changed.constBegin(); it != changed.constEnd(); ++it)
+        retn.insertChangedItem(it.key(), it.value());
+    retn.insertRemovedItems(removed.toList());
+    *error = QOrganizerManager::NoError;
+    return retn;
+}
+
 /*!
   \class QOrganizerItemMemoryEngine
   \brief The QOrganizerItemMemoryEngine class provides an in-memory implementation
@@ -79,6 +178,18 @@ QString QOrganizerItemMemoryFactory::managerName() const
   identified by the "id" parameter from the given parameters if it exists, or a new,
   anonymous store if it does not.
 
+  If the "parallelFilterThreshold" parameter is a positive number, fetches of items (but not
+  exports) which test at least that many items split the items into chunks, which are
+  filtered on the global thread pool; the results are the same as when the items are
+  filtered one by one.  Smaller fetches are always filtered in the calling thread.
+
+  The time spans of the items are indexed, so that a fetch limited to a period only tests
+  the items (and recurring series) which overlap it, in the order of their ids.
+
+  The store keeps a revision, which advances whenever items are added, changed or removed,
+  and a journal of the changes made in the last QOrganizerItemMemoryChangeJournal::MaximumEntries
+  revisions, from which changesSince() is answered.
+
   Data stored in this engine is only available in the current process.
 
   This engine supports sharing, so an internal reference count is increased
@@ -94,7 +205,8 @@ Q_GLOBAL_STATIC(EngineDatas, theEngineDatas);
 QOrganizerItemMemoryEngineData::QOrganizerItemMemoryEngineData()
     : QSharedData(),
     m_nextOrganizerItemId(1),
-    m_nextOrganizerCollectionId(2)
+    m_nextOrganizerCollectionId(2),
+    m_parallelFilterThreshold(0)
 {
 
 }
@@ -121,6 +233,8 @@ QOrganizerItemMemoryEngine* QOrganizerItemMemoryEngine::createMemoryEngine(const
         }
     }
     data->ref.ref();
+    if (parameters.contains(QStringLiteral("parallelFilterThreshold")))
+        data->m_parallelFilterThreshold = qMax(0, parameters.value(QStringLiteral("parallelFilterThreshold")).toInt());
     return new QOrganizerItemMemoryEngine(data);
 }
 
@@ -205,10 +319,71 @@ QList<QOrganizerItemId> QOrganizerItemMemoryEngine::itemIds(const QOrganizerItem
                                                             const QList<QOrganizerItemSortOrder> &sortOrders,
                                                             QOrganizerManager::Error *error)
 {
-    if (startDateTime.isNull() && endDateTime.isNull() && filter.type() == QOrganizerItemFilter::DefaultFilter && sortOrders.count() == 0)
+    if (startDateTime.isNull() && endDateTime.isNull() && filter.type() == QOrganizerItemFilter::DefaultFilter && sortOrders.count() == 0) {
         return d->m_idToItemHash.keys();
-    else
+    } else if (sortOrders.isEmpty()) {
+        // nothing to sort, so the items themselves need not be collected
+        *error = QOrganizerManager::NoError;
+        return matchingItemIds(startDateTime, endDateTime, filter);
+    } else {
         return QOrganizerManager::extractIds(itemsForExport(startDateTime, endDateTime, filter, sortOrders, QOrganizerItemFetchHint(), error));
+    }
+}
+
+int QOrganizerItemMemoryEngine::itemCount(const QOrganizerItemFilter &filter, const QDateTime &startDateTime,
+                                          const QDateTime &endDateTime, QOrganizerManager::Error *error)
+{
+    *error = QOrganizerManager::NoError;
+    if (startDateTime.isNull() && endDateTime.isNull() && filter.type() == QOrganizerItemFilter::DefaultFilter)
+        return d->m_idToItemHash.count();
+    return matchingItemIds(startDateTime, endDateTime, filter).count();
+}
+
+/* Sets \a lowerBound and \a upperBound to the start and end (or due) times of the \a exception */
+static void exceptionBounds(const QOrganizerItem &exception, QDateTime *lowerBound, QDateTime *upperBound)
+{
+    if (exception.type() == QOrganizerItemType::TypeEventOccurrence) {
+        QOrganizerEventOccurrence instance = exception;
+        *lowerBound = instance.startDateTime();
+        *upperBound = instance.endDateTime();
+    } else {
+        QOrganizerTodoOccurrence instance = exception;
+        *lowerBound = instance.startDateTime();
+        *upperBound = instance.dueDateTime();
+    }
+}
+
+/* Returns true if the occurrence of \a parentItem at \a dateTime is generated by its recurrence
+ * dates or rules, and excluded by its exception dates or rules; its exceptions replace only such
+ * an occurrence.  \a initialDateTime is the time of the first occurrence of the series. */
+static bool isReplacedOccurrence(const QOrganizerItem &parentItem, const QDateTime &initialDateTime, const QDateTime &dateTime)
+{
+    const QOrganizerItemRecurrence recur = parentItem.detail(QOrganizerItemDetail::TypeRecurrence);
+    const QDate localDate(dateTime.toLocalTime().date());
+
+    bool generated = !recur.recurrenceDates().isEmpty()
+            && (dateTime == initialDateTime || recur.recurrenceDates().contains(localDate));
+    foreach (const QOrganizerRecurrenceRule &rrule, recur.recurrenceRules()) {
+        if (generated)
+            break;
+        if (rrule.frequency() != QOrganizerRecurrenceRule::Invalid) {
+            QOrganizerRecurrenceRuleIterator rdates(initialDateTime, rrule, dateTime);
+            generated = rdates.peekNext() == dateTime;
+        }
+    }
+    if (!generated)
+        return false;
+
+    if (recur.exceptionDates().contains(localDate))
+        return true;
+    foreach (const QOrganizerRecurrenceRule &xrule, recur.exceptionRules()) {
+        if (xrule.frequency() != QOrganizerRecurrenceRule::Invalid) {
+            QOrganizerRecurrenceRuleIterator xdates(initialDateTime, xrule, dateTime);
+            if (xdates.peekNext() == dateTime)
+                return true;
+        }
+    }
+    return false;
 }
 
 QList<QOrganizerItem> QOrganizerItemMemoryEngine::internalItemOccurrences(const QOrganizerItem& parentItem, const QDateTime& periodStart, const QDateTime& periodEnd, int maxCount, bool includeExceptions, bool sortItems, QList<QDate> *exceptionDates, QOrganizerManager::Error* error) const
@@ -240,7 +415,8 @@ QList<QOrganizerItem> QOrganizerItemMemoryEngine::internalItemOccurrences(const
     }
 
     if (!periodEnd.isValid()) {
-        // If no endDateTime is given, we'll only generate items that occur within the next 4 years of realPeriodStart.
+        // If no endDateTime is given, we'll only generate items that occur within the next 4 years of realPeriodStart,
+        // unless only the first maxCount of them are wanted.
         realPeriodEnd.setDate(realPeriodStart.date().addDays(1461));
         realPeriodEnd.setTime(realPeriodStart.time());
     }
@@ -249,35 +425,55 @@ QList<QOrganizerItem> QOrganizerItemMemoryEngine::internalItemOccurrences(const
         return QList<QOrganizerItem>();
     }
 
-    QList<QOrganizerItem> retn;
-    QList<QOrganizerItem> xoccurrences;
-    QOrganizerItemRecurrence recur = parentItem.detail(QOrganizerItemDetail::TypeRecurrence);
+    if (maxCount > 0 && !exceptionDates && initialDateTime.isValid()) {
+        // take the first maxCount occurrences from the series in time order, rather than
+        // generating all of those in the period and dropping the rest.  The result must be the
+        // same as the first maxCount of the full expansion below, so the exceptions included are
+        // chosen by the same rules, and are merged in by the same times it sorts them by.  Only the
+        // period end differs: without an endDateTime, the occurrences are not limited to the next
+        // 4 years, so that maxCount of them are returned however far apart they are.
+        const bool bounded = periodEnd.isValid();
+        QMultiMap<QDateTime, QOrganizerItem> sortedExceptions;
+        if (includeExceptions) {
+            foreach (const QOrganizerItem &exception, exceptionItems(parentItem.id())) {
+                const QOrganizerItemParent parent = exception.detail(QOrganizerItemDetail::TypeParent);
+                QDateTime originalDateTime(initialDateTime.toLocalTime());
+                originalDateTime.setDate(parent.originalDate());
+                originalDateTime = originalDateTime.toUTC();
+                if (!originalDateTime.isValid() || originalDateTime < realPeriodStart || (bounded && originalDateTime > realPeriodEnd))
+                    continue;
 
-    if (includeExceptions) {
-        // first, retrieve all persisted instances (exceptions) which occur between the specified datetimes.
-        foreach (const QOrganizerItem& item, d->m_idToItemHash) {
-            if (item.detail(QOrganizerItemDetail::TypeParent).value<QOrganizerItemId>(QOrganizerItemParent::FieldParentId) == parentItem.id()) {
                 QDateTime lowerBound;
                 QDateTime upperBound;
-                if (item.type() == QOrganizerItemType::TypeEventOccurrence) {
-                    QOrganizerEventOccurrence instance = item;
-                    lowerBound = instance.startDateTime();
-                    upperBound = instance.endDateTime();
-                } else {
-                    QOrganizerTodoOccurrence instance = item;
-                    lowerBound = instance.startDateTime();
-                    upperBound = instance.dueDateTime();
+                exceptionBounds(exception, &lowerBound, &upperBound);
+                if ((lowerBound.isNull() || lowerBound >= realPeriodStart) && (!bounded || upperBound.isNull() || upperBound <= realPeriodEnd)
+                        && isReplacedOccurrence(parentItem, initialDateTime, originalDateTime)) {
+                    QOrganizerManagerEngine::addDefaultSorted(&sortedExceptions, exception);
                 }
+            }
+        }
 
-                if ((lowerBound.isNull() || lowerBound >= realPeriodStart) && (upperBound.isNull() || upperBound <= realPeriodEnd)) {
-                    // this occurrence fulfils the criteria.
-                    xoccurrences.append(item);
-                }
+        QOrganizerItemOccurrenceIteratorPrivate occurrences(parentItem, realPeriodStart, QList<QOrganizerItem>());
+        QMultiMap<QDateTime, QOrganizerItem>::const_iterator exception = sortedExceptions.constBegin();
+        QList<QOrganizerItem> retn;
+        while (retn.size() < maxCount) {
+            const bool occurrenceLeft = occurrences.hasNext() && (!bounded || occurrences.nextDateTime() <= realPeriodEnd);
+            if (exception != sortedExceptions.constEnd() && (!occurrenceLeft || exception.key() < occurrences.nextDateTime())) {
+                retn.append(exception.value());
+                ++exception;
+            } else if (occurrenceLeft) {
+                retn.append(occurrences.next());
+            } else {
+                break;
             }
         }
+        return retn;
     }
 
-    // then, generate the required (unchanged) instances from the parentItem.
+    QList<QOrganizerItem> retn;
+    QOrganizerItemRecurrence recur = parentItem.detail(QOrganizerItemDetail::TypeRecurrence);
+
+    // generate the required (unchanged) instances from the parentItem.
     // before doing that, we have to find out all of the exception dates.
     QList<QDate> xdates;
     foreach (const QDate& xdate, recur.exceptionDates()) {
@@ -291,7 +487,7 @@ QList<QOrganizerItem> QOrganizerItemMemoryEngine::internalItemOccurrences(const
             if (xrule.frequency() != QOrganizerRecurrenceRule::Invalid
                     && ((xrule.limitType() != QOrganizerRecurrenceRule::DateLimit) || (xrule.limitDate() >= localStartDate))) {
                 // we cannot skip it, since it applies in the given time period.
-                QList<QDateTime> xdatetimes = generateDateTimes(initialDateTime, xrule, realPeriodStart, realPeriodEnd, 50); // max count of 50 is arbitrary...
+                QList<QDateTime> xdatetimes = generateDateTimes(initialDateTime, xrule, realPeriodStart, realPeriodEnd, -1);
                 foreach (const QDateTime& xdatetime, xdatetimes)
                     xdates += xdatetime.toLocalTime().date();
             }
@@ -316,7 +512,7 @@ QList<QOrganizerItem> QOrganizerItemMemoryEngine::internalItemOccurrences(const
             if (rrule.frequency() != QOrganizerRecurrenceRule::Invalid
                     && ((rrule.limitType() != QOrganizerRecurrenceRule::DateLimit) || (rrule.limitDate() >= localStartDate))) {
                 // we cannot skip it, since it applies in the given time period.
-                QList<QDateTime> rdatetimes = generateDateTimes(initialDateTime, rrule, realPeriodStart, realPeriodEnd, 50); // max count of 50 is arbitrary...
+                QList<QDateTime> rdatetimes = generateDateTimes(initialDateTime, rrule, realPeriodStart, realPeriodEnd, -1);
                 foreach (const QDateTime& rdatetime, rdatetimes)
                     rdateMap.insert(rdatetime, 0);
             }
@@ -337,10 +533,17 @@ QList<QOrganizerItem> QOrganizerItemMemoryEngine::internalItemOccurrences(const
                 // generate the required instance and add it to the return list.
                 retn.append(QOrganizerManagerEngine::generateOccurrence(parentItem, rdate));
             } else if (includeExceptions) {
-                for (int i = 0; i < xoccurrences.size(); i++) {
-                    QOrganizerItemParent parentDetail = xoccurrences[i].detail(QOrganizerItemDetail::TypeParent);
-                    if (parentDetail.originalDate() == localRDate)
-                        retn.append(xoccurrences[i]);
+                // the persisted instances (exceptions) which replace this one, if they occur between the specified datetimes.
+                foreach (const QOrganizerItemId &exceptionId, d->m_exceptionIndex.exceptions(parentItem.id(), localRDate)) {
+                    const QOrganizerItem exception = item(exceptionId);
+                    QDateTime lowerBound;
+                    QDateTime upperBound;
+                    exceptionBounds(exception, &lowerBound, &upperBound);
+
+                    if ((lowerBound.isNull() || lowerBound >= realPeriodStart) && (upperBound.isNull() || upperBound <= realPeriodEnd)) {
+                        // this occurrence fulfils the criteria.
+                        retn.append(exception);
+                    }
                 }
             } else if (exceptionDates) {
                 exceptionDates->append(localRDate);
@@ -371,6 +574,17 @@ QList<QOrganizerItem> QOrganizerItemMemoryEngine::itemOccurrences(const QOrganiz
     return internalItemOccurrences(parentItem, startDateTime, endDateTime, maxCount, true, true, 0, error);
 }
 
+QOrganizerItemOccurrenceIterator QOrganizerItemMemoryEngine::itemOccurrenceIterator(const QOrganizerItem &parentItem,
+                                                                                    const QDateTime &startDateTime,
+                                                                                    const QOrganizerItemFetchHint &fetchHint,
+                                                                                    QOrganizerManager::Error *error)
+{
+    Q_UNUSED(fetchHint);
+    *error = QOrganizerManager::NoError;
+    // the iterator keeps copies of the parent and its exceptions, so it is unaffected by later saves
+    return createOccurrenceIterator(parentItem, startDateTime, exceptionItems(parentItem.id()));
+}
+
 QList<QOrganizerItem> QOrganizerItemMemoryEngine::items(const QOrganizerItemFilter &filter, const QDateTime &startDateTime,
                                                         const QDateTime &endDateTime, int maxCount,
                                                         const QList<QOrganizerItemSortOrder> &sortOrders,
@@ -378,7 +592,7 @@ QList<QOrganizerItem> QOrganizerItemMemoryEngine::items(const QOrganizerItemFilt
 {
     QList<QOrganizerItem> list;
     if (sortOrders.size() > 0) {
-        list = internalItems(startDateTime, endDateTime, filter, sortOrders, fetchHint, error, false);
+        list = internalItems(startDateTime, endDateTime, filter, sortOrders, maxCount, fetchHint, error, false);
     } else {
         QOrganizerItemSortOrder sortOrder;
         sortOrder.setDetail(QOrganizerItemDetail::TypeEventTime, QOrganizerEventTime::FieldStartDateTime);
@@ -393,13 +607,10 @@ QList<QOrganizerItem> QOrganizerItemMemoryEngine::items(const QOrganizerItemFilt
         sortOrder.setDetail(QOrganizerItemDetail::TypeTodoTime, QOrganizerTodoTime::FieldStartDateTime);
         sortOrders.append(sortOrder);
 
-        list = internalItems(startDateTime, endDateTime, filter, sortOrders, fetchHint, error, false);
+        list = internalItems(startDateTime, endDateTime, filter, sortOrders, maxCount, fetchHint, error, false);
     }
 
-    if (maxCount < 0)
-        return list;
-    else
-        return list.mid(0, maxCount);
+    return list;
 }
 
 QList<QOrganizerItem> QOrganizerItemMemoryEngine::itemsForExport(const QDateTime &startDateTime,
@@ -409,36 +620,38 @@ QList<QOrganizerItem> QOrganizerItemMemoryEngine::itemsForExport(const QDateTime
                                                                  const QOrganizerItemFetchHint &fetchHint,
                                                                  QOrganizerManager::Error *error)
 {
-    return internalItems(startDateTime, endDateTime, filter, sortOrders, fetchHint, error, true);
+    if (filter.type() == QOrganizerItemFilter::IdFilter && startDateTime.isNull() && endDateTime.isNull()) {
+        // an export of given items reads them directly, rather than testing every stored item;
+        // unlike the generated occurrences which the filter is otherwise tested against, a
+        // requested recurring item is itself exported
+        *error = QOrganizerManager::NoError;
+        QList<QOrganizerItem> matches;
+        foreach (const QOrganizerItemId &exportedId, exportedItemIds(QOrganizerItemIdFilter(filter).ids()))
+            matches.append(item(exportedId));
+        QOrganizerManagerEngine::sortItems(&matches, sortOrders);
+        return matches;
+    }
+
+    return internalItems(startDateTime, endDateTime, filter, sortOrders, -1, fetchHint, error, true);
 }
 
 QList<QOrganizerItem> QOrganizerItemMemoryEngine::itemsForExport(const QList<QOrganizerItemId> &ids, const QOrganizerItemFetchHint &fetchHint, QMap<int, QOrganizerManager::Error> *errorMap, QOrganizerManager::Error *error)
 {
-    QOrganizerItemIdFilter filter;
-    filter.setIds(ids);
-
-    QList<QOrganizerItem> unsorted = itemsForExport(QDateTime(), QDateTime(), filter, QOrganizerItemSortOrder(), fetchHint, error);
-
-    // Build an index into the results
-    QHash<QOrganizerItemId, int> idMap; // value is index into unsorted
-    if (*error == QOrganizerManager::NoError) {
-        for (int i = 0; i < unsorted.size(); i++) {
-            idMap.insert(unsorted[i].id(), i);
-        }
-    }
+    Q_UNUSED(fetchHint); // no optimisations are possible in the memory backend; ignore the fetch hint.
 
-    // Build up the results and errors
+    // look each item up directly, rather than testing an id filter against every stored item
     QList<QOrganizerItem> results;
+    results.reserve(ids.size());
     for (int i = 0; i < ids.count(); i++) {
-        QOrganizerItemId id(ids[i]);
-        if (!idMap.contains(id)) {
+        QHash<QOrganizerItemId, QOrganizerItem>::const_iterator it = d->m_idToItemHash.constFind(ids.at(i));
+        if (it == d->m_idToItemHash.constEnd()) {
             if (errorMap)
                 errorMap->insert(i, QOrganizerManager::DoesNotExistError);
             if (*error == QOrganizerManager::NoError)
                 *error = QOrganizerManager::DoesNotExistError;
             results.append(QOrganizerItem());
         } else {
-            results.append(unsorted[idMap[id]]);
+            results.append(it.value());
         }
     }
 
@@ -450,55 +663,250 @@ QOrganizerItem QOrganizerItemMemoryEngine::item(const QOrganizerItemId& organize
     return d->m_idToItemHash.value(organizeritemId);
 }
 
-QList<QOrganizerItem> QOrganizerItemMemoryEngine::internalItems(const QDateTime& startDate, const QDateTime& endDate, const QOrganizerItemFilter& filter, const QList<QOrganizerItemSortOrder>& sortOrders, const QOrganizerItemFetchHint& fetchHint, QOrganizerManager::Error* error, bool forExport) const
+/* Returns the persisted exceptions of the recurring item with the given \a parentId */
+QList<QOrganizerItem> QOrganizerItemMemoryEngine::exceptionItems(const QOrganizerItemId& parentId) const
+{
+    QList<QOrganizerItem> exceptions;
+    if (parentId.isNull())
+        return exceptions;
+    foreach (const QOrganizerItemId &exceptionId, d->m_exceptionIndex.exceptions(parentId))
+        exceptions.append(item(exceptionId));
+    return exceptions;
+}
+
+QList<QOrganizerItem> QOrganizerItemMemoryEngine::internalItems(const QDateTime& startDate, const QDateTime& endDate, const QOrganizerItemFilter& filter, const QList<QOrganizerItemSortOrder>& sortOrders, int maxCount, const QOrganizerItemFetchHint& fetchHint, QOrganizerManager::Error* error, bool forExport) const
 {
     Q_UNUSED(fetchHint); // no optimisations are possible in the memory backend; ignore the fetch hint.
     Q_UNUSED(error);
 
-    QList<QOrganizerItem> sorted;
-    QSet<QOrganizerItemId> parentsAdded;
-    bool isDefFilter = (filter.type() == QOrganizerItemFilter::DefaultFilter);
+    const QVector<const QOrganizerItem *> candidates = candidateItems(startDate, endDate);
+    QList<QOrganizerItem> matches;
+    if (!forExport && d->m_parallelFilterThreshold > 0 && candidates.count() >= d->m_parallelFilterThreshold) {
+        matches = parallelMatchingItems(candidates, startDate, endDate, filter);
+    } else {
+        // collect every matching item first, then sort them all at once.
+        QSet<QOrganizerItemId> parentsAdded;
+        foreach (const QOrganizerItem *c, candidates)
+            addMatchingItem(matches, *c, startDate, endDate, filter, forExport, &parentsAdded);
+    }
+
+    QOrganizerManagerEngine::sortItems(&matches, sortOrders, maxCount);
+    return matches;
+}
+
+/* Returns the stored items which may be within the period from \a startDate to \a endDate:
+ * all of them if neither date is given, or else those whose time spans overlap the period,
+ * in the order of their ids. */
+QVector<const QOrganizerItem*> QOrganizerItemMemoryEngine::candidateItems(const QDateTime& startDate, const QDateTime& endDate) const
+{
+    QVector<const QOrganizerItem *> items;
+    if ((startDate.isNull() && endDate.isNull())
+            || (!startDate.isNull() && !startDate.isValid())
+            || (!endDate.isNull() && !endDate.isValid())) {
+        // an invalid period cannot be placed in time, so every item is tested against it
+        items.reserve(d->m_idToItemHash.count());
+        QHash<QOrganizerItemId, QOrganizerItem>::const_iterator it = d->m_idToItemHash.constBegin();
+        for ( ; it != d->m_idToItemHash.constEnd(); ++it)
+            items.append(&it.value());
+    } else {
+        const QList<QOrganizerItemId> ids = d->m_timeIndex.candidates(startDate, endDate);
+        items.reserve(ids.count());
+        foreach (const QOrganizerItemId &id, ids) {
+            QHash<QOrganizerItemId, QOrganizerItem>::const_iterator it = d->m_idToItemHash.constFind(id);
+            if (it != d->m_idToItemHash.constEnd())
+                items.append(&it.value());
+        }
+    }
+    return items;
+}
+
+/* Appends the item \a c (or, if it recurs, those of its occurrences) to \a matches if it matches
+ * the filter and dates; when exporting, the parents of matching occurrences are appended once. */
+void QOrganizerItemMemoryEngine::addMatchingItem(QList<QOrganizerItem>& matches, const QOrganizerItem& c, const QDateTime& startDate, const QDateTime& endDate, const QOrganizerItemFilter& filter, bool forExport, QSet<QOrganizerItemId>* parentsAdded) const
+{
+    if (itemHasReccurence(c)) {
+        addItemRecurrences(matches, c, startDate, endDate, filter, forExport, parentsAdded);
+    } else {
+        if ((filter.type() == QOrganizerItemFilter::DefaultFilter || QOrganizerManagerEngine::testFilter(filter, c)) && QOrganizerManagerEngine::isItemBetweenDates(c, startDate, endDate)) {
+            matches.append(c);
+            if (forExport
+                    && (c.type() == QOrganizerItemType::TypeEventOccurrence
+                    ||  c.type() == QOrganizerItemType::TypeTodoOccurrence)) {
+                QOrganizerItemId parentId(c.detail(QOrganizerItemDetail::TypeParent).value<QOrganizerItemId>(QOrganizerItemParent::FieldParentId));
+                if (!parentsAdded->contains(parentId)) {
+                    parentsAdded->insert(parentId);
+                    matches.append(item(parentId));
+                }
+            }
+        }
+    }
+}
 
-    foreach(const QOrganizerItem& c, d->m_idToItemHash) {
+/* Returns the IDs of the items which an export of the given filter and dates would return, in the
+ * order in which they are tested; the same items are tested as by addMatchingItem(), but none of
+ * them is copied. */
+QList<QOrganizerItemId> QOrganizerItemMemoryEngine::matchingItemIds(const QDateTime& startDate, const QDateTime& endDate, const QOrganizerItemFilter& filter) const
+{
+    if (filter.type() == QOrganizerItemFilter::IdFilter && startDate.isNull() && endDate.isNull())
+        return exportedItemIds(QOrganizerItemIdFilter(filter).ids()); // as itemsForExport() does
+
+    QList<QOrganizerItemId> ids;
+    QSet<QOrganizerItemId> parentsAdded;
+    foreach (const QOrganizerItem *candidate, candidateItems(startDate, endDate)) {
+        const QOrganizerItem &c = *candidate;
         if (itemHasReccurence(c)) {
-            addItemRecurrences(sorted, c, startDate, endDate, filter, sortOrders, forExport, &parentsAdded);
-        } else {
-            if ((isDefFilter || QOrganizerManagerEngine::testFilter(filter, c)) && QOrganizerManagerEngine::isItemBetweenDates(c, startDate, endDate)) {
-                QOrganizerManagerEngine::addSorted(&sorted,c, sortOrders);
-                if (forExport
-                        && (c.type() == QOrganizerItemType::TypeEventOccurrence
-                        ||  c.type() == QOrganizerItemType::TypeTodoOccurrence)) {
-                    QOrganizerItemId parentId(c.detail(QOrganizerItemDetail::TypeParent).value<QOrganizerItemId>(QOrganizerItemParent::FieldParentId));
-                    if (!parentsAdded.contains(parentId)) {
-                        parentsAdded.insert(parentId);
-                        QOrganizerManagerEngine::addSorted(&sorted, item(parentId), sortOrders);
-                    }
+            // as for an export, the first occurrence in the period decides whether the parent matches
+            if (parentsAdded.contains(c.id()))
+                continue;
+            QOrganizerManager::Error error = QOrganizerManager::NoError;
+            const QList<QOrganizerItem> occurrences = internalItemOccurrences(c, startDate, endDate, 1, false, false, 0, &error);
+            if (!occurrences.isEmpty()
+                    && (filter.type() == QOrganizerItemFilter::DefaultFilter || QOrganizerManagerEngine::testFilter(filter, occurrences.first()))) {
+                ids.append(c.id());
+                parentsAdded.insert(c.id());
+            }
+        } else if ((filter.type() == QOrganizerItemFilter::DefaultFilter || QOrganizerManagerEngine::testFilter(filter, c))
+                   && QOrganizerManagerEngine::isItemBetweenDates(c, startDate, endDate)) {
+            ids.append(c.id());
+            if (c.type() == QOrganizerItemType::TypeEventOccurrence || c.type() == QOrganizerItemType::TypeTodoOccurrence) {
+                QOrganizerItemId parentId(c.detail(QOrganizerItemDetail::TypeParent).value<QOrganizerItemId>(QOrganizerItemParent::FieldParentId));
+                if (!parentsAdded.contains(parentId)) {
+                    parentsAdded.insert(parentId);
+                    ids.append(parentId);
                 }
             }
         }
     }
+    return ids;
+}
 
-    return sorted;
+/* Returns the IDs of the stored items among the given \a ids, once each and in the order given,
+ * each exception among them followed by its parent; these are the items exported for an id
+ * filter without a period.  A requested recurring item is itself exported. */
+QList<QOrganizerItemId> QOrganizerItemMemoryEngine::exportedItemIds(const QList<QOrganizerItemId>& ids) const
+{
+    QList<QOrganizerItemId> exported;
+    QSet<QOrganizerItemId> added;
+    foreach (const QOrganizerItemId &id, ids) {
+        QHash<QOrganizerItemId, QOrganizerItem>::const_iterator it = d->m_idToItemHash.constFind(id);
+        if (it == d->m_idToItemHash.constEnd() || added.contains(id))
+            continue;
+        exported.append(id);
+        added.insert(id);
+        const QOrganizerItem &c = it.value();
+        if (c.type() == QOrganizerItemType::TypeEventOccurrence || c.type() == QOrganizerItemType::TypeTodoOccurrence) {
+            // as for any export, the parents of exceptions are exported with them
+            QOrganizerItemId parentId(c.detail(QOrganizerItemDetail::TypeParent).value<QOrganizerItemId>(QOrganizerItemParent::FieldParentId));
+            if (!added.contains(parentId)) {
+                added.insert(parentId);
+                exported.append(parentId);
+            }
+        }
+    }
+    return exported;
 }
 
+namespace {
 
-void QOrganizerItemMemoryEngine::addItemRecurrences(QList<QOrganizerItem>& sorted, const QOrganizerItem& c, const QDateTime& startDate, const QDateTime& endDate, const QOrganizerItemFilter& filter, const QList<QOrganizerItemSortOrder>& sortOrders, bool forExport, QSet<QOrganizerItemId>* parentsAdded) const
+/* The state of a fetch filtered in parallel.  Every chunk of the items is claimed by exactly
+ * one thread, which may be the caller; the caller waits for every chunk, and any task which
+ * starts later finds nothing left to claim. */
+class ParallelItemFilter
+{
+public:
+    typedef void (QOrganizerItemMemoryEngine::*MatchFunction)(QList<QOrganizerItem>&, const QOrganizerItem&, const QDateTime&, const QDateTime&, const QOrganizerItemFilter&, bool, QSet<QOrganizerItemId>*) const;
+
+    ParallelItemFilter(const QOrganizerItemMemoryEngine *engine, MatchFunction match, const QVector<const QOrganizerItem *> &items,
+                       const QDateTime &startDate, const QDateTime &endDate, const QOrganizerItemFilter &filter, int chunks)
+        : m_engine(engine), m_match(match), m_items(items), m_startDate(startDate), m_endDate(endDate),
+          m_filter(filter), m_chunks(chunks), m_nextChunk(0), m_matches(chunks)
+    {
+        m_results = m_matches.data();
+    }
+
+    /* Filters chunks until none are left */
+    void run()
+    {
+        int chunk;
+        while ((chunk = m_nextChunk.fetchAndAddRelaxed(1)) < m_chunks) {
+            const int begin = int(qint64(m_items.count()) * chunk / m_chunks);
+            const int end = int(qint64(m_items.count()) * (chunk + 1) / m_chunks);
+            QSet<QOrganizerItemId> parentsAdded; // unused, since exports are never filtered in parallel
+            for (int j = begin; j < end; ++j)
+                (m_engine->*m_match)(m_results[chunk], *m_items.at(j), m_startDate, m_endDate, m_filter, false, &parentsAdded);
+            m_done.release();
+        }
+    }
+
+    /* Returns the matching items once every chunk has been filtered */
+    QList<QOrganizerItem> matches()
+    {
+        m_done.acquire(m_chunks);
+        QList<QOrganizerItem> result;
+        for (int chunk = 0; chunk < m_chunks; ++chunk)
+            result += m_matches.at(chunk);
+        return result;
+    }
+
+private:
+    const QOrganizerItemMemoryEngine *m_engine;
+    const MatchFunction m_match;
+    const QVector<const QOrganizerItem *> m_items;
+    const QDateTime m_startDate;
+    const QDateTime m_endDate;
+    const QOrganizerItemFilter m_filter;
+    const int m_chunks;
+    QAtomicInt m_nextChunk;
+    QVector<QList<QOrganizerItem> > m_matches; // the matches in each chunk
+    QList<QOrganizerItem> *m_results;          // the data of m_matches, so that threads never detach it
+    QSemaphore m_done;                         // released once for each chunk filtered
+};
+
+class ParallelItemFilterTask : public QRunnable
+{
+public:
+    explicit ParallelItemFilterTask(const QSharedPointer<ParallelItemFilter> &filter) : m_filter(filter) {}
+    void run() { m_filter->run(); }
+
+private:
+    QSharedPointer<ParallelItemFilter> m_filter; // kept alive until every task has run
+};
+
+} // namespace
+
+/* Returns the \a items (and occurrences) which match the filter and dates, in the order in which
+ * they are given, testing chunks of the items on the global thread pool */
+QList<QOrganizerItem> QOrganizerItemMemoryEngine::parallelMatchingItems(const QVector<const QOrganizerItem*>& items, const QDateTime& startDate, const QDateTime& endDate, const QOrganizerItemFilter& filter) const
+{
+    enum { MinimumChunkSize = 256 }; // below this, starting a task costs more than it saves
+
+    const int chunks = qBound(1, items.count() / MinimumChunkSize, QThreadPool::globalInstance()->maxThreadCount() + 1);
+    QSharedPointer<ParallelItemFilter> parallel(new ParallelItemFilter(this, &QOrganizerItemMemoryEngine::addMatchingItem,
+                                                                       items, startDate, endDate, filter, chunks));
+    // this thread filters chunks too, so the fetch completes even if the pool is busy
+    for (int j = 1; j < chunks; ++j)
+        QThreadPool::globalInstance()->start(new ParallelItemFilterTask(parallel));
+    parallel->run();
+    return parallel->matches();
+}
+
+void QOrganizerItemMemoryEngine::addItemRecurrences(QList<QOrganizerItem>& matches, const QOrganizerItem& c, const QDateTime& startDate, const QDateTime& endDate, const QOrganizerItemFilter& filter, bool forExport, QSet<QOrganizerItemId>* parentsAdded) const
 {
     QOrganizerManager::Error error = QOrganizerManager::NoError;
     if (forExport && parentsAdded->contains(c.id()))
         return;
 
-    QList<QOrganizerItem> recItems = internalItemOccurrences(c, startDate, endDate, forExport ? 1 : 50, false, false, 0, &error); // XXX TODO: why maxcount of 50?
+    QList<QOrganizerItem> recItems = internalItemOccurrences(c, startDate, endDate, forExport ? 1 : -1, false, false, 0, &error);
     if (filter.type() == QOrganizerItemFilter::DefaultFilter) {
         foreach(const QOrganizerItem& oi, recItems) {
-            QOrganizerManagerEngine::addSorted(&sorted, forExport ? c : oi, sortOrders);
+            matches.append(forExport ? c : oi);
             if (forExport)
                 parentsAdded->insert(c.id());
         }
     } else {
         foreach(const QOrganizerItem& oi, recItems) {
             if (QOrganizerManagerEngine::testFilter(filter, oi)) {
-                QOrganizerManagerEngine::addSorted(&sorted, forExport ? c : oi, sortOrders);
+                matches.append(forExport ? c : oi);
                 if (forExport)
                     parentsAdded->insert(c.id());
             }
@@ -554,6 +962,8 @@ bool QOrganizerItemMemoryEngine::storeItem(QOrganizerItem* theOrganizerItem, QOr
         }
         // Looks ok, so continue
         d->m_idToItemHash.insert(theOrganizerItemId, *theOrganizerItem); // replacement insert.
+        d->m_timeIndex.insert(*theOrganizerItem);
+        d->m_exceptionIndex.insert(*theOrganizerItem); // its original date may have changed
         changeSet.insertChangedItem(theOrganizerItemId, detailMask);
 
         // cross-check if stored exception occurrences are still valid
@@ -563,15 +973,23 @@ bool QOrganizerItemMemoryEngine::storeItem(QOrganizerItem* theOrganizerItem, QOr
 
             // should we also check and remove exception dates if e.g. limit date or limit count has been changed
             // to be earlier (or smaller) than before thus invelidating an exception date..?
-            QList<QOrganizerItemId> occurrenceIds = d->m_parentIdToChildIdHash.values(theOrganizerItemId);
+            QList<QOrganizerItemId> occurrenceIds = d->m_exceptionIndex.exceptions(theOrganizerItemId);
             QOrganizerManager::Error occurrenceError = QOrganizerManager::NoError;
             if (!occurrenceIds.isEmpty()) {
                 if (itemHasReccurence(*theOrganizerItem)) {
                     // generate occurrences to get the dates when there can be an exception occurrence
                     // if the new item does not have recurrence, all exception occurrences of this item
-                    // are removed
+                    // are removed. The occurrences are generated up to the last original date of
+                    // the exceptions, however far away it is.
+                    QDate lastOriginalDate;
+                    foreach (const QOrganizerItemId &occurrenceId, occurrenceIds) {
+                        QOrganizerItemParent parentDetail = d->m_idToItemHash.value(occurrenceId).detail(QOrganizerItemDetail::TypeParent);
+                        if (!lastOriginalDate.isValid() || parentDetail.originalDate() > lastOriginalDate)
+                            lastOriginalDate = parentDetail.originalDate();
+                    }
                     QList<QDate> exceptionDates;
-                    QList<QOrganizerItem> occurrences = internalItemOccurrences(*theOrganizerItem, QDateTime(), QDateTime(), -1, false, false, &exceptionDates, &occurrenceError);
+                    if (lastOriginalDate.isValid())
+                        internalItemOccurrences(*theOrganizerItem, QDateTime(), QDateTime(lastOriginalDate.addDays(1), QTime(0, 0, 0)), -1, false, false, &exceptionDates, &occurrenceError);
                     foreach (const QOrganizerItemId &occurrenceId, occurrenceIds) {
                         // remove all occurrence ids from the list which have valid exception date
                         QOrganizerItemParent parentDetail = d->m_idToItemHash.value(occurrenceId).detail(QOrganizerItemDetail::TypeParent);
@@ -641,6 +1059,7 @@ bool QOrganizerItemMemoryEngine::storeItem(QOrganizerItem* theOrganizerItem, QOr
                 recurrence.setExceptionDates(currentExceptionDates);
                 parentItem.saveDetail(&recurrence);
                 d->m_idToItemHash.insert(parentId, parentItem); // replacement insert
+                d->m_timeIndex.insert(parentItem);
                 changeSet.insertChangedItem(parentId, detailMask); // is this correct?  it's an exception, so change parent?
             }
         }
@@ -656,10 +1075,9 @@ bool QOrganizerItemMemoryEngine::storeItem(QOrganizerItem* theOrganizerItem, QOr
         // finally, add the organizer item to our internal lists and return
         theOrganizerItem->setCollectionId(targetCollectionId);
         d->m_idToItemHash.insert(theOrganizerItemId, *theOrganizerItem);  // add organizer item to hash
-        if (!parentId.isNull()) {
-            // if it was an occurrence, we need to add it to the children hash.
-            d->m_parentIdToChildIdHash.insert(parentId, theOrganizerItemId);
-        }
+        d->m_timeIndex.insert(*theOrganizerItem);
+        // if it was an occurrence, we need to add it to the exception index.
+        d->m_exceptionIndex.insert(*theOrganizerItem);
         d->m_itemsInCollectionsHash.insert(targetCollectionId, theOrganizerItemId);
         changeSet.insertAddedItem(theOrganizerItemId);
     }
@@ -917,25 +1335,23 @@ bool QOrganizerItemMemoryEngine::removeItem(const QOrganizerItemId& organizerite
         return false;
     }
 
-    // if it is a child item, remove itself from the children hash
-    QOrganizerItem thisItem = hashIterator.value();
-    QOrganizerItemParent parentDetail = thisItem.detail(QOrganizerItemDetail::TypeParent);
-    if (!parentDetail.parentId().isNull()) {
-        d->m_parentIdToChildIdHash.remove(parentDetail.parentId(), organizeritemId);
-    }
+    // if it is a child item, remove itself from the exception index
+    d->m_exceptionIndex.remove(organizeritemId);
 
     // if it is a parent item, remove any children.
-    QList<QOrganizerItemId> childrenIds = d->m_parentIdToChildIdHash.values(organizeritemId);
+    QList<QOrganizerItemId> childrenIds = d->m_exceptionIndex.exceptions(organizeritemId);
     foreach (const QOrganizerItemId& childId, childrenIds) {
         // remove the child occurrence from our lists.
         d->m_idToItemHash.remove(childId);
+        d->m_timeIndex.remove(childId);
+        d->m_exceptionIndex.remove(childId);
         d->m_itemsInCollectionsHash.remove(d->m_itemsInCollectionsHash.key(childId), childId);
         changeSet.insertRemovedItem(childId);
     }
 
     // remove the organizer item from the lists.
     d->m_idToItemHash.remove(organizeritemId);
-    d->m_parentIdToChildIdHash.remove(organizeritemId);
+    d->m_timeIndex.remove(organizeritemId);
     d->m_itemsInCollectionsHash.remove(d->m_itemsInCollectionsHash.key(organizeritemId), organizeritemId);
     *error = QOrganizerManager::NoError;
 
@@ -967,6 +1383,7 @@ bool QOrganizerItemMemoryEngine::removeOccurrence(const QOrganizerItem &organize
         recurrenceDetail.setExceptionDates(exceptionDates);
         parentItem.saveDetail(&recurrenceDetail);
         d->m_idToItemHash.insert(parentDetail.parentId(), parentItem);
+        d->m_timeIndex.insert(parentItem);
         changeSet.insertChangedItem(parentDetail.parentId(), QList<QOrganizerItemDetail::DetailType>());
     }
     *error = QOrganizerManager::NoError;
@@ -1003,6 +1420,22 @@ bool QOrganizerItemMemoryEngine::removeItems(const QList<QOrganizerItemId> &item
     return (*error == QOrganizerManager::NoError);
 }
 
+/*! \reimp
+*/
+quint64 QOrganizerItemMemoryEngine::revision(QOrganizerManager::Error *error) const
+{
+    *error = QOrganizerManager::NoError;
+    return d->m_changeJournal.revision();
+}
+
+/*! \reimp
+*/
+QOrganizerItemChangeSet QOrganizerItemMemoryEngine::changesSince(quint64 revision, quint64 *currentRevision, QOrganizerManager::Error *error) const
+{
+    *currentRevision = d->m_changeJournal.revision();
+    return d->m_changeJournal.changesSince(revision, error);
+}
+
 /*! \reimp
 */
 bool QOrganizerItemMemoryEngine::removeItems(const QList<QOrganizerItem> *items, QMap<int, QOrganizerManager::Error> *errorMap, QOrganizerManager::Error *error)
@@ -1332,6 +1765,29 @@ void QOrganizerItemMemoryEngine::performAsynchronousOperation(QOrganizerAbstract
         break;
 
 
+        case QOrganizerAbstractRequest::ItemCountRequest:
+        {
+            QOrganizerItemCountRequest* r = static_cast<QOrganizerItemCountRequest*>(currentRequest);
+
+            QOrganizerManager::Error operationError = QOrganizerManager::NoError;
+            const int count = itemCount(r->filter(), r->startDate(), r->endDate(), &operationError);
+
+            updateItemCountRequest(r, count, operationError, QOrganizerAbstractRequest::FinishedState);
+        }
+        break;
+
+        case QOrganizerAbstractRequest::ItemChangesFetchRequest:
+        {
+            QOrganizerItemChangesFetchRequest* r = static_cast<QOrganizerItemChangesFetchRequest*>(currentRequest);
+
+            QOrganizerManager::Error operationError = QOrganizerManager::NoError;
+            quint64 currentRevision = 0;
+            QOrganizerItemChangeSet changes = changesSince(r->sinceRevision(), &currentRevision, &operationError);
+
+            updateItemChangesFetchRequest(r, changes, currentRevision, operationError, QOrganizerAbstractRequest::FinishedState);
+        }
+        break;
+
         case QOrganizerAbstractRequest::ItemIdFetchRequest:
         {
             QOrganizerItemIdFetchRequest* r = static_cast<QOrganizerItemIdFetchRequest*>(currentRequest);
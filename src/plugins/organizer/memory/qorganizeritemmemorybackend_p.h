@@ -51,12 +51,16 @@
 // We mean it.
 //
 
+#include <QtCore/qvector.h>
+
 #include <QtOrganizer/qorganizermanagerengine.h>
 #include <QtOrganizer/qorganizermanagerenginefactory.h>
 #include <QtOrganizer/qorganizercollectionchangeset.h>
 #include <QtOrganizer/qorganizeritemchangeset.h>
 #include <QtOrganizer/qorganizerrecurrencerule.h>
 
+#include "qorganizeritemmemoryindex_p.h"
+
 QT_BEGIN_NAMESPACE_ORGANIZER
 
 class QOrganizerItemMemoryFactory : public QOrganizerManagerEngineFactory
@@ -70,6 +74,33 @@ public:
 };
 
 
+/*
+ * A bounded journal of the changes made to the stored items, for revision based
+ * synchronization; it follows QContactMemoryChangeJournal of the contacts memory engine.
+ *
+ * Every change set which adds, changes or removes items advances the revision by one,
+ * and is kept as it is; once there are more than MaximumEntries, the oldest is
+ * discarded.  A change set which only reports that the data changed advances the
+ * revision and empties the journal.  changesSince() merges the change sets after the
+ * given revision.
+ */
+class QOrganizerItemMemoryChangeJournal
+{
+public:
+    enum { MaximumEntries = 1024 };
+
+    QOrganizerItemMemoryChangeJournal();
+
+    quint64 revision() const { return m_revision; }
+    void record(const QOrganizerItemChangeSet &changeSet);
+    QOrganizerItemChangeSet changesSince(quint64 revision, QOrganizerManager::Error *error) const;
+
+private:
+    QList<QOrganizerItemChangeSet> m_entries; // one change set for each revision after m_oldestRevision, oldest first
+    quint64 m_revision;                       // the current revision
+    quint64 m_oldestRevision;                 // the earliest revision from which the changes are known
+};
+
 class QOrganizerAbstractRequest;
 class QOrganizerManagerEngine;
 class QOrganizerItemMemoryEngineData : public QSharedData
@@ -85,12 +116,15 @@ public:
     QString m_id;                                  // the id parameter value
 
     QHash<QOrganizerItemId, QOrganizerItem> m_idToItemHash; // hash of id to the item identified by that id
-    QMultiHash<QOrganizerItemId, QOrganizerItemId> m_parentIdToChildIdHash; // hash of id to that item's children's ids
     QHash<QOrganizerCollectionId, QOrganizerCollection> m_idToCollectionHash; // hash of id to the collection identified by that id
     QMultiHash<QOrganizerCollectionId, QOrganizerItemId> m_itemsInCollectionsHash; // hash of collection ids to the ids of items the collection contains.
     quint32 m_nextOrganizerItemId; // the localId() portion of a QOrganizerItemId
     quint32 m_nextOrganizerCollectionId; // the localId() portion of a QOrganizerCollectionId
     QString m_managerUri;                        // for faster lookup.
+    int m_parallelFilterThreshold;               // items to test before filtering in parallel, or 0 if never
+    QOrganizerItemMemoryChangeJournal m_changeJournal; // the revision, and the changes made in recent revisions
+    QOrganizerItemMemoryTimeIndex m_timeIndex;   // the time spans of the items in m_idToItemHash
+    QOrganizerItemMemoryExceptionIndex m_exceptionIndex; // the exception occurrences of each item, by original date
 
     void emitSharedSignals(QOrganizerCollectionChangeSet *cs)
     {
@@ -99,6 +133,7 @@ public:
     }
     void emitSharedSignals(QOrganizerItemChangeSet* cs)
     {
+        m_changeJournal.record(*cs);
         foreach(QOrganizerManagerEngine* engine, m_sharedEngines)
             cs->emitSignals(engine);
     }
@@ -133,10 +168,16 @@ public:
                                     const QDateTime &endDateTime, const QList<QOrganizerItemSortOrder> &sortOrders,
                                     QOrganizerManager::Error *error);
 
+    int itemCount(const QOrganizerItemFilter &filter, const QDateTime &startDateTime,
+                  const QDateTime &endDateTime, QOrganizerManager::Error *error);
+
     QList<QOrganizerItem> itemOccurrences(const QOrganizerItem &parentItem, const QDateTime &startDateTime,
                                           const QDateTime &endDateTime, int maxCount,
                                           const QOrganizerItemFetchHint &fetchHint, QOrganizerManager::Error *error);
 
+    QOrganizerItemOccurrenceIterator itemOccurrenceIterator(const QOrganizerItem &parentItem, const QDateTime &startDateTime,
+                                                            const QOrganizerItemFetchHint &fetchHint, QOrganizerManager::Error *error);
+
     QList<QOrganizerItem> itemsForExport(const QDateTime &startDateTime, const QDateTime &endDateTime,
                                          const QOrganizerItemFilter &filter,
                                          const QList<QOrganizerItemSortOrder> &sortOrders,
@@ -151,6 +192,10 @@ public:
     bool removeItems(const QList<QOrganizerItem> *items, QMap<int, QOrganizerManager::Error>* errorMap,
                      QOrganizerManager::Error* error);
 
+    // revisions, for synchronization
+    quint64 revision(QOrganizerManager::Error *error) const;
+    QOrganizerItemChangeSet changesSince(quint64 revision, quint64 *currentRevision, QOrganizerManager::Error *error) const;
+
     // collections
     QOrganizerCollectionId defaultCollectionId() const;
     QOrganizerCollection collection(const QOrganizerCollectionId &collectionId, QOrganizerManager::Error *error);
@@ -207,11 +252,17 @@ protected:
 
 private:
     QOrganizerItem item(const QOrganizerItemId& organizeritemId) const;
+    QList<QOrganizerItem> exceptionItems(const QOrganizerItemId& parentId) const;
     bool storeItems(QList<QOrganizerItem>* organizeritems, const QList<QOrganizerItemDetail::DetailType> &detailMask, QMap<int, QOrganizerManager::Error>* errorMap, QOrganizerManager::Error* error);
     QList<QOrganizerItem> itemsForExport(const QList<QOrganizerItemId> &ids, const QOrganizerItemFetchHint &fetchHint, QMap<int, QOrganizerManager::Error> *errorMap, QOrganizerManager::Error *error);
-    QList<QOrganizerItem> internalItems(const QDateTime& startDate, const QDateTime& endDate, const QOrganizerItemFilter& filter, const QList<QOrganizerItemSortOrder>& sortOrders, const QOrganizerItemFetchHint& fetchHint, QOrganizerManager::Error* error, bool forExport) const;
+    QList<QOrganizerItem> internalItems(const QDateTime& startDate, const QDateTime& endDate, const QOrganizerItemFilter& filter, const QList<QOrganizerItemSortOrder>& sortOrders, int maxCount, const QOrganizerItemFetchHint& fetchHint, QOrganizerManager::Error* error, bool forExport) const;
     QList<QOrganizerItem> internalItemOccurrences(const QOrganizerItem& parentItem, const QDateTime& periodStart, const QDateTime& periodEnd, int maxCount, bool includeExceptions, bool sortItems, QList<QDate> *exceptionDates, QOrganizerManager::Error* error) const;
-    void addItemRecurrences(QList<QOrganizerItem>& sorted, const QOrganizerItem& c, const QDateTime& startDate, const QDateTime& endDate, const QOrganizerItemFilter& filter, const QList<QOrganizerItemSortOrder>& sortOrders, bool forExport, QSet<QOrganizerItemId>* parentsAdded) const;
+    void addItemRecurrences(QList<QOrganizerItem>& matches, const QOrganizerItem& c, const QDateTime& startDate, const QDateTime& endDate, const QOrganizerItemFilter& filter, bool forExport, QSet<QOrganizerItemId>* parentsAdded) const;
+    void addMatchingItem(QList<QOrganizerItem>& matches, const QOrganizerItem& c, const QDateTime& startDate, const QDateTime& endDate, const QOrganizerItemFilter& filter, bool forExport, QSet<QOrganizerItemId>* parentsAdded) const;
+    QVector<const QOrganizerItem*> candidateItems(const QDateTime& startDate, const QDateTime& endDate) const;
+    QList<QOrganizerItem> parallelMatchingItems(const QVector<const QOrganizerItem*>& items, const QDateTime& startDate, const QDateTime& endDate, const QOrganizerItemFilter& filter) const;
+    QList<QOrganizerItemId> matchingItemIds(const QDateTime& startDate, const QDateTime& endDate, const QOrganizerItemFilter& filter) const;
+    QList<QOrganizerItemId> exportedItemIds(const QList<QOrganizerItemId>& ids) const;
 
     bool fixOccurrenceReferences(QOrganizerItem* item, QOrganizerManager::Error* error);
     bool typesAreRelated(QOrganizerItemType::ItemType occurrenceType, QOrganizerItemType::ItemType parentType);
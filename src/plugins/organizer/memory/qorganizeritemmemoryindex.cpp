@@ -0,0 +1,260 @@
+/****************************************************************************
+**
+** Copyright (C) 2017 The Qt Company Ltd.
+** Contact: https://www.qt.io/licensing/
+**
+** This file is part of the QtOrganizer module of the Qt Toolkit.
+**
+** $QT_BEGIN_LICENSE:LGPL$
+** Commercial License Usage
+** Licensees holding valid commercial Qt licenses may use this file in
+** accordance with the commercial license agreement provided with the
+** Software or, alternatively, in accordance with the terms contained in
+** a written agreement between you and The Qt Company. For licensing terms
+** and conditions see https://www.qt.io/terms-conditions. For further
+** information use the contact form at https://www.qt.io/contact-us.
+**
+** GNU Lesser General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU Lesser
+** General Public License version 3 as published by the Free Software
+** Foundation and appearing in the file LICENSE.LGPL3 included in the
+** packaging of this file. Please review the following information to
+** ensure the GNU Lesser General Public License version 3 requirements
+** will be met: https://www.gnu.org/licenses/lgpl-3.0.html.
+**
+** GNU General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU
+** General Public License version 2.0 or (at your option) the GNU General
+** Public license version 3 or any later version approved by the KDE Free
+** Qt Foundation. The licenses are as published by the Free Software
+** Foundation and appearing in the file LICENSE.GPL2 and LICENSE.GPL3
+** included in the packaging of this file. Please review the following
+** information to ensure the GNU General Public License requirements will
+** be met: https://www.gnu.org/licenses/gpl-2.0.html and
+** https://www.gnu.org/licenses/gpl-3.0.html.
+**
+** $QT_END_LICENSE$
+**
+****************************************************************************/
+
+#include "qorganizeritemmemoryindex_p.h"
+
+#include <algorithm>
+#include <limits>
+
+#include <QtOrganizer/qorganizeritemdetails.h>
+#include <QtOrganizer/qorganizeritems.h>
+#include <QtOrganizer/qorganizermanagerengine.h>
+#include <QtOrganizer/qorganizerrecurrencerule.h>
+
+QT_BEGIN_NAMESPACE_ORGANIZER
+
+/* Files the span of the given \a item, replacing any span filed for it before */
+void QOrganizerItemMemoryTimeIndex::insert(const QOrganizerItem &item)
+{
+    remove(item.id());
+
+    Span itemSpan;
+    if (!span(item, &itemSpan))
+        return; // never within a period
+    m_spans.insert(item.id(), itemSpan);
+    if (itemSpan.lengthClass < 0) {
+        m_unbounded.insert(item.id());
+    } else {
+        Entry entry;
+        entry.end = itemSpan.end;
+        entry.itemId = item.id();
+        m_starts[itemSpan.lengthClass].insert(itemSpan.start, entry);
+    }
+}
+
+/* Removes the span filed by insert() for the item identified by \a itemId, if any */
+void QOrganizerItemMemoryTimeIndex::remove(const QOrganizerItemId &itemId)
+{
+    QHash<QOrganizerItemId, Span>::iterator it = m_spans.find(itemId);
+    if (it == m_spans.end())
+        return;
+
+    if (it->lengthClass < 0) {
+        m_unbounded.remove(itemId);
+    } else {
+        QMultiMap<qint64, Entry> &starts = m_starts[it->lengthClass];
+        QMultiMap<qint64, Entry>::iterator entry = starts.find(it->start);
+        for ( ; entry != starts.end() && entry.key() == it->start; ++entry) {
+            if (entry->itemId == itemId) {
+                starts.erase(entry);
+                break;
+            }
+        }
+    }
+    m_spans.erase(it);
+}
+
+/*
+ * Returns the ids of the items whose spans overlap the period from \a startDate to
+ * \a endDate, inclusive, in the order of their ids.  A null \a startDate or \a endDate
+ * leaves that end of the period open; at least one of them should be given, since
+ * every item is within an unlimited period.
+ */
+QList<QOrganizerItemId> QOrganizerItemMemoryTimeIndex::candidates(const QDateTime &startDate, const QDateTime &endDate) const
+{
+    const qint64 periodStart = startDate.isNull() ? std::numeric_limits<qint64>::min() : startDate.toMSecsSinceEpoch();
+    const qint64 periodEnd = endDate.isNull() ? std::numeric_limits<qint64>::max() : endDate.toMSecsSinceEpoch();
+
+    QList<QOrganizerItemId> retn;
+    for (int lengthClass = 0; lengthClass < LengthClasses; ++lengthClass) {
+        // no span of this class which starts before scanStart can reach the period
+        qint64 scanStart = std::numeric_limits<qint64>::min();
+        if (lengthClass < LengthClasses - 1 && periodStart > scanStart + maximumLength(lengthClass))
+            scanStart = periodStart - maximumLength(lengthClass);
+
+        const QMultiMap<qint64, Entry> &starts = m_starts[lengthClass];
+        QMultiMap<qint64, Entry>::const_iterator it = starts.lowerBound(scanStart);
+        for ( ; it != starts.constEnd() && it.key() <= periodEnd; ++it) {
+            if (it->end >= periodStart)
+                retn.append(it->itemId);
+        }
+    }
+    foreach (const QOrganizerItemId &itemId, m_unbounded)
+        retn.append(itemId);
+
+    std::sort(retn.begin(), retn.end());
+    return retn;
+}
+
+/*
+ * Computes the span of the given \a item into \a span, as described for the class.
+ * Returns false if the item has no times, and so is never within a period; the length
+ * class is -1 if the item has times, but they do not bound its span.
+ */
+bool QOrganizerItemMemoryTimeIndex::span(const QOrganizerItem &item, Span *span)
+{
+    span->lengthClass = -1;
+
+    QList<QDateTime> times;
+    if (QOrganizerManagerEngine::itemHasReccurence(item)) {
+        // as for the generated occurrences, the series starts at the start time, or else the end (or due) time
+        QDateTime initialDateTime;
+        if (item.type() == QOrganizerItemType::TypeEvent) {
+            const QOrganizerEvent event = item;
+            initialDateTime = event.startDateTime().isValid() ? event.startDateTime() : event.endDateTime();
+        } else {
+            const QOrganizerTodo todo = item;
+            initialDateTime = todo.startDateTime().isValid() ? todo.startDateTime() : todo.dueDateTime();
+        }
+        if (!initialDateTime.isValid())
+            return true;
+        times << initialDateTime;
+
+        const QOrganizerItemRecurrence recurrence = item.detail(QOrganizerItemDetail::TypeRecurrence);
+        foreach (const QDate &date, recurrence.recurrenceDates()) {
+            QDateTime dateTime(initialDateTime.toLocalTime());
+            dateTime.setDate(date);
+            if (dateTime.isValid())
+                times << dateTime;
+        }
+        foreach (const QOrganizerRecurrenceRule &rule, recurrence.recurrenceRules()) {
+            if (rule.frequency() == QOrganizerRecurrenceRule::Invalid)
+                continue;
+            if (rule.limitType() != QOrganizerRecurrenceRule::DateLimit || !rule.limitDate().isValid()) {
+                // the occurrences are only bounded by their count, if at all
+                span->start = initialDateTime.toMSecsSinceEpoch();
+                span->end = std::numeric_limits<qint64>::max();
+                span->lengthClass = LengthClasses - 1;
+                return true;
+            }
+            // occurrences start until the end of the limit date, in any time zone
+            times << QDateTime(rule.limitDate().addDays(2), QTime(0, 0), Qt::UTC);
+        }
+    } else if (item.type() == QOrganizerItemType::TypeEvent || item.type() == QOrganizerItemType::TypeEventOccurrence) {
+        const QOrganizerEventTime eventTime = item.detail(QOrganizerItemDetail::TypeEventTime);
+        times << eventTime.startDateTime() << eventTime.endDateTime();
+    } else if (item.type() == QOrganizerItemType::TypeTodo || item.type() == QOrganizerItemType::TypeTodoOccurrence) {
+        const QOrganizerTodoTime todoTime = item.detail(QOrganizerItemDetail::TypeTodoTime);
+        times << todoTime.startDateTime() << todoTime.dueDateTime();
+    } else if (item.type() == QOrganizerItemType::TypeJournal) {
+        const QOrganizerJournal journal = item;
+        times << journal.dateTime();
+    }
+
+    bool hasTime = false;
+    foreach (const QDateTime &time, times) {
+        if (time.isNull())
+            continue;
+        if (!time.isValid())
+            return true; // cannot be placed in time, so always a candidate
+        const qint64 msecs = time.toMSecsSinceEpoch();
+        if (!hasTime) {
+            span->start = span->end = msecs;
+            hasTime = true;
+        } else {
+            span->start = qMin(span->start, msecs);
+            span->end = qMax(span->end, msecs);
+        }
+    }
+    if (!hasTime)
+        return false;
+
+    const qint64 length = span->end - span->start;
+    span->lengthClass = 0;
+    while (span->lengthClass < LengthClasses - 1 && length > maximumLength(span->lengthClass))
+        ++span->lengthClass;
+    return true;
+}
+
+/* Returns the length of the longest span in the given \a lengthClass, other than the last */
+qint64 QOrganizerItemMemoryTimeIndex::maximumLength(int lengthClass)
+{
+    return qint64(HourLength) << (2 * lengthClass);
+}
+
+/* Files the given \a item under its parent and original date if it is an exception occurrence,
+ * replacing anything filed for it before */
+void QOrganizerItemMemoryExceptionIndex::insert(const QOrganizerItem &item)
+{
+    remove(item.id());
+
+    if (item.type() != QOrganizerItemType::TypeEventOccurrence
+            && item.type() != QOrganizerItemType::TypeTodoOccurrence)
+        return;
+    const QOrganizerItemParent parent = item.detail(QOrganizerItemDetail::TypeParent);
+    if (parent.parentId().isNull())
+        return;
+
+    m_exceptionsByParent[parent.parentId()].insert(parent.originalDate(), item.id());
+    m_origins.insert(item.id(), Origin(parent.parentId(), parent.originalDate()));
+}
+
+/* Removes whatever insert() filed for the item identified by \a itemId */
+void QOrganizerItemMemoryExceptionIndex::remove(const QOrganizerItemId &itemId)
+{
+    QHash<QOrganizerItemId, Origin>::iterator origin = m_origins.find(itemId);
+    if (origin == m_origins.end())
+        return;
+
+    QHash<QOrganizerItemId, QMultiMap<QDate, QOrganizerItemId> >::iterator it = m_exceptionsByParent.find(origin->first);
+    if (it != m_exceptionsByParent.end()) {
+        it->remove(origin->second, itemId);
+        if (it->isEmpty())
+            m_exceptionsByParent.erase(it);
+    }
+    m_origins.erase(origin);
+}
+
+/* Returns the ids of the exceptions of the item identified by \a parentId, by original date */
+QList<QOrganizerItemId> QOrganizerItemMemoryExceptionIndex::exceptions(const QOrganizerItemId &parentId) const
+{
+    return m_exceptionsByParent.value(parentId).values();
+}
+
+/* Returns the ids of the exceptions of the item identified by \a parentId which replace its
+ * occurrence on \a originalDate */
+QList<QOrganizerItemId> QOrganizerItemMemoryExceptionIndex::exceptions(const QOrganizerItemId &parentId, const QDate &originalDate) const
+{
+    QHash<QOrganizerItemId, QMultiMap<QDate, QOrganizerItemId> >::const_iterator it = m_exceptionsByParent.constFind(parentId);
+    if (it == m_exceptionsByParent.constEnd())
+        return QList<QOrganizerItemId>();
+    return it->values(originalDate);
+}
+
+QT_END_NAMESPACE_ORGANIZER
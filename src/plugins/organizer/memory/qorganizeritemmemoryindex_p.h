@@ -0,0 +1,141 @@
+/****************************************************************************
+**
+** Copyright (C) 2017 The Qt Company Ltd.
+** Contact: https://www.qt.io/licensing/
+**
+** This file is part of the QtOrganizer module of the Qt Toolkit.
+**
+** $QT_BEGIN_LICENSE:LGPL$
+** Commercial License Usage
+** Licensees holding valid commercial Qt licenses may use this file in
+** accordance with the commercial license agreement provided with the
+** Software or, alternatively, in accordance with the terms contained in
+** a written agreement between you and The Qt Company. For licensing terms
+** and conditions see https://www.qt.io/terms-conditions. For further
+** information use the contact form at https://www.qt.io/contact-us.
+**
+** GNU Lesser General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU Lesser
+** General Public License version 3 as published by the Free Software
+** Foundation and appearing in the file LICENSE.LGPL3 included in the
+** packaging of this file. Please review the following information to
+** ensure the GNU Lesser General Public License version 3 requirements
+** will be met: https://www.gnu.org/licenses/lgpl-3.0.html.
+**
+** GNU General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU
+** General Public License version 2.0 or (at your option) the GNU General
+** Public license version 3 or any later version approved by the KDE Free
+** Qt Foundation. The licenses are as published by the Free Software
+** Foundation and appearing in the file LICENSE.GPL2 and LICENSE.GPL3
+** included in the packaging of this file. Please review the following
+** information to ensure the GNU General Public License requirements will
+** be met: https://www.gnu.org/licenses/gpl-2.0.html and
+** https://www.gnu.org/licenses/gpl-3.0.html.
+**
+** $QT_END_LICENSE$
+**
+****************************************************************************/
+
+#ifndef QORGANIZERITEMMEMORYINDEX_P_H
+#define QORGANIZERITEMMEMORYINDEX_P_H
+
+//
+//  W A R N I N G
+//  -------------
+//
+// This file is not part of the Qt API.  It exists purely as an
+// implementation detail.  This header file may change from version to
+// version without notice, or even be removed.
+//
+// We mean it.
+//
+
+#include <QtCore/qdatetime.h>
+#include <QtCore/qhash.h>
+#include <QtCore/qlist.h>
+#include <QtCore/qmap.h>
+#include <QtCore/qpair.h>
+#include <QtCore/qset.h>
+
+#include <QtOrganizer/qorganizeritem.h>
+#include <QtOrganizer/qorganizeritemid.h>
+
+QT_BEGIN_NAMESPACE_ORGANIZER
+
+/*
+ * An index of the time spans of the stored items, for fetches limited to a period.
+ *
+ * The span of an item which does not recur runs from the earliest to the latest of
+ * its start and end (or due, or journal) times; that of a recurring item runs from
+ * its first occurrence to the latest time at which any occurrence could start, which
+ * is unbounded if a recurrence rule has no end date.  Items with no times at all are
+ * never within a period, so they are not indexed.
+ *
+ * The spans are grouped into classes by their length, each class no more than four
+ * times as long as the previous one, and each class is kept in a map ordered by the
+ * start of the span.  A span of a class with the longest length L overlaps a period
+ * only if it starts between L before the period and its end, so a query scans one
+ * range of each map, and touches little more than the spans which overlap.
+ *
+ * The index only narrows the search: the items it returns are candidates, which must
+ * still be tested against the period (and the recurrences of the item) themselves.
+ */
+class QOrganizerItemMemoryTimeIndex
+{
+public:
+    void insert(const QOrganizerItem &item);
+    void remove(const QOrganizerItemId &itemId);
+    void clear();
+
+    QList<QOrganizerItemId> candidates(const QDateTime &startDate, const QDateTime &endDate) const;
+
+private:
+    enum { HourLength = 3600000, LengthClasses = 13 }; // the last class has no maximum length
+
+    struct Span
+    {
+        qint64 start;
+        qint64 end;
+        int lengthClass; // or -1, if the span could not be determined
+    };
+    struct Entry
+    {
+        qint64 end;
+        QOrganizerItemId itemId;
+    };
+
+    static bool span(const QOrganizerItem &item, Span *span);
+    static qint64 maximumLength(int lengthClass);
+
+    QHash<QOrganizerItemId, Span> m_spans;             // the span of each indexed item
+    QMultiMap<qint64, Entry> m_starts[LengthClasses]; // for each length class, its spans by their start
+    QSet<QOrganizerItemId> m_unbounded;                // items whose span could not be determined, always candidates
+};
+
+/*
+ * An index of the exception occurrences stored for each recurring item, by the
+ * original date of the occurrence each of them replaces.
+ *
+ * Expanding a series then looks up its own exceptions, on the dates which are
+ * excluded from the series, rather than testing the parent of every stored item.
+ */
+class QOrganizerItemMemoryExceptionIndex
+{
+public:
+    void insert(const QOrganizerItem &item);
+    void remove(const QOrganizerItemId &itemId);
+
+    QList<QOrganizerItemId> exceptions(const QOrganizerItemId &parentId) const;
+    QList<QOrganizerItemId> exceptions(const QOrganizerItemId &parentId, const QDate &originalDate) const;
+
+private:
+    typedef QPair<QOrganizerItemId, QDate> Origin;
+
+    QHash<QOrganizerItemId, QMultiMap<QDate, QOrganizerItemId> > m_exceptionsByParent; // the exceptions of each parent, by original date
+    QHash<QOrganizerItemId, Origin> m_origins;                                         // the parent and original date of each exception
+};
+
+QT_END_NAMESPACE_ORGANIZER
+
+#endif // QORGANIZERITEMMEMORYINDEX_P_H
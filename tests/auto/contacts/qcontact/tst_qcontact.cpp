@@ -50,6 +50,7 @@ public:
 
 private slots:
     void details();
+    void detailsByType();
     void preferences();
     void relationships();
     void type();
@@ -367,6 +368,75 @@ void tst_QContact::details()
     QCOMPARE(c.id(), oldId); // id shouldn't change.
 }
 
+void tst_QContact::detailsByType()
+{
+    QContact c;
+    QContactPhoneNumber p1, p2;
+    p1.setNumber("1111");
+    p2.setNumber("2222");
+    QContactEmailAddress e1;
+    e1.setEmailAddress("one@example.com");
+    QContactNote n1;
+    n1.setNote("note");
+
+    QVERIFY(c.saveDetail(&p1));
+    QVERIFY(c.saveDetail(&e1));
+    QVERIFY(c.saveDetail(&p2));
+
+    // lookups by type keep the order in which the details were added.
+    QCOMPARE(c.details(QContactPhoneNumber::Type).count(), 2);
+    QCOMPARE(c.details(QContactPhoneNumber::Type).at(0).value(QContactPhoneNumber::FieldNumber).toString(), QString("1111"));
+    QCOMPARE(c.details(QContactPhoneNumber::Type).at(1).value(QContactPhoneNumber::FieldNumber).toString(), QString("2222"));
+    QCOMPARE(c.detail<QContactEmailAddress>().emailAddress(), QString("one@example.com"));
+    QVERIFY(c.details(QContactNote::Type).isEmpty());
+    QVERIFY(c.detail(QContactNote::Type).isEmpty());
+
+    // a copy shares the details, but mutating either one is reflected only in that one.
+    QContact copy(c);
+    QVERIFY(c.saveDetail(&n1));
+    QCOMPARE(c.details(QContactNote::Type).count(), 1);
+    QVERIFY(copy.details(QContactNote::Type).isEmpty());
+
+    QVERIFY(c.removeDetail(&p1));
+    QCOMPARE(c.details(QContactPhoneNumber::Type).count(), 1);
+    QCOMPARE(c.detail<QContactPhoneNumber>().number(), QString("2222"));
+    QCOMPARE(copy.details(QContactPhoneNumber::Type).count(), 2);
+    QCOMPARE(copy.detail<QContactPhoneNumber>().number(), QString("1111"));
+
+    // updating a detail in place keeps its position.
+    p2.setNumber("3333");
+    QVERIFY(copy.saveDetail(&p2));
+    QCOMPARE(copy.details<QContactPhoneNumber>().count(), 2);
+    QCOMPARE(copy.details<QContactPhoneNumber>().at(1).number(), QString("3333"));
+
+    c.clearTags();
+    c.addTag("one");
+    c.addTag("two");
+    QCOMPARE(c.tags(), QStringList() << "one" << "two");
+    c.setTags(QStringList() << "three");
+    QCOMPARE(c.tags(), QStringList() << "three");
+
+    c.clearDetails();
+    QVERIFY(c.details(QContactPhoneNumber::Type).isEmpty());
+    QVERIFY(c.detail(QContactNote::Type).isEmpty());
+    QCOMPARE(c.details(QContactType::Type).count(), 1);
+
+    // details read from a stream are indexed as well.
+    QByteArray buffer;
+    {
+        QDataStream out(&buffer, QIODevice::WriteOnly);
+        out << copy;
+    }
+    QDataStream in(buffer);
+    QContact streamed;
+    streamed.saveDetail(&n1);
+    QCOMPARE(streamed.details(QContactNote::Type).count(), 1);
+    in >> streamed;
+    QVERIFY(streamed.details(QContactNote::Type).isEmpty());
+    QCOMPARE(streamed.details(QContactPhoneNumber::Type).count(), 2);
+    QCOMPARE(streamed.details(QContactEmailAddress::Type).count(), 1);
+}
+
 void tst_QContact::preferences()
 {
     QContact c;
@@ -540,6 +610,12 @@ void tst_QContact::idComparison()
     QContactId id4(makeId("b", 1));
     QContactId id5(makeId("b", 2));
     QVERIFY((((id1 < id3) && !(id3 < id1)) || ((id3 < id1) && !(id1 < id3))) && (id1 != id3));
+
+    // ordering is by manager URI first, then by engine specific ID
+    QVERIFY(id1 < id4 && id3 < id4 && id1 < id5 && id4 < id5);
+    QCOMPARE(id4.managerUri(), id5.managerUri());
+    QCOMPARE(QContactId::fromString(id4.toString()), id4);
+    QCOMPARE(QContactId::fromByteArray(id5.toByteArray()), id5);
     QVERIFY((((id1 < id4) && !(id4 < id1)) || ((id4 < id1) && !(id1 < id4))) && (id1 != id4));
     QVERIFY((((id3 < id4) && !(id4 < id3)) || ((id4 < id3) && !(id3 < id4))) && (id3 != id4));
     QVERIFY((((id1 < id5) && !(id5 < id1)) || ((id5 < id1) && !(id1 < id5))) && (id3 != id4));
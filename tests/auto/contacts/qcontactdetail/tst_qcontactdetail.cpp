@@ -29,6 +29,7 @@
 #include <QtTest/QtTest>
 #include <QtContacts/QContactDetail>
 #include <QtContacts/qcontacts.h>
+#include <QtContacts/private/qcontactdetail_p.h>
 
 #include <QSet>
 
@@ -53,6 +54,7 @@ private slots:
     void templates();
     void contexts();
     void values();
+    void typedValues();
     void hash();
     void datastream();
     void traits();
@@ -492,6 +494,56 @@ void tst_QContactDetail::values()
     QVERIFY(p.removeValue(QContactAddress::FieldPostOfficeBox));
 }
 
+void tst_QContactDetail::typedValues()
+{
+    const QDateTime dt(QDate(2012, 3, 4), QTime(5, 6, 7));
+
+    QContactDetail generic;
+    generic.setValue(1, QString("12"));
+    generic.setValue(2, 42);
+    generic.setValue(3, dt);
+    generic.setValue(4, dt.date());
+    generic.setValue(QContactDetail::FieldContext, QContactDetail::ContextWork);
+
+    QContactPhoneNumber phone;
+    phone.setNumber("+358 1234 5678");
+    phone.setSubTypes(QList<int>() << QContactPhoneNumber::SubTypeMobile);
+    QContactDetailPrivate::setProvenance(&phone, QString("provenance"));
+
+    QContactBirthday birthday;
+    birthday.setDateTime(dt);
+    birthday.setCalendarId("gregorian");
+
+    QContactBirthday birthdayDate;
+    birthdayDate.setDate(dt.date());
+
+    QContactGender gender;
+    gender.setGender(QContactGender::GenderFemale);
+
+    QList<int> fields;
+    fields << 0 << 1 << 2 << 3 << 4 << 5
+           << QContactDetail::FieldContext << QContactDetail::FieldDetailUri
+           << QContactDetail::FieldLinkedDetailUris << QContactDetail::FieldProvenance;
+
+    // the typed accessors must agree with value() for every field, whether set or not
+    QList<QContactDetail> details;
+    details << generic << phone << birthday << birthdayDate << gender << QContactName();
+    foreach (const QContactDetail &detail, details) {
+        const QContactDetailPrivate *d = QContactDetailPrivate::detailPrivate(detail);
+        foreach (int field, fields) {
+            const QVariant value = detail.value(field);
+            QCOMPARE(d->stringValue(field), value.toString());
+            QCOMPARE(d->intValue(field), value.toInt());
+            QCOMPARE(d->dateTimeValue(field), value.toDateTime());
+        }
+    }
+
+    QCOMPARE(QContactDetailPrivate::detailPrivate(phone)->stringValue(QContactPhoneNumber::FieldNumber), QString("+358 1234 5678"));
+    QCOMPARE(QContactDetailPrivate::detailPrivate(gender)->intValue(QContactGender::FieldGender), int(QContactGender::GenderFemale));
+    QCOMPARE(QContactDetailPrivate::detailPrivate(birthday)->dateTimeValue(QContactBirthday::FieldBirthday), dt);
+    QCOMPARE(QContactDetailPrivate::detailPrivate(birthdayDate)->dateTimeValue(QContactBirthday::FieldBirthday), QDateTime(dt.date()));
+}
+
 void tst_QContactDetail::hash()
 {
     QContactExtendedDetail detail1;
@@ -73,6 +73,9 @@ private slots:
     void canonicalizedFilter_data();
     void testFilter();
     void testFilter_data();
+    void compiledFilter();
+    void compiledFilter_data();
+    void compiledFilterReordering();
     void collectionFilter();
 
     void datastream();
@@ -764,6 +767,25 @@ void tst_QContactFilter::idListFilter()
     QVERIFY(idf == idf3); // again, should be a blank id list filter.
     idf = idf3;
     idf.setIds(ids); // force a detach
+
+    /* Matching uses a hash of the ids, which must follow changes to the filter */
+    QContact contact;
+    contact.setId(makeId("test", 5));
+    QContactIdFilter matching;
+    matching.add(makeId("test", 4));
+    QVERIFY(!QContactManagerEngine::testFilter(matching, contact));
+    matching.add(makeId("test", 5));
+    QVERIFY(QContactManagerEngine::testFilter(matching, contact));
+    QContactIdFilter copy = matching;
+    copy.remove(makeId("test", 5)); // detaches; the original keeps its ids
+    QVERIFY(!QContactManagerEngine::testFilter(copy, contact));
+    QVERIFY(QContactManagerEngine::testFilter(matching, contact));
+    QContactIntersectionFilter nested;
+    nested << QContactFilter() << matching;
+    QVERIFY(QContactCompiledFilter(nested).matches(contact));
+    matching.clear();
+    QVERIFY(!QContactManagerEngine::testFilter(matching, contact));
+    QVERIFY(QContactCompiledFilter(nested).matches(contact)); // nested holds its own copy
 }
 
 void tst_QContactFilter::canonicalizedFilter()
@@ -809,6 +831,33 @@ void tst_QContactFilter::canonicalizedFilter_data()
                 << static_cast<QContactFilter>(qcuf);
     }
 
+    {
+        QContactDetailFilter phone;
+        phone.setDetailType(QContactPhoneNumber::Type, QContactPhoneNumber::FieldNumber);
+        phone.setValue(QStringLiteral("555-1212"));
+        phone.setMatchFlags(QContactFilter::MatchPhoneNumber);
+        QContactIdFilter ids;
+        ids.setIds(QList<QContactId>() << QContactId());
+        QContactDetailFilter presence;
+        presence.setDetailType(QContactName::Type);
+
+        QContactIntersectionFilter qcif;
+        qcif << phone << detailFilter1 << ids << presence << detailFilter2;
+        QContactIntersectionFilter expected;
+        expected << ids << presence << phone << detailFilter1 << detailFilter2; // names are unions of five terms
+        QTest::newRow("Intersection ordered by cost")
+                << static_cast<QContactFilter>(qcif)
+                << static_cast<QContactFilter>(expected);
+
+        QContactUnionFilter qcuf;
+        qcuf << phone << detailFilter1 << ids << presence << detailFilter2;
+        QContactUnionFilter expectedUnion;
+        expectedUnion << ids << presence << phone << detailFilter1 << detailFilter2;
+        QTest::newRow("Union ordered by cost")
+                << static_cast<QContactFilter>(qcuf)
+                << static_cast<QContactFilter>(expectedUnion);
+    }
+
     {
         QContactIntersectionFilter qcif;
         QTest::newRow("Empty intersection")
@@ -1205,6 +1254,129 @@ void tst_QContactFilter::testFilter_data()
     }
 }
 
+void tst_QContactFilter::compiledFilter()
+{
+    QFETCH(QContact, contact);
+    QFETCH(QContactFilter, filter);
+    QFETCH(bool, expected);
+
+    QContactCompiledFilter compiled(filter);
+    QCOMPARE(compiled.filter(), filter);
+    QCOMPARE(compiled.matches(contact), expected);
+
+    QContactCompiledFilter copy(compiled);
+    QCOMPARE(copy.matches(contact), expected);
+    QCOMPARE(QContactManagerEngine::testFilter(filter, contact), expected);
+}
+
+void tst_QContactFilter::compiledFilterReordering()
+{
+    QContact aaron;
+    QContactName name;
+    name.setFirstName(QStringLiteral("Aaron"));
+    aaron.saveDetail(&name);
+    QContactPhoneNumber number;
+    number.setNumber(QStringLiteral("555-1212"));
+    aaron.saveDetail(&number);
+
+    QContact bob(aaron);
+    name.setFirstName(QStringLiteral("Bob"));
+    bob.saveDetail(&name);
+
+    QContact carol(aaron);
+    number = carol.detail<QContactPhoneNumber>();
+    number.setNumber(QStringLiteral("555-3456"));
+    carol.saveDetail(&number);
+
+    QContactDetailFilter firstName;
+    firstName.setDetailType(QContactName::Type, QContactName::FieldFirstName);
+    firstName.setValue(QStringLiteral("aaron"));
+    firstName.setMatchFlags(QContactFilter::MatchFixedString);
+    QContactDetailFilter phone;
+    phone.setDetailType(QContactPhoneNumber::Type, QContactPhoneNumber::FieldNumber);
+    phone.setValue(QStringLiteral("5551212"));
+    phone.setMatchFlags(QContactFilter::MatchPhoneNumber);
+    QContactDetailFilter hasName;
+    hasName.setDetailType(QContactName::Type);
+
+    // the terms which decide the result change half way through, so the order adapts twice;
+    // the results must not depend on it
+    const QContactFilter intersection = phone & hasName & firstName;
+    const QContactFilter combined = intersection | (phone & firstName) | hasName;
+    QContactCompiledFilter compiledIntersection(intersection);
+    QContactCompiledFilter compiledUnion(combined);
+    for (int i = 0; i < 2000; i++) {
+        const QContact &contact = i < 1000 ? (i % 10 ? bob : aaron) : (i % 10 ? carol : aaron);
+        QCOMPARE(compiledIntersection.matches(contact), QContactManagerEngine::testFilter(intersection, contact));
+        QCOMPARE(compiledUnion.matches(contact), true);
+    }
+    QVERIFY(compiledIntersection.matches(aaron));
+    QVERIFY(!compiledIntersection.matches(bob));
+    QVERIFY(!compiledIntersection.matches(carol));
+
+    // testFilter() keeps the filter it compiled last, but not once that filter has been changed
+    QVERIFY(QContactManagerEngine::testFilter(firstName, aaron));
+    QVERIFY(!QContactManagerEngine::testFilter(firstName, bob));
+    firstName.setValue(QStringLiteral("bob"));
+    QVERIFY(!QContactManagerEngine::testFilter(firstName, aaron));
+    QVERIFY(QContactManagerEngine::testFilter(firstName, bob));
+}
+
+void tst_QContactFilter::compiledFilter_data()
+{
+    // the compiled filter must agree with testFilter() on everything it is tested with.
+    testFilter_data();
+
+    QContact contact;
+    QContactName name;
+    name.setFirstName(QStringLiteral("Aaron"));
+    name.setLastName(QStringLiteral("Aaronson"));
+    contact.saveDetail(&name);
+    QContactPhoneNumber number;
+    number.setNumber(QStringLiteral("+1 (555) 123-4567"));
+    contact.saveDetail(&number);
+
+    QContactDetailFilter firstName;
+    firstName.setDetailType(QContactName::Type, QContactName::FieldFirstName);
+    firstName.setValue(QStringLiteral("AARON"));
+    QContactDetailFilter lastName;
+    lastName.setDetailType(QContactName::Type, QContactName::FieldLastName);
+    lastName.setValue(QStringLiteral("aaronson"));
+    lastName.setMatchFlags(QContactFilter::MatchFixedString);
+    QContactDetailFilter otherName;
+    otherName.setDetailType(QContactName::Type, QContactName::FieldFirstName);
+    otherName.setValue(QStringLiteral("Bob"));
+    QContactDetailFilter phone;
+    phone.setDetailType(QContactPhoneNumber::Type, QContactPhoneNumber::FieldNumber);
+    phone.setValue(QStringLiteral("5551234567"));
+    phone.setMatchFlags(QContactFilter::MatchPhoneNumber);
+    QContactDetailFilter otherPhone(phone);
+    otherPhone.setValue(QStringLiteral("999-7654321"));
+
+    QTest::newRow("default filter") << contact << QContactFilter() << true;
+    QTest::newRow("invalid filter") << contact << QContactFilter(QContactInvalidFilter()) << false;
+    QTest::newRow("phone number") << contact << QContactFilter(phone) << true;
+    QTest::newRow("phone number, other") << contact << QContactFilter(otherPhone) << false;
+
+    QTest::newRow("empty intersection") << contact << QContactFilter(QContactIntersectionFilter()) << false;
+    QTest::newRow("empty union") << contact << QContactFilter(QContactUnionFilter()) << false;
+
+    QContactIntersectionFilter nestedIntersection;
+    nestedIntersection << (QContactIntersectionFilter() << firstName << QContactFilter()) << (QContactIntersectionFilter() << lastName << phone);
+    QTest::newRow("nested intersections") << contact << QContactFilter(nestedIntersection) << true;
+    nestedIntersection << (QContactIntersectionFilter() << otherName);
+    QTest::newRow("nested intersections, one failing") << contact << QContactFilter(nestedIntersection) << false;
+
+    QContactUnionFilter nestedUnion;
+    nestedUnion << (QContactUnionFilter() << otherName << otherPhone) << QContactInvalidFilter();
+    QTest::newRow("nested unions, none matching") << contact << QContactFilter(nestedUnion) << false;
+    nestedUnion << (QContactUnionFilter() << QContactUnionFilter() << lastName);
+    QTest::newRow("nested unions, one matching") << contact << QContactFilter(nestedUnion) << true;
+
+    QTest::newRow("intersection with an empty union") << contact << QContactFilter(QContactIntersectionFilter() << firstName << QContactUnionFilter()) << false;
+    QTest::newRow("union with an empty intersection") << contact << QContactFilter(QContactUnionFilter() << QContactIntersectionFilter() << firstName) << true;
+}
+
 void tst_QContactFilter::collectionFilter()
 {
     QContactCollectionFilter icf;
@@ -152,6 +152,14 @@ private slots:
     void ctors();
     void invalidManager();
     void memoryManager();
+    void memoryPhoneNumberIndex();
+    void memoryKeypadIndex();
+    void memoryFullTextIndex();
+    void memoryParallelFilter();
+    void memoryCollectionIndex();
+    void memoryChangeLogIndex();
+    void memoryChangeJournal();
+    void memoryCount();
     void overrideManager();
     void changeSet();
     void fetchHint();
@@ -1521,6 +1529,488 @@ void tst_QContactManager::memoryManager()
     QCOMPARE(m5.contactIds().count(), 0);
 }
 
+void tst_QContactManager::memoryPhoneNumberIndex()
+{
+    QContactManager m("memory");
+
+    QContact alice = createContact("Alice", "inWonderland", "+1 (555) 123-4567");
+    QVERIFY(m.saveContact(&alice));
+    QContact john = createContact("John", "inFinland", "234-5678");
+    QVERIFY(m.saveContact(&john));
+    QContact bob = createContact("Bob", "theBuilder", QString());
+    QVERIFY(m.saveContact(&bob));
+
+    QContactDetailFilter df;
+    df.setDetailType(QContactPhoneNumber::Type, QContactPhoneNumber::FieldNumber);
+    df.setMatchFlags(QContactFilter::MatchPhoneNumber);
+
+    // the rightmost seven digits identify the number, whatever else the query contains
+    df.setValue("123 4567");
+    QCOMPARE(m.contactIds(df), QList<QContactId>() << alice.id());
+    df.setValue("+44 (0) 555-123-4567");
+    QCOMPARE(m.contactIds(df), QList<QContactId>() << alice.id());
+    df.setValue("555-9999");
+    QCOMPARE(m.contactIds(df), QList<QContactId>());
+
+    // a query shorter than seven digits must match the whole number
+    df.setValue("5678");
+    QCOMPARE(m.contactIds(df), QList<QContactId>());
+    df.setMatchFlags(QContactFilter::MatchPhoneNumber | QContactFilter::MatchEndsWith);
+    QCOMPARE(m.contactIds(df), QList<QContactId>() << john.id());
+    df.setValue("15551234567");
+    QCOMPARE(m.contactIds(df), QList<QContactId>() << alice.id());
+
+    // compound filters are narrowed through their terms
+    QContactDetailFilter nameFilter;
+    nameFilter.setDetailType(QContactName::Type, QContactName::FieldFirstName);
+    nameFilter.setValue("John");
+    df.setMatchFlags(QContactFilter::MatchPhoneNumber);
+    df.setValue("2345678");
+    QCOMPARE(m.contactIds(df & nameFilter), QList<QContactId>() << john.id());
+    QContactDetailFilter otherNumber(df);
+    otherNumber.setValue("1234567");
+    QCOMPARE(m.contactIds(otherNumber | df), QList<QContactId>() << alice.id() << john.id());
+    QCOMPARE(m.contactIds(otherNumber & df), QList<QContactId>());
+
+    // the index follows updates and removals
+    QContactPhoneNumber number = alice.detail<QContactPhoneNumber>();
+    number.setNumber("765-4321");
+    QVERIFY(alice.saveDetail(&number));
+    QVERIFY(m.saveContact(&alice));
+    QCOMPARE(m.contactIds(otherNumber), QList<QContactId>());
+    otherNumber.setValue("7654321");
+    QCOMPARE(m.contactIds(otherNumber), QList<QContactId>() << alice.id());
+
+    QVERIFY(m.removeContact(john.id()));
+    QCOMPARE(m.contactIds(df), QList<QContactId>());
+    john.setId(QContactId());
+    john.setCollectionId(QContactCollectionId());
+    QVERIFY(m.saveContact(&john));
+    QCOMPARE(m.contactIds(df), QList<QContactId>() << john.id());
+}
+
+void tst_QContactManager::memoryKeypadIndex()
+{
+    QContactManager m("memory");
+
+    QContact john = createContact("John", "Smith", QString());
+    QVERIFY(m.saveContact(&john));
+    QContact jon = createContact("Jon", "Kim", QString());
+    QVERIFY(m.saveContact(&jon));
+    QContact lois = createContact("Lois", "Lane", QString());
+    QVERIFY(m.saveContact(&lois));
+
+    QContactDetailFilter df;
+    df.setDetailType(QContactName::Type, QContactName::FieldFirstName);
+    df.setMatchFlags(QContactFilter::MatchKeypadCollation | QContactFilter::MatchStartsWith);
+
+    // each key press extends the query, narrowing the previous matches
+    df.setValue("5");
+    QCOMPARE(m.contactIds(df), QList<QContactId>() << john.id() << jon.id() << lois.id());
+    df.setValue("56");
+    QCOMPARE(m.contactIds(df), QList<QContactId>() << john.id() << jon.id() << lois.id());
+    df.setValue("564");
+    QCOMPARE(m.contactIds(df), QList<QContactId>() << john.id() << lois.id());
+    df.setValue("5646");
+    QCOMPARE(m.contactIds(df), QList<QContactId>() << john.id());
+    df.setValue("56");
+    QCOMPARE(m.contactIds(df), QList<QContactId>() << john.id() << jon.id() << lois.id());
+    df.setValue("566");
+    QCOMPARE(m.contactIds(df), QList<QContactId>() << jon.id());
+
+    df.setMatchFlags(QContactFilter::MatchKeypadCollation);
+    QCOMPARE(m.contactIds(df), QList<QContactId>() << jon.id());
+    df.setValue("56");
+    QCOMPARE(m.contactIds(df), QList<QContactId>());
+
+    df.setDetailType(QContactName::Type, QContactName::FieldLastName);
+    df.setMatchFlags(QContactFilter::MatchKeypadCollation | QContactFilter::MatchContains);
+    df.setValue("6");
+    QCOMPARE(m.contactIds(df), QList<QContactId>() << john.id() << jon.id() << lois.id());
+    df.setValue("26");
+    QCOMPARE(m.contactIds(df), QList<QContactId>() << lois.id());
+
+    // the index follows updates and removals, even while a query is being extended
+    QContactName name = jon.detail<QContactName>();
+    name.setLastName("Bland");
+    QVERIFY(jon.saveDetail(&name));
+    QVERIFY(m.saveContact(&jon));
+    df.setValue("263");
+    QCOMPARE(m.contactIds(df), QList<QContactId>() << jon.id() << lois.id());
+    QVERIFY(m.removeContact(lois.id()));
+    df.setValue("2635");
+    QCOMPARE(m.contactIds(df), QList<QContactId>());
+    df.setValue("263");
+    QCOMPARE(m.contactIds(df), QList<QContactId>() << jon.id());
+}
+
+void tst_QContactManager::memoryFullTextIndex()
+{
+    QMap<QString, QString> params;
+    params.insert("fullTextIndex", "true");
+    QContactManager indexed("memory", params);
+    QContactManager plain("memory");
+
+    const char *names[][3] = {
+        { "Aaron", "Aaronson", "aaron@example.com" },
+        { "Bob", "Aaronsen", "Bob.Smith@Example.org" },
+        { "Boris", "Straße", "boris@example.net" },
+        { "Ai", "Ng", "ai@ng.example.com" },
+        { "Zoe", "Zoe\xcc\x88", "zoe@example.com" } // decomposed diaeresis
+    };
+    for (int i = 0; i < 5; i++) {
+        QContact contact = createContact(names[i][0], QString::fromUtf8(names[i][1]), QString());
+        QContactEmailAddress email;
+        email.setEmailAddress(names[i][2]);
+        contact.saveDetail(&email);
+        QVERIFY(plain.saveContact(&contact));
+        contact.setId(QContactId());
+        contact.setCollectionId(QContactCollectionId());
+        QVERIFY(indexed.saveContact(&contact));
+    }
+
+    QContactDetailFilter lastName;
+    lastName.setDetailType(QContactName::Type, QContactName::FieldLastName);
+    lastName.setMatchFlags(QContactFilter::MatchContains);
+    lastName.setValue("aaron");
+    QVERIFY(indexed.isFilterSupported(lastName));
+    QVERIFY(!plain.isFilterSupported(lastName));
+    QContactDetailFilter phone;
+    phone.setDetailType(QContactPhoneNumber::Type, QContactPhoneNumber::FieldNumber);
+    phone.setMatchFlags(QContactFilter::MatchContains);
+    phone.setValue("555");
+    QVERIFY(!indexed.isFilterSupported(phone));
+    QVERIFY(!indexed.isFilterSupported(lastName | phone));
+
+    // the index must find exactly what testing every contact finds
+    QList<QContactFilter> filters;
+    const QContactFilter::MatchFlags flags[] = {
+        QContactFilter::MatchContains, QContactFilter::MatchStartsWith, QContactFilter::MatchEndsWith,
+        QContactFilter::MatchFixedString, QContactFilter::MatchContains | QContactFilter::MatchCaseSensitive
+    };
+    // a precomposed query differs from the stored decomposed value, but the locale's collation
+    // may still find them equal; the index must then find that value as well
+    const char *values[] = { "aaron", "AARONS", "sen", "son", "example.", "EXAMPLE.COM", "straße", "ng", "Ai", "a", "", "zzz", "Zo\xc3\xab" };
+    for (int i = 0; i < 5; i++) {
+        for (int j = 0; j < 13; j++) {
+            QContactDetailFilter df;
+            df.setMatchFlags(flags[i]);
+            df.setValue(QString::fromUtf8(values[j]));
+            df.setDetailType(QContactName::Type, QContactName::FieldLastName);
+            filters << df;
+            df.setDetailType(QContactEmailAddress::Type, QContactEmailAddress::FieldEmailAddress);
+            filters << df;
+        }
+    }
+    filters << (filters.at(0) | filters.at(9)) << (filters.at(0) & filters.at(9));
+
+    foreach (const QContactFilter &filter, filters) {
+        QStringList indexedNames, plainNames;
+        foreach (const QContact &contact, indexed.contacts(filter))
+            indexedNames << contact.detail<QContactName>().firstName();
+        foreach (const QContact &contact, plain.contacts(filter))
+            plainNames << contact.detail<QContactName>().firstName();
+        QCOMPARE(indexedNames, plainNames);
+    }
+
+    // the index follows updates and removals
+    QContact bob = indexed.contacts(lastName).value(1);
+    QCOMPARE(bob.detail<QContactName>().firstName(), QString("Bob"));
+    QContactName name = bob.detail<QContactName>();
+    name.setLastName("Builder");
+    QVERIFY(bob.saveDetail(&name));
+    QVERIFY(indexed.saveContact(&bob));
+    QCOMPARE(indexed.contacts(lastName).count(), 1);
+    lastName.setValue("build");
+    QCOMPARE(indexed.contactIds(lastName), QList<QContactId>() << bob.id());
+    QVERIFY(indexed.removeContact(bob.id()));
+    QCOMPARE(indexed.contactIds(lastName), QList<QContactId>());
+
+    // a store shared with an engine which asked for the index is indexed from then on
+    QContact lois = createContact("Lois", "Lane", QString());
+    QVERIFY(plain.saveContact(&lois));
+    params.insert("id", plain.managerParameters().value("id"));
+    QContactManager shared("memory", params);
+    lastName.setValue("lan");
+    QVERIFY(shared.isFilterSupported(lastName));
+    QCOMPARE(shared.contactIds(lastName), QList<QContactId>() << lois.id());
+}
+
+void tst_QContactManager::memoryParallelFilter()
+{
+    QContactManager serial("memory");
+    QList<QContact> saveList;
+    for (int i = 0; i < 3000; i++)
+        saveList << createContact(QString("First%1").arg(i), QString("Last%1").arg(i % 7), QString("555%1").arg(i));
+    QVERIFY(serial.saveContacts(&saveList));
+
+    // leave holes in the store, so that not every position holds a contact
+    QList<QContactId> removed;
+    for (int i = 0; i < saveList.count(); i += 5)
+        removed << saveList.at(i).id();
+    QVERIFY(serial.removeContacts(removed));
+
+    QContactDetailFilter lastName;
+    lastName.setDetailType(QContactName::Type, QContactName::FieldLastName);
+    lastName.setValue("Last3");
+    QContactDetailFilter phone;
+    phone.setDetailType(QContactPhoneNumber::Type, QContactPhoneNumber::FieldNumber);
+    phone.setMatchFlags(QContactFilter::MatchContains);
+    phone.setValue("99");
+    QContactIdFilter ids;
+    ids.setIds(QList<QContactId>() << saveList.at(1).id() << saveList.at(2500).id() << saveList.at(5).id());
+    const QList<QContactFilter> filters = QList<QContactFilter>()
+            << lastName << phone << (lastName | phone) << (lastName & phone) << ids << QContactInvalidFilter();
+
+    QList<QList<QContactId> > expected;
+    foreach (const QContactFilter &filter, filters)
+        expected << serial.contactIds(filter);
+
+    // a shared store tests its contacts in parallel from then on, with the same results in the same order
+    QMap<QString, QString> params;
+    params.insert("id", serial.managerParameters().value("id"));
+    params.insert("parallelFilterThreshold", "1000");
+    QContactManager parallel("memory", params);
+    for (int i = 0; i < filters.count(); i++)
+        QCOMPARE(parallel.contactIds(filters.at(i)), expected.at(i));
+
+    QContactSortOrder byFirstName;
+    byFirstName.setDetailType(QContactName::Type, QContactName::FieldFirstName);
+    QCOMPARE(parallel.contactIds(phone, QList<QContactSortOrder>() << byFirstName),
+             serial.contactIds(phone, QList<QContactSortOrder>() << byFirstName));
+}
+
+void tst_QContactManager::memoryCollectionIndex()
+{
+    QContactManager cm("memory");
+    QContactCollection work;
+    work.setMetaData(QContactCollection::KeyName, QString("Work"));
+    QVERIFY(cm.saveCollection(&work));
+    QContactCollection home;
+    home.setMetaData(QContactCollection::KeyName, QString("Home"));
+    QVERIFY(cm.saveCollection(&home));
+
+    QList<QContactId> workIds, homeIds, defaultIds;
+    for (int i = 0; i < 9; i++) {
+        QContact contact = createContact(QString("First%1").arg(i), "Last", QString());
+        if (i % 3 == 1)
+            contact.setCollectionId(work.id());
+        else if (i % 3 == 2)
+            contact.setCollectionId(home.id());
+        QVERIFY(cm.saveContact(&contact));
+        (i % 3 == 1 ? workIds : i % 3 == 2 ? homeIds : defaultIds) << contact.id();
+    }
+
+    QContactCollectionFilter inWork;
+    inWork.setCollectionId(work.id());
+    QCOMPARE(cm.contactIds(inWork), workIds);
+    QContactCollectionFilter inEither;
+    inEither.setCollectionIds(QSet<QContactCollectionId>() << work.id() << home.id());
+    QCOMPARE(cm.contactIds(inEither).toSet(), (workIds + homeIds).toSet());
+    QContactDetailFilter first4;
+    first4.setDetailType(QContactName::Type, QContactName::FieldFirstName);
+    first4.setValue("First4");
+    QCOMPARE(cm.contactIds(inWork & first4), QList<QContactId>() << workIds.at(1));
+
+    // an update without a collection keeps the contact where it is
+    QContact contact = cm.contact(workIds.at(0));
+    contact.setCollectionId(QContactCollectionId());
+    QVERIFY(cm.saveContact(&contact));
+    QCOMPARE(contact.collectionId(), work.id());
+    QCOMPARE(cm.contactIds(inWork), workIds);
+
+    // removing a collection removes exactly the contacts it contains
+    QVERIFY(cm.removeContact(workIds.at(2)));
+    workIds.removeAt(2);
+    QCOMPARE(cm.contactIds(inWork), workIds);
+    QVERIFY(cm.removeCollection(work.id()));
+    QCOMPARE(cm.contactIds(inWork), QList<QContactId>());
+    QCOMPARE(cm.contactIds(inEither), homeIds);
+    QCOMPARE(cm.contactIds().count(), homeIds.count() + defaultIds.count());
+}
+
+void tst_QContactManager::memoryChangeLogIndex()
+{
+    QContactManager cm("memory");
+    const QDateTime beforeAdding = QDateTime::currentDateTime();
+    QContact alice = createContact("Alice", "Adams", "1234567");
+    QContact bob = createContact("Bob", "Brown", "2345678");
+    QContact carol = createContact("Carol", "Clark", "3456789");
+    QVERIFY(cm.saveContact(&alice));
+    QVERIFY(cm.saveContact(&bob));
+    QVERIFY(cm.saveContact(&carol));
+
+    QTest::qSleep(10);
+    const QDateTime beforeChanging = QDateTime::currentDateTime();
+    QTest::qSleep(10);
+    QContactName name = alice.detail<QContactName>();
+    name.setMiddleName("Anne");
+    QVERIFY(alice.saveDetail(&name));
+    QVERIFY(cm.saveContact(&alice));
+    QVERIFY(cm.removeContact(carol.id()));
+    QVERIFY(cm.removeContact(bob.id()));
+
+    QContactChangeLogFilter added(QContactChangeLogFilter::EventAdded);
+    added.setSince(beforeAdding);
+    QCOMPARE(cm.contactIds(added), QList<QContactId>() << alice.id());
+    added.setSince(beforeChanging);
+    QCOMPARE(cm.contactIds(added), QList<QContactId>());
+
+    QContactChangeLogFilter changed(QContactChangeLogFilter::EventChanged);
+    changed.setSince(beforeChanging);
+    QCOMPARE(cm.contactIds(changed), QList<QContactId>() << alice.id());
+    QCOMPARE(cm.contactIds(changed & QContactPhoneNumber::match("1234567")), QList<QContactId>() << alice.id());
+    QCOMPARE(cm.contactIds(changed & QContactPhoneNumber::match("2345678")), QList<QContactId>());
+
+    // removals are reported in the order in which they happened, but never match a contact
+    QContactChangeLogFilter removed(QContactChangeLogFilter::EventRemoved);
+    removed.setSince(beforeChanging);
+    QCOMPARE(cm.contactIds(removed), QList<QContactId>() << carol.id() << bob.id());
+    QCOMPARE(cm.contacts(removed).count(), 0);
+    removed.setSince(QDateTime::currentDateTime().addSecs(60));
+    QCOMPARE(cm.contactIds(removed), QList<QContactId>());
+
+    // only the latest removals are remembered, however early the query starts
+    QList<QContact> saveList;
+    for (int i = 0; i < 1030; i++)
+        saveList << createContact(QString("Removed%1").arg(i), "Often", QString());
+    QVERIFY(cm.saveContacts(&saveList));
+    QList<QContactId> removedIds;
+    foreach (const QContact &contact, saveList)
+        removedIds << contact.id();
+    QVERIFY(cm.removeContacts(removedIds));
+    removed.setSince(beforeChanging);
+    QCOMPARE(cm.contactIds(removed), removedIds.mid(removedIds.count() - 1024));
+    QCOMPARE(cm.contactCount(removed), 1024);
+}
+
+void tst_QContactManager::memoryChangeJournal()
+{
+    QContactManager cm("memory");
+    const quint64 initial = cm.revision();
+    QCOMPARE(cm.error(), QContactManager::NoError);
+
+    QContact alice = createContact("Alice", "Adams", "1234567");
+    QContact bob = createContact("Bob", "Brown", "2345678");
+    QVERIFY(cm.saveContact(&alice));
+    QVERIFY(cm.saveContact(&bob));
+    quint64 added = 0;
+    QContactChangeSet changes = cm.changesSince(initial, &added);
+    QCOMPARE(cm.error(), QContactManager::NoError);
+    QCOMPARE(added, cm.revision());
+    QVERIFY(added > initial);
+    QCOMPARE(changes.addedContacts(), QSet<QContactId>() << alice.id() << bob.id());
+    QVERIFY(changes.changedContacts().isEmpty());
+    QVERIFY(changes.removedContacts().isEmpty());
+    QVERIFY(cm.changesSince(added).addedContacts().isEmpty());
+
+    // changes are merged, and a contact added and removed since the revision is not reported
+    QContactName name = alice.detail<QContactName>();
+    name.setMiddleName("Anne");
+    QVERIFY(alice.saveDetail(&name));
+    QList<QContact> saveList;
+    saveList << alice;
+    QVERIFY(cm.saveContacts(&saveList, QList<QContactDetail::DetailType>() << QContactName::Type));
+    QVERIFY(cm.removeContact(bob.id()));
+    QContact carol = createContact("Carol", "Clark", "3456789");
+    QVERIFY(cm.saveContact(&carol));
+    QVERIFY(cm.removeContact(carol.id()));
+    changes = cm.changesSince(added);
+    QCOMPARE(cm.error(), QContactManager::NoError);
+    QVERIFY(changes.addedContacts().isEmpty());
+    QCOMPARE(changes.changedContacts().count(), 1);
+    QCOMPARE(changes.changedContacts().first().second, QList<QContactId>() << alice.id());
+    QCOMPARE(changes.changedContacts().first().first, QList<QContactDetail::DetailType>() << QContactName::Type);
+    QCOMPARE(changes.removedContacts(), QSet<QContactId>() << bob.id());
+
+    changes = cm.changesSince(initial);
+    QCOMPARE(changes.addedContacts(), QSet<QContactId>() << alice.id());
+    QVERIFY(changes.changedContacts().isEmpty());
+    QVERIFY(changes.removedContacts().isEmpty());
+
+    cm.changesSince(cm.revision() + 1);
+    QCOMPARE(cm.error(), QContactManager::BadArgumentError);
+
+    // asynchronously
+    QContactChangesFetchRequest request;
+    request.setManager(&cm);
+    request.setSinceRevision(added);
+    QVERIFY(request.start());
+    QVERIFY(request.waitForFinished());
+    QCOMPARE(request.error(), QContactManager::NoError);
+    QCOMPARE(request.currentRevision(), cm.revision());
+    QCOMPARE(request.changeSet().removedContacts(), QSet<QContactId>() << bob.id());
+
+    // the journal is bounded
+    for (int i = 0; i <= 1024; ++i) {
+        name.setMiddleName(QString::number(i));
+        QVERIFY(alice.saveDetail(&name));
+        QVERIFY(cm.saveContact(&alice));
+    }
+    cm.changesSince(initial);
+    QCOMPARE(cm.error(), QContactManager::LimitReachedError);
+    changes = cm.changesSince(cm.revision() - 1);
+    QCOMPARE(cm.error(), QContactManager::NoError);
+    QCOMPARE(changes.changedContacts().count(), 1);
+}
+
+void tst_QContactManager::memoryCount()
+{
+    QContactManager cm("memory");
+    QContactCollection work;
+    work.setMetaData(QContactCollection::KeyName, QString("Work"));
+    QVERIFY(cm.saveCollection(&work));
+
+    for (int i = 0; i < 10; i++) {
+        QContact contact = createContact(QString("First%1").arg(i), "Last", QString::number(1000000 + i));
+        if (i % 2)
+            contact.setCollectionId(work.id());
+        QVERIFY(cm.saveContact(&contact));
+    }
+    QCOMPARE(cm.contactCount(), 10);
+    QCOMPARE(cm.error(), QContactManager::NoError);
+
+    // every count is the number of ids which would be returned
+    QContactCollectionFilter inWork;
+    inWork.setCollectionId(work.id());
+    QContactDetailFilter first4;
+    first4.setDetailType(QContactName::Type, QContactName::FieldFirstName);
+    first4.setValue("First4");
+    QContactDetailFilter startsWithFirst;
+    startsWithFirst.setDetailType(QContactName::Type, QContactName::FieldFirstName);
+    startsWithFirst.setMatchFlags(QContactFilter::MatchStartsWith);
+    startsWithFirst.setValue("First");
+    QList<QContactFilter> filters;
+    filters << inWork << first4 << (inWork & first4) << (inWork | first4) << startsWithFirst
+            << QContactPhoneNumber::match("1000003") << QContactInvalidFilter();
+    foreach (const QContactFilter &filter, filters) {
+        const QList<QContactId> ids = cm.contactIds(filter);
+        QCOMPARE(cm.contactCount(filter), ids.count());
+        QList<QContactId> fetchedIds;
+        foreach (const QContact &contact, cm.contacts(filter))
+            fetchedIds << contact.id();
+        QCOMPARE(ids, fetchedIds);
+    }
+    QCOMPARE(cm.contactCount(inWork), 5);
+    QCOMPARE(cm.contactCount(inWork & first4), 0);
+
+    QList<QContactId> removed = cm.contactIds(inWork).mid(0, 2);
+    QVERIFY(cm.removeContacts(removed));
+    QCOMPARE(cm.contactCount(inWork), 3);
+    QContactChangeLogFilter removals(QContactChangeLogFilter::EventRemoved);
+    removals.setSince(QDateTime::currentDateTime().addSecs(-60));
+    QCOMPARE(cm.contactCount(removals), 2);
+
+    // asynchronously
+    QContactCountRequest request;
+    request.setManager(&cm);
+    request.setFilter(startsWithFirst);
+    QVERIFY(request.start());
+    QVERIFY(request.waitForFinished());
+    QCOMPARE(request.error(), QContactManager::NoError);
+    QCOMPARE(request.count(), 8);
+}
+
 void tst_QContactManager::overrideManager()
 {
     QString defaultStore = QContactManager::availableManagers().value(0);
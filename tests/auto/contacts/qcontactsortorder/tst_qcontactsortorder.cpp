@@ -54,6 +54,8 @@ private slots:
     void compareContact_data();
     void compareContact();
 
+    void sortContacts();
+
     void datastream_data();
     void datastream();
 
@@ -371,6 +373,53 @@ void tst_QContactSortOrder::compareContact()
     QCOMPARE(actual, expected);
 }
 
+void tst_QContactSortOrder::sortContacts()
+{
+    // notes and guids; contacts with the same note must keep their relative order.
+    const char *notes[] = { "delta", "alpha", "charlie", "alpha", "bravo", "delta", "alpha" };
+    QList<QContact> contacts;
+    for (int i = 0; i < 7; ++i) {
+        QContact contact;
+        QContactNote note;
+        note.setNote(QLatin1String(notes[i]));
+        contact.saveDetail(&note);
+        QContactGuid guid;
+        guid.setGuid(QString::number(i));
+        contact.saveDetail(&guid);
+        contacts.append(contact);
+    }
+
+    QContactSortOrder sortOrder;
+    sortOrder.setDetailType(QContactDetail::TypeNote, QContactNote::FieldNote);
+    QList<QContactSortOrder> sortOrders;
+    sortOrders << sortOrder;
+
+    QStringList expected;
+    expected << "1" << "3" << "6" << "4" << "2" << "0" << "5";
+
+    QList<QContact> sorted = contacts;
+    QContactManagerEngine::sortContacts(&sorted, sortOrders);
+    QStringList actual;
+    foreach (const QContact &contact, sorted)
+        actual << contact.detail<QContactGuid>().guid();
+    QCOMPARE(actual, expected);
+
+    // a partial sort gives the same leading contacts, in the same order.
+    for (int maxCount = 0; maxCount <= contacts.size() + 1; ++maxCount) {
+        sorted = contacts;
+        QContactManagerEngine::sortContacts(&sorted, sortOrders, maxCount);
+        actual.clear();
+        foreach (const QContact &contact, sorted)
+            actual << contact.detail<QContactGuid>().guid();
+        QCOMPARE(actual, expected.mid(0, maxCount));
+    }
+
+    // without any sort order, the original order is kept.
+    sorted = contacts;
+    QContactManagerEngine::sortContacts(&sorted, QList<QContactSortOrder>(), 3);
+    QCOMPARE(sorted, contacts.mid(0, 3));
+}
+
 void tst_QContactSortOrder::datastream_data()
 {
     QTest::addColumn<QContactSortOrder>("sortOrderIn");
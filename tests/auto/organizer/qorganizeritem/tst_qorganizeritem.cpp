@@ -562,6 +562,12 @@ void tst_QOrganizerItem::idComparison()
     QOrganizerItemId id4(makeId("b", 1));
     QOrganizerItemId id5(makeId("b", 2));
     QVERIFY((((id1 < id3) && !(id3 < id1)) || ((id3 < id1) && !(id1 < id3))) && (id1 != id3));
+
+    // ordering is by manager URI first, then by engine specific ID
+    QVERIFY(id1 < id4 && id3 < id4 && id1 < id5 && id4 < id5);
+    QCOMPARE(id4.managerUri(), id5.managerUri());
+    QCOMPARE(QOrganizerItemId::fromString(id4.toString()), id4);
+    QCOMPARE(QOrganizerItemId::fromByteArray(id5.toByteArray()), id5);
     QVERIFY((((id1 < id4) && !(id4 < id1)) || ((id4 < id1) && !(id1 < id4))) && (id1 != id4));
     QVERIFY((((id3 < id4) && !(id4 < id3)) || ((id4 < id3) && !(id3 < id4))) && (id3 != id4));
     QVERIFY((((id1 < id5) && !(id5 < id1)) || ((id5 < id1) && !(id1 < id5))) && (id3 != id4));
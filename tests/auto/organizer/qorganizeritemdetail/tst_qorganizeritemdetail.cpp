@@ -52,6 +52,7 @@ private slots:
     void assignment();
     void templates();
     void values();
+    void manyValues();
     void hash();
     void datastream();
     void traits();
@@ -555,6 +556,54 @@ void tst_QOrganizerItemDetail::values()
     QVERIFY(p.removeValue(QOrganizerItemPriority::FieldPriority));
 }
 
+void tst_QOrganizerItemDetail::manyValues()
+{
+    // fields set out of order
+    QOrganizerItemDetail detail(QOrganizerItemDetail::TypeUndefined);
+    QMap<int, QVariant> expected;
+    const int fields[] = { 7, 2, 11, 0, 5, 3, 9, 1 };
+    for (int i = 0; i < int(sizeof(fields) / sizeof(fields[0])); ++i) {
+        QVERIFY(detail.setValue(fields[i], fields[i] * 10));
+        expected.insert(fields[i], fields[i] * 10);
+        QCOMPARE(detail.values(), expected);
+    }
+    for (int i = 0; i < 12; ++i) {
+        QCOMPARE(detail.hasValue(i), expected.contains(i));
+        QCOMPARE(detail.value(i), expected.value(i));
+    }
+
+    // overwriting keeps a single value per field
+    QVERIFY(detail.setValue(5, QString("five")));
+    expected.insert(5, QString("five"));
+    QCOMPARE(detail.values(), expected);
+
+    // removal, including fields which were never set
+    QVERIFY(detail.removeValue(0));
+    QVERIFY(detail.removeValue(11));
+    QVERIFY(!detail.removeValue(4));
+    QVERIFY(!detail.removeValue(11));
+    expected.remove(0);
+    expected.remove(11);
+    QCOMPARE(detail.values(), expected);
+
+    // equality does not depend on the order in which the fields were set
+    QOrganizerItemDetail other(QOrganizerItemDetail::TypeUndefined);
+    QMap<int, QVariant>::const_iterator it = expected.constEnd();
+    while (it != expected.constBegin()) {
+        --it;
+        other.setValue(it.key(), it.value());
+    }
+    QCOMPARE(other, detail);
+    QCOMPARE(qHash(other), qHash(detail));
+
+    other.removeValue(1);
+    QVERIFY(other != detail);
+
+    foreach (int field, expected.keys())
+        QVERIFY(detail.removeValue(field));
+    QVERIFY(detail.isEmpty());
+}
+
 void tst_QOrganizerItemDetail::hash()
 {
     QOrganizerItemDetail detail1(QOrganizerItemDetail::TypeComment);
@@ -719,6 +719,21 @@ void tst_QOrganizerItemFilter::idListFilter()
     QVERIFY(idf == idf3); // again, should be a blank id list filter.
     idf = idf3;
     idf.setIds(ids); // force a detach
+
+    /* Matching uses a hash of the ids, which must follow changes to the filter */
+    QOrganizerItem item;
+    item.setId(makeItemId(5));
+    QOrganizerItemIdFilter matching;
+    matching.insert(makeItemId(4));
+    QVERIFY(!QOrganizerManagerEngine::testFilter(matching, item));
+    matching.insert(makeItemId(5));
+    QVERIFY(QOrganizerManagerEngine::testFilter(matching, item));
+    QOrganizerItemIdFilter copy = matching;
+    copy.remove(makeItemId(5)); // detaches; the original keeps its ids
+    QVERIFY(!QOrganizerManagerEngine::testFilter(copy, item));
+    QVERIFY(QOrganizerManagerEngine::testFilter(matching, item));
+    matching.setIds(QList<QOrganizerItemId>() << makeItemId(6));
+    QVERIFY(!QOrganizerManagerEngine::testFilter(matching, item));
 }
 
 void tst_QOrganizerItemFilter::collectionFilter()
@@ -804,6 +819,32 @@ void tst_QOrganizerItemFilter::canonicalizedFilter_data()
                 << static_cast<QOrganizerItemFilter>(qcuf);
     }
 
+    {
+        QOrganizerItemIdFilter ids;
+        ids.setIds(QList<QOrganizerItemId>() << QOrganizerItemId());
+        QOrganizerItemDetailFieldFilter presence;
+        presence.setDetail(QOrganizerItemDetail::TypeLocation, -1);
+        QOrganizerItemDetailFieldFilter value;
+        value.setDetail(QOrganizerItemDetail::TypeLocation, QOrganizerItemLocation::FieldLabel);
+        value.setValue("1");
+
+        QOrganizerItemIntersectionFilter qcif;
+        qcif << detailFilter1 << value << ids << detailFilter2 << presence;
+        QOrganizerItemIntersectionFilter expected;
+        expected << ids << presence << value << detailFilter1 << detailFilter2;
+        QTest::newRow("Intersection ordered by cost")
+                << static_cast<QOrganizerItemFilter>(qcif)
+                << static_cast<QOrganizerItemFilter>(expected);
+
+        QOrganizerItemUnionFilter qcuf;
+        qcuf << detailFilter1 << value << ids << detailFilter2 << presence;
+        QOrganizerItemUnionFilter expectedUnion;
+        expectedUnion << ids << presence << value << detailFilter1 << detailFilter2;
+        QTest::newRow("Union ordered by cost")
+                << static_cast<QOrganizerItemFilter>(qcuf)
+                << static_cast<QOrganizerItemFilter>(expectedUnion);
+    }
+
     {
         QOrganizerItemIntersectionFilter qcif;
         QTest::newRow("Empty intersection")
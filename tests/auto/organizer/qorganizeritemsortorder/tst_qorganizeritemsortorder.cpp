@@ -54,6 +54,8 @@ private slots:
     void compareItem_data();
     void compareItem();
 
+    void sortItems();
+
     void datastream_data();
     void datastream();
 
@@ -360,6 +362,49 @@ void tst_QOrganizerItemSortOrder::compareItem()
     QCOMPARE(actual, expected);
 }
 
+void tst_QOrganizerItemSortOrder::sortItems()
+{
+    // items with the same description must keep their relative order.
+    const char *descriptions[] = { "delta", "alpha", "charlie", "alpha", "bravo", "delta", "alpha" };
+    QList<QOrganizerItem> items;
+    for (int i = 0; i < 7; ++i) {
+        QOrganizerItem item;
+        item.setDescription(QLatin1String(descriptions[i]));
+        item.setGuid(QString::number(i));
+        items.append(item);
+    }
+
+    QOrganizerItemSortOrder sortOrder;
+    sortOrder.setDetail(QOrganizerItemDetail::TypeDescription, QOrganizerItemDescription::FieldDescription);
+    QList<QOrganizerItemSortOrder> sortOrders;
+    sortOrders << sortOrder;
+
+    QStringList expected;
+    expected << "1" << "3" << "6" << "4" << "2" << "0" << "5";
+
+    QList<QOrganizerItem> sorted = items;
+    QOrganizerManagerEngine::sortItems(&sorted, sortOrders);
+    QStringList actual;
+    foreach (const QOrganizerItem &item, sorted)
+        actual << item.guid();
+    QCOMPARE(actual, expected);
+
+    // a partial sort gives the same leading items, in the same order.
+    for (int maxCount = 0; maxCount <= items.size() + 1; ++maxCount) {
+        sorted = items;
+        QOrganizerManagerEngine::sortItems(&sorted, sortOrders, maxCount);
+        actual.clear();
+        foreach (const QOrganizerItem &item, sorted)
+            actual << item.guid();
+        QCOMPARE(actual, expected.mid(0, maxCount));
+    }
+
+    // without any sort order, the original order is kept.
+    sorted = items;
+    QOrganizerManagerEngine::sortItems(&sorted, QList<QOrganizerItemSortOrder>(), 3);
+    QCOMPARE(sorted, items.mid(0, 3));
+}
+
 void tst_QOrganizerItemSortOrder::datastream_data()
 {
     QTest::addColumn<QOrganizerItemSortOrder>("sortOrderIn");
@@ -132,6 +132,16 @@ private slots:
     void ctors();
     void invalidManager();
     void memoryManager();
+    void memoryParallelFilter();
+    void memoryChangeJournal();
+    void memoryCount();
+    void memoryTimeIndex();
+    void memoryExceptionIndex();
+    void memoryExportById();
+    void matchingDates();
+    void weeklyPeriods();
+    void memoryOccurrenceIterator();
+    void memoryOccurrenceLimit();
     void changeSet();
     void fetchHint();
     void testFilterFunction();
@@ -1946,6 +1956,619 @@ void tst_QOrganizerManager::memoryManager()
     QCOMPARE(m5.itemIds().count(), 0);
 }
 
+void tst_QOrganizerManager::memoryParallelFilter()
+{
+    QMap<QString, QString> params;
+    params.insert("id", "memoryParallelFilter");
+    QOrganizerManager serial("memory", params);
+
+    QList<QOrganizerItem> saveList;
+    const QDateTime start(QDate(2012, 1, 1), QTime(9, 0));
+    for (int i = 0; i < 1000; i++) {
+        QOrganizerEvent event;
+        event.setDisplayLabel(QString("Event %1").arg(i));
+        event.setStartDateTime(start.addDays(i % 100));
+        event.setEndDateTime(start.addDays(i % 100).addSecs(3600));
+        if (i % 50 == 0) {
+            QOrganizerRecurrenceRule rule;
+            rule.setFrequency(QOrganizerRecurrenceRule::Weekly);
+            rule.setLimit(10);
+            event.setRecurrenceRule(rule);
+        }
+        saveList << event;
+    }
+    QVERIFY(serial.saveItems(&saveList));
+
+    QOrganizerItemDetailFilter label;
+    label.setDetail(QOrganizerItemDetail::TypeDisplayLabel, QOrganizerItemDisplayLabel::FieldLabel);
+    label.setMatchFlags(QOrganizerItemFilter::MatchEndsWith);
+    label.setValue("0");
+    const QDateTime periodStart = start.addDays(10);
+    const QDateTime periodEnd = start.addDays(60);
+
+    const QList<QOrganizerItem> expected = serial.items(periodStart, periodEnd, label);
+    const QList<QOrganizerItem> expectedAll = serial.items(periodStart, periodEnd);
+    QVERIFY(!expected.isEmpty());
+
+    // a shared store filters its items in parallel from then on, with the same results
+    params.insert("parallelFilterThreshold", "500");
+    QOrganizerManager parallel("memory", params);
+    QCOMPARE(parallel.items(periodStart, periodEnd, label), expected);
+    QCOMPARE(parallel.items(periodStart, periodEnd), expectedAll);
+
+    QVERIFY(parallel.removeItems(parallel.itemIds()));
+}
+
+void tst_QOrganizerManager::memoryChangeJournal()
+{
+    QOrganizerManager om("memory");
+    const quint64 initial = om.revision();
+    QCOMPARE(om.error(), QOrganizerManager::NoError);
+
+    QOrganizerEvent meeting;
+    meeting.setDisplayLabel("Meeting");
+    meeting.setStartDateTime(QDateTime(QDate(2012, 1, 1), QTime(9, 0)));
+    QOrganizerEvent lunch;
+    lunch.setDisplayLabel("Lunch");
+    lunch.setStartDateTime(QDateTime(QDate(2012, 1, 1), QTime(12, 0)));
+    QVERIFY(om.saveItem(&meeting));
+    QVERIFY(om.saveItem(&lunch));
+    quint64 added = 0;
+    QOrganizerItemChangeSet changes = om.changesSince(initial, &added);
+    QCOMPARE(om.error(), QOrganizerManager::NoError);
+    QCOMPARE(added, om.revision());
+    QVERIFY(added > initial);
+    QCOMPARE(changes.addedItems(), QSet<QOrganizerItemId>() << meeting.id() << lunch.id());
+    QVERIFY(changes.changedItems().isEmpty());
+    QVERIFY(changes.removedItems().isEmpty());
+
+    // changes are merged, and an item added and removed since the revision is not reported
+    meeting.setDisplayLabel("Team meeting");
+    QVERIFY(om.saveItem(&meeting, QList<QOrganizerItemDetail::DetailType>() << QOrganizerItemDetail::TypeDisplayLabel));
+    meeting.setDescription("Weekly");
+    QVERIFY(om.saveItem(&meeting, QList<QOrganizerItemDetail::DetailType>() << QOrganizerItemDetail::TypeDescription));
+    QVERIFY(om.removeItem(lunch.id()));
+    QOrganizerEvent dinner;
+    dinner.setDisplayLabel("Dinner");
+    QVERIFY(om.saveItem(&dinner));
+    QVERIFY(om.removeItem(dinner.id()));
+    changes = om.changesSince(added);
+    QCOMPARE(om.error(), QOrganizerManager::NoError);
+    QVERIFY(changes.addedItems().isEmpty());
+    QCOMPARE(changes.changedItems().count(), 1);
+    QCOMPARE(changes.changedItems().first().second, QList<QOrganizerItemId>() << meeting.id());
+    QCOMPARE(changes.changedItems().first().first.count(), 2);
+    QVERIFY(changes.changedItems().first().first.contains(QOrganizerItemDetail::TypeDisplayLabel));
+    QVERIFY(changes.changedItems().first().first.contains(QOrganizerItemDetail::TypeDescription));
+    QCOMPARE(changes.removedItems(), QSet<QOrganizerItemId>() << lunch.id());
+
+    changes = om.changesSince(initial);
+    QCOMPARE(changes.addedItems(), QSet<QOrganizerItemId>() << meeting.id());
+    QVERIFY(changes.changedItems().isEmpty());
+    QVERIFY(changes.removedItems().isEmpty());
+
+    om.changesSince(om.revision() + 1);
+    QCOMPARE(om.error(), QOrganizerManager::BadArgumentError);
+
+    // asynchronously
+    QOrganizerItemChangesFetchRequest request;
+    request.setManager(&om);
+    request.setSinceRevision(added);
+    QVERIFY(request.start());
+    QVERIFY(request.waitForFinished());
+    QCOMPARE(request.error(), QOrganizerManager::NoError);
+    QCOMPARE(request.currentRevision(), om.revision());
+    QCOMPARE(request.changeSet().removedItems(), QSet<QOrganizerItemId>() << lunch.id());
+
+    // the journal is bounded
+    for (int i = 0; i <= 1024; ++i) {
+        meeting.setDescription(QString::number(i));
+        QVERIFY(om.saveItem(&meeting));
+    }
+    om.changesSince(initial);
+    QCOMPARE(om.error(), QOrganizerManager::LimitReachedError);
+    changes = om.changesSince(om.revision() - 1);
+    QCOMPARE(om.error(), QOrganizerManager::NoError);
+    QCOMPARE(changes.changedItems().count(), 1);
+}
+
+void tst_QOrganizerManager::memoryCount()
+{
+    QOrganizerManager om("memory");
+    const QDateTime start(QDate(2012, 1, 1), QTime(9, 0));
+    QList<QOrganizerItem> saveList;
+    for (int i = 0; i < 20; i++) {
+        QOrganizerEvent event;
+        event.setDisplayLabel(QString("Event %1").arg(i));
+        event.setStartDateTime(start.addDays(i));
+        event.setEndDateTime(start.addDays(i).addSecs(3600));
+        if (i % 5 == 0) {
+            QOrganizerRecurrenceRule rule;
+            rule.setFrequency(QOrganizerRecurrenceRule::Weekly);
+            rule.setLimit(5);
+            event.setRecurrenceRule(rule);
+        }
+        saveList << event;
+    }
+    QVERIFY(om.saveItems(&saveList));
+
+    // an exception to the first series, moved out of the period of its parent's other occurrences
+    QOrganizerItem exception = om.itemOccurrences(saveList.at(0), start, start.addDays(30), 2).at(1);
+    QOrganizerEventTime time = exception.detail(QOrganizerItemDetail::TypeEventTime);
+    time.setStartDateTime(start.addDays(100));
+    time.setEndDateTime(start.addDays(100).addSecs(3600));
+    exception.saveDetail(&time);
+    QVERIFY(om.saveItem(&exception));
+
+    QCOMPARE(om.itemCount(), 21);
+    QCOMPARE(om.error(), QOrganizerManager::NoError);
+
+    // every count is the number of IDs which would be returned, for an export of the same items
+    QOrganizerItemDetailFieldFilter label;
+    label.setDetail(QOrganizerItemDetail::TypeDisplayLabel, QOrganizerItemDisplayLabel::FieldLabel);
+    label.setMatchFlags(QOrganizerItemFilter::MatchEndsWith);
+    label.setValue("5");
+    QList<QPair<QDateTime, QDateTime> > periods;
+    periods << qMakePair(QDateTime(), QDateTime())
+            << qMakePair(start.addDays(3), start.addDays(8))
+            << qMakePair(start.addDays(90), start.addDays(110))
+            << qMakePair(start.addDays(50), QDateTime());
+    // a recurring parent, a single event and the exception
+    QOrganizerItemIdFilter idFilter;
+    idFilter.setIds(QList<QOrganizerItemId>() << saveList.at(5).id() << saveList.at(1).id() << exception.id());
+    QList<QOrganizerItemFilter> filters;
+    filters << QOrganizerItemFilter() << label << idFilter;
+    foreach (const QOrganizerItemFilter &filter, filters) {
+        for (int i = 0; i < periods.count(); i++) {
+            const QList<QOrganizerItemId> ids = om.itemIds(periods.at(i).first, periods.at(i).second, filter);
+            QCOMPARE(ids, QOrganizerManager::extractIds(om.itemsForExport(periods.at(i).first, periods.at(i).second, filter)));
+            QCOMPARE(om.itemCount(periods.at(i).first, periods.at(i).second, filter), ids.count());
+        }
+    }
+    QCOMPARE(om.itemCount(start.addDays(90), start.addDays(110)), 2); // the exception, and its parent
+    // without a period, the requested recurring parent is counted, as is the exception's parent
+    QCOMPARE(om.itemCount(QDateTime(), QDateTime(), idFilter), 4);
+    QOrganizerItemSortOrder byLabel;
+    byLabel.setDetail(QOrganizerItemDetail::TypeDisplayLabel, QOrganizerItemDisplayLabel::FieldLabel);
+    QCOMPARE(om.itemIds(QDateTime(), QDateTime(), idFilter, QList<QOrganizerItemSortOrder>() << byLabel).count(), 4);
+
+    // asynchronously
+    QOrganizerItemCountRequest request;
+    request.setManager(&om);
+    request.setStartDate(start.addDays(3));
+    request.setEndDate(start.addDays(8));
+    QVERIFY(request.start());
+    QVERIFY(request.waitForFinished());
+    QCOMPARE(request.error(), QOrganizerManager::NoError);
+    QCOMPARE(request.count(), om.itemIds(start.addDays(3), start.addDays(8)).count());
+}
+
+void tst_QOrganizerManager::memoryTimeIndex()
+{
+    QOrganizerManager om("memory");
+    QList<QOrganizerItem> saveList;
+
+    QOrganizerEvent shortEvent;
+    shortEvent.setDisplayLabel("short");
+    shortEvent.setStartDateTime(QDateTime(QDate(2012, 3, 1), QTime(9, 0)));
+    shortEvent.setEndDateTime(QDateTime(QDate(2012, 3, 1), QTime(10, 0)));
+    saveList << shortEvent;
+
+    QOrganizerEvent yearEvent;
+    yearEvent.setDisplayLabel("year");
+    yearEvent.setStartDateTime(QDateTime(QDate(2012, 1, 1), QTime(0, 0)));
+    yearEvent.setEndDateTime(QDateTime(QDate(2012, 12, 31), QTime(18, 0)));
+    saveList << yearEvent;
+
+    QOrganizerEvent decadesEvent;
+    decadesEvent.setDisplayLabel("decades");
+    decadesEvent.setStartDateTime(QDateTime(QDate(2000, 1, 1), QTime(0, 0)));
+    decadesEvent.setEndDateTime(QDateTime(QDate(2030, 1, 1), QTime(0, 0)));
+    saveList << decadesEvent;
+
+    QOrganizerJournal journal;
+    journal.setDisplayLabel("journal");
+    journal.setDateTime(QDateTime(QDate(2012, 3, 2), QTime(12, 0)));
+    saveList << journal;
+
+    QOrganizerTodo todo;
+    todo.setDisplayLabel("todo");
+    todo.setDueDateTime(QDateTime(QDate(2012, 3, 3), QTime(17, 0)));
+    saveList << todo;
+
+    QOrganizerNote note;
+    note.setDisplayLabel("note");
+    saveList << note;
+
+    QOrganizerEvent untimed;
+    untimed.setDisplayLabel("untimed");
+    saveList << untimed;
+
+    QOrganizerEvent weekly;
+    weekly.setDisplayLabel("weekly");
+    weekly.setStartDateTime(QDateTime(QDate(2011, 1, 3), QTime(9, 0)));
+    QOrganizerRecurrenceRule weeklyRule;
+    weeklyRule.setFrequency(QOrganizerRecurrenceRule::Weekly);
+    weekly.setRecurrenceRule(weeklyRule);
+    saveList << weekly;
+
+    QOrganizerEvent ended;
+    ended.setDisplayLabel("ended");
+    ended.setStartDateTime(QDateTime(QDate(2011, 1, 1), QTime(9, 0)));
+    QOrganizerRecurrenceRule endedRule;
+    endedRule.setFrequency(QOrganizerRecurrenceRule::Daily);
+    endedRule.setLimit(QDate(2011, 2, 1));
+    ended.setRecurrenceRule(endedRule);
+    saveList << ended;
+
+    QOrganizerEvent dates;
+    dates.setDisplayLabel("dates");
+    dates.setStartDateTime(QDateTime(QDate(2011, 6, 1), QTime(9, 0)));
+    dates.setRecurrenceDates(QSet<QDate>() << QDate(2012, 3, 5));
+    saveList << dates;
+
+    QVERIFY(om.saveItems(&saveList));
+
+    // only the items (and occurrences) within each period are fetched, whichever index class they are in
+    const QDateTime march(QDate(2012, 3, 1), QTime(0, 0));
+    const QDateTime june(QDate(2012, 6, 1), QTime(0, 0));
+    QSet<QString> labels;
+    foreach (const QOrganizerItem &item, om.items(march, march.addDays(7)))
+        labels << item.displayLabel();
+    QCOMPARE(labels, QSet<QString>() << "short" << "year" << "decades" << "journal" << "todo" << "weekly" << "dates");
+
+    labels.clear();
+    foreach (const QOrganizerItem &item, om.items(june, june.addDays(7)))
+        labels << item.displayLabel();
+    QCOMPARE(labels, QSet<QString>() << "year" << "decades" << "weekly");
+
+    labels.clear();
+    foreach (const QOrganizerItem &item, om.items(QDateTime(), QDateTime(QDate(2011, 1, 2), QTime(0, 0))))
+        labels << item.displayLabel();
+    QCOMPARE(labels, QSet<QString>() << "decades" << "ended");
+
+    labels.clear();
+    foreach (const QOrganizerItem &item, om.items(QDateTime(QDate(2012, 12, 31), QTime(12, 0)), QDateTime()))
+        labels << item.displayLabel();
+    QCOMPARE(labels, QSet<QString>() << "year" << "decades" << "weekly");
+
+    // the index follows changes to the items
+    QOrganizerEvent moved = saveList.at(0);
+    moved.setStartDateTime(june.addDays(2));
+    moved.setEndDateTime(june.addDays(2).addSecs(3600));
+    QVERIFY(om.saveItem(&moved));
+    QVERIFY(om.removeItem(saveList.at(1).id()));
+
+    labels.clear();
+    foreach (const QOrganizerItem &item, om.items(march, march.addDays(7)))
+        labels << item.displayLabel();
+    QCOMPARE(labels, QSet<QString>() << "decades" << "journal" << "todo" << "weekly" << "dates");
+
+    labels.clear();
+    foreach (const QOrganizerItem &item, om.items(june, june.addDays(7)))
+        labels << item.displayLabel();
+    QCOMPARE(labels, QSet<QString>() << "short" << "decades" << "weekly");
+}
+
+void tst_QOrganizerManager::memoryExceptionIndex()
+{
+    QOrganizerManager om("memory");
+    const QDateTime start(QDate(2012, 1, 1), QTime(9, 0));
+    QList<QOrganizerItem> series;
+    for (int i = 0; i < 2; i++) {
+        QOrganizerEvent event;
+        event.setDisplayLabel(QString("Series %1").arg(i));
+        event.setStartDateTime(start);
+        event.setEndDateTime(start.addSecs(3600));
+        QOrganizerRecurrenceRule rule;
+        rule.setFrequency(QOrganizerRecurrenceRule::Daily);
+        rule.setLimit(10);
+        event.setRecurrenceRule(rule);
+        series << event;
+    }
+    QVERIFY(om.saveItems(&series));
+
+    // each series has an exception replacing its occurrence on the same date
+    QList<QOrganizerItem> exceptions;
+    for (int i = 0; i < series.count(); i++) {
+        QOrganizerItem exception = om.itemOccurrences(series.at(i), start, start.addDays(10)).at(2);
+        exception.setDisplayLabel(QString("Exception %1").arg(i));
+        QVERIFY(om.saveItem(&exception));
+        exceptions << exception;
+    }
+
+    // only a series' own exceptions replace its occurrences
+    for (int i = 0; i < series.count(); i++) {
+        const QList<QOrganizerItem> occurrences = om.itemOccurrences(om.item(series.at(i).id()), start, start.addDays(10));
+        QCOMPARE(occurrences.count(), 10);
+        QCOMPARE(occurrences.at(2).id(), exceptions.at(i).id());
+        QCOMPARE(occurrences.at(2).displayLabel(), QString("Exception %1").arg(i));
+    }
+
+    // an exception moved to another original date replaces the occurrence on that date instead
+    QOrganizerItemParent parent = exceptions.at(0).detail(QOrganizerItemDetail::TypeParent);
+    parent.setOriginalDate(start.date().addDays(5));
+    exceptions[0].saveDetail(&parent);
+    QOrganizerEventTime time = exceptions.at(0).detail(QOrganizerItemDetail::TypeEventTime);
+    time.setStartDateTime(start.addDays(5));
+    time.setEndDateTime(start.addDays(5).addSecs(3600));
+    exceptions[0].saveDetail(&time);
+    QVERIFY(om.saveItem(&exceptions[0]));
+    QOrganizerEvent parentItem = om.item(series.at(0).id());
+    parentItem.setExceptionDates(QSet<QDate>() << start.date().addDays(5));
+    QVERIFY(om.saveItem(&parentItem));
+    QList<QOrganizerItem> occurrences = om.itemOccurrences(parentItem, start, start.addDays(10));
+    QCOMPARE(occurrences.count(), 10);
+    QVERIFY(occurrences.at(2).id().isNull());
+    QCOMPARE(occurrences.at(5).id(), exceptions.at(0).id());
+
+    // removing a series removes its exceptions, but not those of other series
+    QVERIFY(om.removeItem(series.at(0).id()));
+    QVERIFY(om.item(exceptions.at(0).id()).isEmpty());
+    occurrences = om.itemOccurrences(om.item(series.at(1).id()), start, start.addDays(10));
+    QCOMPARE(occurrences.count(), 10);
+    QCOMPARE(occurrences.at(2).id(), exceptions.at(1).id());
+}
+
+void tst_QOrganizerManager::memoryExportById()
+{
+    QOrganizerManager om("memory");
+    const QDateTime start(QDate(2012, 1, 1), QTime(9, 0));
+    QOrganizerEvent event;
+    event.setDisplayLabel("Series");
+    event.setStartDateTime(start);
+    event.setEndDateTime(start.addSecs(3600));
+    QOrganizerRecurrenceRule rule;
+    rule.setFrequency(QOrganizerRecurrenceRule::Daily);
+    rule.setLimit(10);
+    event.setRecurrenceRule(rule);
+    QVERIFY(om.saveItem(&event));
+    QOrganizerItem exception = om.itemOccurrences(event, start, start.addDays(10)).at(2);
+    exception.setDisplayLabel("Exception");
+    QVERIFY(om.saveItem(&exception));
+
+    // the requested parent and exception are exported, but none of the generated occurrences
+    QOrganizerItemIdFilter filter;
+    filter.setIds(QList<QOrganizerItemId>() << event.id() << exception.id());
+    QList<QOrganizerItem> items = om.itemsForExport(QDateTime(), QDateTime(), filter);
+    QCOMPARE(items.count(), 2);
+    QSet<QOrganizerItemId> ids;
+    foreach (const QOrganizerItem &item, items)
+        ids.insert(item.id());
+    QCOMPARE(ids, QSet<QOrganizerItemId>() << event.id() << exception.id());
+
+    // a requested parent is exported on its own, and a requested exception brings its parent
+    filter.setIds(QList<QOrganizerItemId>() << event.id());
+    items = om.itemsForExport(QDateTime(), QDateTime(), filter);
+    QCOMPARE(items.count(), 1);
+    QCOMPARE(items.at(0).id(), event.id());
+    QCOMPARE(items.at(0).type(), QOrganizerItemType::TypeEvent);
+    filter.setIds(QList<QOrganizerItemId>() << exception.id());
+    items = om.itemsForExport(QDateTime(), QDateTime(), filter);
+    QCOMPARE(items.count(), 2);
+
+    // unknown ids are left out
+    QVERIFY(om.removeItem(exception.id()));
+    QVERIFY(om.itemsForExport(QDateTime(), QDateTime(), filter).isEmpty());
+}
+
+void tst_QOrganizerManager::matchingDates()
+{
+    QList<QOrganizerRecurrenceRule> rules;
+    QOrganizerRecurrenceRule rule;
+    rules << rule;
+    rule.setMonthsOfYear(QSet<QOrganizerRecurrenceRule::Month>() << QOrganizerRecurrenceRule::February << QOrganizerRecurrenceRule::November);
+    rules << rule;
+    rule = QOrganizerRecurrenceRule();
+    rule.setDaysOfWeek(QSet<Qt::DayOfWeek>() << Qt::Monday << Qt::Friday);
+    rules << rule;
+    rule.setMonthsOfYear(QSet<QOrganizerRecurrenceRule::Month>() << QOrganizerRecurrenceRule::March);
+    rules << rule;
+    rule.setWeeksOfYear(QSet<int>() << 1 << 10 << 53);
+    rules << rule;
+    rule = QOrganizerRecurrenceRule();
+    rule.setWeeksOfYear(QSet<int>() << 1 << 52 << 53);
+    rules << rule;
+    rule = QOrganizerRecurrenceRule();
+    rule.setDaysOfMonth(QSet<int>() << 1 << 13 << 29 << 31 << -1);
+    rules << rule;
+    rule.setDaysOfWeek(QSet<Qt::DayOfWeek>() << Qt::Friday);
+    rules << rule;
+    rule = QOrganizerRecurrenceRule();
+    rule.setDaysOfYear(QSet<int>() << 1 << 60 << 100 << 366 << -1);
+    rules << rule;
+    rule.setMonthsOfYear(QSet<QOrganizerRecurrenceRule::Month>() << QOrganizerRecurrenceRule::February << QOrganizerRecurrenceRule::March);
+    rules << rule;
+
+    // the dates computed from the criteria are those found by testing every day of the period
+    QList<QPair<QDate, QDate> > periods;
+    periods << qMakePair(QDate(2008, 12, 20), QDate(2012, 1, 10))
+            << qMakePair(QDate(2009, 12, 28), QDate(2010, 1, 3))
+            << qMakePair(QDate(2012, 2, 1), QDate(2012, 2, 29))
+            << qMakePair(QDate(2012, 3, 1), QDate(2012, 3, 1))
+            << qMakePair(QDate(2012, 3, 2), QDate(2012, 3, 1));
+    foreach (const QOrganizerRecurrenceRule &tested, rules) {
+        for (int i = 0; i < periods.count(); i++) {
+            QList<QDate> expected;
+            for (QDate date = periods.at(i).first; date <= periods.at(i).second; date = date.addDays(1)) {
+                if ((tested.monthsOfYear().isEmpty() || tested.monthsOfYear().contains(static_cast<QOrganizerRecurrenceRule::Month>(date.month())))
+                        && (tested.weeksOfYear().isEmpty() || tested.weeksOfYear().contains(date.weekNumber()))
+                        && (tested.daysOfYear().isEmpty() || tested.daysOfYear().contains(date.dayOfYear()))
+                        && (tested.daysOfMonth().isEmpty() || tested.daysOfMonth().contains(date.day()))
+                        && (tested.daysOfWeek().isEmpty() || tested.daysOfWeek().contains(static_cast<Qt::DayOfWeek>(date.dayOfWeek())))) {
+                    expected << date;
+                }
+            }
+            QCOMPARE(QOrganizerManagerEngine::matchingDates(periods.at(i).first, periods.at(i).second, tested), expected);
+        }
+    }
+}
+
+void tst_QOrganizerManager::weeklyPeriods()
+{
+    // the weeks counted by stepping through the days agree with those computed from the dates
+    const QDate initialDate(2011, 12, 25);
+    for (int firstDay = Qt::Monday; firstDay <= Qt::Sunday; firstDay++) {
+        const Qt::DayOfWeek firstDayOfWeek = static_cast<Qt::DayOfWeek>(firstDay);
+        int weekCount = 0;
+        QDate weekStart = initialDate;
+        while (weekStart.dayOfWeek() != firstDayOfWeek)
+            weekStart = weekStart.addDays(-1);
+        for (QDate date = initialDate; date < initialDate.addDays(60); date = date.addDays(1)) {
+            if (date > initialDate && date.dayOfWeek() == firstDayOfWeek) {
+                weekCount++;
+                weekStart = date;
+            }
+            QCOMPARE(QOrganizerManagerEngine::firstDateInPeriod(date, QOrganizerRecurrenceRule::Weekly, firstDayOfWeek), weekStart);
+            QCOMPARE(QOrganizerManagerEngine::firstDateInNextPeriod(date, QOrganizerRecurrenceRule::Weekly, firstDayOfWeek), weekStart.addDays(7));
+            for (int interval = 1; interval <= 3; interval++) {
+                QCOMPARE(QOrganizerManagerEngine::inMultipleOfInterval(date, initialDate, QOrganizerRecurrenceRule::Weekly, interval, firstDayOfWeek),
+                         weekCount % interval == 0);
+            }
+        }
+
+        // a date in a week before the initial week is never a multiple of the interval ahead
+        const QDate earlierWeekDate = QOrganizerManagerEngine::firstDateInPeriod(initialDate, QOrganizerRecurrenceRule::Weekly, firstDayOfWeek).addDays(-1);
+        for (int weeksBefore = 0; weeksBefore < 3; weeksBefore++) {
+            for (int interval = 1; interval <= 3; interval++) {
+                QVERIFY(!QOrganizerManagerEngine::inMultipleOfInterval(earlierWeekDate.addDays(-7 * weeksBefore), initialDate,
+                                                                       QOrganizerRecurrenceRule::Weekly, interval, firstDayOfWeek));
+            }
+        }
+    }
+}
+
+void tst_QOrganizerManager::memoryOccurrenceIterator()
+{
+    QOrganizerManager om("memory");
+    const QDateTime start(QDate(2012, 1, 1), QTime(9, 0));
+    QOrganizerEvent event;
+    event.setDisplayLabel("Daily");
+    event.setStartDateTime(start);
+    event.setEndDateTime(start.addSecs(3600));
+    QOrganizerRecurrenceRule rule;
+    rule.setFrequency(QOrganizerRecurrenceRule::Daily);
+    event.setRecurrenceRule(rule);
+    event.setExceptionDates(QSet<QDate>() << start.date().addDays(3));
+    QVERIFY(om.saveItem(&event));
+
+    // the iterator returns the occurrences of the period in the same order
+    QList<QOrganizerItem> expected = om.itemOccurrences(event, start, start.addDays(99));
+    QOrganizerItemOccurrenceIterator it = om.itemOccurrenceIterator(event);
+    QCOMPARE(om.error(), QOrganizerManager::NoError);
+    QList<QOrganizerItem> occurrences = it.next(expected.count());
+    QCOMPARE(occurrences.count(), 99);
+    for (int i = 0; i < expected.count(); i++) {
+        QCOMPARE(static_cast<QOrganizerEventOccurrence>(occurrences.at(i)).startDateTime(),
+                 static_cast<QOrganizerEventOccurrence>(expected.at(i)).startDateTime());
+    }
+    QVERIFY(it.hasNext());
+
+    // copies share the position
+    QOrganizerItemOccurrenceIterator copy(it);
+    QCOMPARE(static_cast<QOrganizerEventOccurrence>(copy.next()).startDateTime(), start.addDays(100));
+    QCOMPARE(static_cast<QOrganizerEventOccurrence>(it.next()).startDateTime(), start.addDays(101));
+
+    // there is no limit on how far ahead the series is followed, or on the occurrences returned
+    it = om.itemOccurrenceIterator(event, QDateTime(QDate(2040, 6, 1), QTime(0, 0)));
+    occurrences = it.next(1000);
+    QCOMPARE(occurrences.count(), 1000);
+    QCOMPARE(static_cast<QOrganizerEventOccurrence>(occurrences.first()).startDateTime(), QDateTime(QDate(2040, 6, 1), QTime(9, 0)));
+    QCOMPARE(static_cast<QOrganizerEventOccurrence>(occurrences.last()).startDateTime(), QDateTime(QDate(2040, 6, 1).addDays(999), QTime(9, 0)));
+    QCOMPARE(om.itemOccurrences(event, start.addDays(5000), QDateTime(), 60).count(), 60);
+
+    // a persisted exception is returned at its own time
+    QOrganizerEventOccurrence exception = om.itemOccurrences(event, start, start.addDays(10)).at(1);
+    exception.setStartDateTime(start.addDays(4).addSecs(3600));
+    exception.setEndDateTime(start.addDays(4).addSecs(7200));
+    QVERIFY(om.saveItem(&exception));
+    event = om.item(event.id());
+    occurrences = om.itemOccurrenceIterator(event, start).next(5);
+    QCOMPARE(occurrences.count(), 5);
+    QCOMPARE(static_cast<QOrganizerEventOccurrence>(occurrences.at(1)).startDateTime(), start.addDays(2));
+    QCOMPARE(static_cast<QOrganizerEventOccurrence>(occurrences.at(2)).startDateTime(), start.addDays(4));
+    QCOMPARE(occurrences.at(3).id(), exception.id());
+    QCOMPARE(static_cast<QOrganizerEventOccurrence>(occurrences.at(4)).startDateTime(), start.addDays(5));
+
+    // a limited series ends
+    QOrganizerEvent limited;
+    limited.setStartDateTime(start);
+    limited.setEndDateTime(start.addSecs(3600));
+    rule.setLimit(3);
+    limited.setRecurrenceRule(rule);
+    it = om.itemOccurrenceIterator(limited);
+    QCOMPARE(it.next(10).count(), 3);
+    QVERIFY(!it.hasNext());
+    QVERIFY(it.next().isEmpty());
+}
+
+void tst_QOrganizerManager::memoryOccurrenceLimit()
+{
+    QOrganizerManager om("memory");
+    const QDateTime start(QDate(2012, 1, 1), QTime(9, 0));
+    QOrganizerEvent event;
+    event.setDisplayLabel("Daily");
+    event.setStartDateTime(start);
+    event.setEndDateTime(start.addSecs(3600));
+    QOrganizerRecurrenceRule rule;
+    rule.setFrequency(QOrganizerRecurrenceRule::Daily);
+    event.setRecurrenceRule(rule);
+    QVERIFY(om.saveItem(&event));
+
+    const QList<QOrganizerItem> generated = om.itemOccurrences(event, start, start.addDays(10));
+    // replaces an occurrence before the period, but is moved into it
+    QOrganizerEventOccurrence movedIn = generated.at(1);
+    movedIn.setStartDateTime(start.addDays(5).addSecs(3600));
+    movedIn.setEndDateTime(start.addDays(5).addSecs(7200));
+    QVERIFY(om.saveItem(&movedIn));
+    // replaces an occurrence in the period, and stays in it
+    QOrganizerEventOccurrence moved = generated.at(3);
+    moved.setStartDateTime(start.addDays(6).addSecs(3600));
+    moved.setEndDateTime(start.addDays(6).addSecs(7200));
+    QVERIFY(om.saveItem(&moved));
+    // replaces an occurrence in the period, but is moved out of it
+    QOrganizerEventOccurrence movedOut = generated.at(4);
+    movedOut.setStartDateTime(start.addDays(30));
+    movedOut.setEndDateTime(start.addDays(30).addSecs(3600));
+    QVERIFY(om.saveItem(&movedOut));
+    event = om.item(event.id());
+
+    // the occurrences of the period limited to a count are the first of those of the whole period
+    const QDateTime periodStart(start.addDays(2));
+    const QDateTime periodEnd(start.addDays(20));
+    const QList<QOrganizerItem> all = om.itemOccurrences(event, periodStart, periodEnd);
+    QCOMPARE(all.count(), 18); // 19 days, less the two moved away, plus the one moved within the period
+    for (int maxCount = 1; maxCount <= all.count() + 1; maxCount++) {
+        const QList<QOrganizerItem> limited = om.itemOccurrences(event, periodStart, periodEnd, maxCount);
+        const QList<QOrganizerItem> expected = all.mid(0, maxCount);
+        QCOMPARE(limited.count(), expected.count());
+        for (int i = 0; i < expected.count(); i++) {
+            QCOMPARE(limited.at(i).id(), expected.at(i).id());
+            QCOMPARE(static_cast<QOrganizerEventOccurrence>(limited.at(i)).startDateTime(),
+                     static_cast<QOrganizerEventOccurrence>(expected.at(i)).startDateTime());
+        }
+    }
+    QCOMPARE(om.itemOccurrences(event, periodStart, periodEnd, 5).at(3).id(), moved.id());
+
+    // without an end, a limited query is not cut off after four years, unlike an unlimited one
+    QOrganizerEvent yearly;
+    yearly.setDisplayLabel("Yearly");
+    yearly.setStartDateTime(start);
+    yearly.setEndDateTime(start.addSecs(3600));
+    rule.setFrequency(QOrganizerRecurrenceRule::Yearly);
+    yearly.setRecurrenceRule(rule);
+    QVERIFY(om.saveItem(&yearly));
+    const QList<QOrganizerItem> years = om.itemOccurrences(yearly, start, QDateTime(), 10);
+    QCOMPARE(years.count(), 10);
+    QCOMPARE(static_cast<QOrganizerEventOccurrence>(years.last()).startDateTime(), start.addYears(9));
+    const QList<QOrganizerItem> horizon = om.itemOccurrences(yearly, start, QDateTime());
+    QCOMPARE(horizon.count(), 5);
+    for (int i = 0; i < horizon.count(); i++) {
+        QCOMPARE(static_cast<QOrganizerEventOccurrence>(years.at(i)).startDateTime(),
+                 static_cast<QOrganizerEventOccurrence>(horizon.at(i)).startDateTime());
+    }
+}
+
 void tst_QOrganizerManager::recurrenceWithGenerator_data()
 {
     QTest::addColumn<QString>("uri");
@@ -0,0 +1,6 @@
+TEMPLATE = app
+CONFIG += testcase release
+TARGET = tst_recurrencebenchmark
+QT += organizer testlib
+SOURCES  += tst_recurrencebenchmark.cpp
+DEFINES += QT_DISABLE_DEPRECATED_BEFORE=0
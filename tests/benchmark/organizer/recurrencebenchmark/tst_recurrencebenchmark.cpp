@@ -0,0 +1,86 @@
+/****************************************************************************
+**
+** Copyright (C) 2017 The Qt Company Ltd.
+** Contact: https://www.qt.io/licensing/
+**
+** This file is part of the test suite of the Qt Toolkit.
+**
+** $QT_BEGIN_LICENSE:GPL-EXCEPT$
+** Commercial License Usage
+** Licensees holding valid commercial Qt licenses may use this file in
+** accordance with the commercial license agreement provided with the
+** Software or, alternatively, in accordance with the terms contained in
+** a written agreement between you and The Qt Company. For licensing terms
+** and conditions see https://www.qt.io/terms-conditions. For further
+** information use the contact form at https://www.qt.io/contact-us.
+**
+** GNU General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU
+** General Public License version 3 as published by the Free Software
+** Foundation with exceptions as appearing in the file LICENSE.GPL3-EXCEPT
+** included in the packaging of this file. Please review the following
+** information to ensure the GNU General Public License requirements will
+** be met: https://www.gnu.org/licenses/gpl-3.0.html.
+**
+** $QT_END_LICENSE$
+**
+****************************************************************************/
+
+
+#include <QtTest/QtTest>
+#include <QtOrganizer/qorganizer.h>
+
+//TESTED_COMPONENT=src/organizer
+
+QTORGANIZER_USE_NAMESPACE
+
+class tst_recurrencebenchmark : public QObject
+{
+    Q_OBJECT
+
+private slots:
+    void biweeklyOccurrences_data();
+    void biweeklyOccurrences();
+};
+
+void tst_recurrencebenchmark::biweeklyOccurrences_data()
+{
+    QTest::addColumn<int>("age");
+
+    QTest::newRow("new series") << 0;
+    QTest::newRow("1 year old") << 1;
+    QTest::newRow("10 years old") << 10;
+    QTest::newRow("40 years old") << 40;
+}
+
+// Expands a month of a biweekly meeting which started the given number of years before;
+// the time taken should not depend on the age of the series.
+void tst_recurrencebenchmark::biweeklyOccurrences()
+{
+    QFETCH(int, age);
+
+    QOrganizerManager manager("memory");
+    const QDate month(2015, 6, 1);
+
+    QOrganizerEvent meeting;
+    meeting.setDisplayLabel("Meeting");
+    meeting.setStartDateTime(QDateTime(month.addYears(-age), QTime(10, 0)));
+    meeting.setEndDateTime(QDateTime(month.addYears(-age), QTime(11, 0)));
+    QOrganizerRecurrenceRule rule;
+    rule.setFrequency(QOrganizerRecurrenceRule::Weekly);
+    rule.setInterval(2);
+    rule.setFirstDayOfWeek(Qt::Sunday);
+    meeting.setRecurrenceRule(rule);
+    QVERIFY(manager.saveItem(&meeting));
+
+    const QDateTime start(month, QTime(0, 0));
+    const QDateTime end(month.addMonths(1), QTime(0, 0));
+    QList<QOrganizerItem> occurrences;
+    QBENCHMARK {
+        occurrences = manager.itemOccurrences(meeting, start, end);
+    }
+    QVERIFY(occurrences.count() >= 2 && occurrences.count() <= 3);
+}
+
+QTEST_MAIN(tst_recurrencebenchmark)
+#include "tst_recurrencebenchmark.moc"